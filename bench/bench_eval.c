@@ -0,0 +1,178 @@
+/*
+ * ==============================================================================
+ * 파일명: bench_eval.c
+ * 역할: 구역 전체 히터/팬 판정 비용 비교 (zone_eval 비트마스크 커널)
+ *
+ * 비교 대상:
+ *   - byte    : 서버의 기존 구역별 판정 방식 (구역마다 비교 2회 → heater_on/fan_on 바이트 기록)
+ *   - scalar  : zone_eval 스칼라 구현 (64개 구역 → 비트마스크 워드 하나)
+ *   - avx2    : zone_eval AVX2 구현 (8개 구역씩 비교 + movemask, 미지원 CPU면 스칼라로 대체)
+ *
+ * 측정 방법:
+ *   - 온도 15~35°C, 습도 30~95% 균등 분포 (0.1%는 NaN - 센서 이상 값), 임계값 28°C / 70%
+ *   - 구역 수마다 전체 판정을 최소 0.2초 동안 반복해 1회 평균 시간 측정
+ *   - scalar/avx2 결과 비트가 byte 결과와 모두 같은지 검증 (다르면 종료 코드 1)
+ *
+ * 사용법:
+ *   ./bin/bench_eval [-z 10000,100000,1000000] [-c]
+ *   -c: CSV 출력
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/zone_eval.h"
+
+#include <math.h>
+
+#define MAX_LIST        16
+#define MIN_BENCH_NS    200000000ull    // 구성당 최소 측정 시간
+#define TEMP_THRESH     28.0f
+#define HUM_THRESH      70.0f
+
+enum { IMPL_BYTE, IMPL_SCALAR, IMPL_AVX2, IMPLS };
+static const char *impl_names[IMPLS] = { "byte", "scalar", "avx2" };
+
+static float *temp, *hum;
+static unsigned char *heater_on, *fan_on;
+static uint64_t *heater_bits, *fan_bits;
+
+/* 기존 서버 방식: 구역마다 바이트 하나씩 */
+static void eval_bytes(int n) {
+    for (int z = 0; z < n; z++) {
+        heater_on[z] = temp[z] < TEMP_THRESH;
+        fan_on[z] = hum[z] > HUM_THRESH;
+    }
+}
+
+static void run_impl(int impl, int n) {
+    switch (impl) {
+        case IMPL_BYTE:
+            eval_bytes(n);
+            break;
+        case IMPL_SCALAR:
+            zone_eval_controls_scalar(temp, hum, n, TEMP_THRESH, HUM_THRESH, heater_bits, fan_bits);
+            break;
+        default:
+            zone_eval_controls_avx2(temp, hum, n, TEMP_THRESH, HUM_THRESH, heater_bits, fan_bits);
+            break;
+    }
+}
+
+/* 비트마스크 결과가 바이트 결과와 같은지 - 반환: 다른 구역 수 */
+static long verify(int n) {
+    long bad = 0;
+    for (int z = 0; z < n; z++) {
+        bad += (int)((heater_bits[z / 64] >> (z % 64)) & 1) != heater_on[z];
+        bad += (int)((fan_bits[z / 64] >> (z % 64)) & 1) != fan_on[z];
+    }
+    // 마지막 워드의 남는 비트는 0이어야 함
+    if (n % 64 != 0) {
+        uint64_t spare = ~0ull << (n % 64);
+        bad += (heater_bits[n / 64] & spare) != 0;
+        bad += (fan_bits[n / 64] & spare) != 0;
+    }
+    return bad;
+}
+
+static int parse_list(const char *s, long *out) {
+    char buf[256];
+    int n = 0;
+    snprintf(buf, sizeof(buf), "%s", s);
+    for (char *tok = strtok(buf, ","); tok && n < MAX_LIST; tok = strtok(NULL, ",")) {
+        out[n++] = strtol(tok, NULL, 10);
+    }
+    return n;
+}
+
+/* ============================================================================
+ * 메인 함수
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    long zones[MAX_LIST];
+    int nz = parse_list("10000,100000,1000000", zones), csv = 0, opt;
+    while ((opt = getopt(argc, argv, "z:c")) != -1) {
+        switch (opt) {
+            case 'z': nz = parse_list(optarg, zones); break;
+            case 'c': csv = 1; break;
+            default:
+                fprintf(stderr, "사용법: %s [-z 구역수,...] [-c]\n", argv[0]);
+                return 1;
+        }
+    }
+    long max_n = 0;
+    for (int i = 0; i < nz; i++) {
+        if (zones[i] < 1 || zones[i] > INT_MAX - 64) {
+            fprintf(stderr, "구역 수는 1 이상\n");
+            return 1;
+        }
+        if (zones[i] > max_n) max_n = zones[i];
+    }
+
+    temp = malloc(max_n * sizeof(float));
+    hum = malloc(max_n * sizeof(float));
+    heater_on = malloc(max_n);
+    fan_on = malloc(max_n);
+    heater_bits = malloc(ZONE_MASK_WORDS(max_n) * sizeof(uint64_t));
+    fan_bits = malloc(ZONE_MASK_WORDS(max_n) * sizeof(uint64_t));
+    if (!temp || !hum || !heater_on || !fan_on || !heater_bits || !fan_bits) {
+        perror("메모리 할당 실패");
+        return 1;
+    }
+    srand(42);
+    for (long z = 0; z < max_n; z++) {
+        temp[z] = 15.0f + 20.0f * rand() / (float)RAND_MAX;
+        hum[z] = 30.0f + 65.0f * rand() / (float)RAND_MAX;
+        if (rand() % 1000 == 0) {
+            temp[z] = hum[z] = NAN;
+        }
+    }
+
+    if (csv) {
+        printf("# build=%s simd=%s\n", SMARTFARM_BUILD, zone_eval_impl());
+        printf("zones,impl,us_per_eval,ns_per_zone,mzones_per_sec,speedup\n");
+    } else {
+        printf("구역 판정 벤치마크 (빌드: %s, zone_eval 기본 구현: %s)\n", SMARTFARM_BUILD,
+               zone_eval_impl());
+        printf("%10s %-7s %12s %11s %12s %8s\n", "zones", "impl", "us/eval", "ns/zone", "Mzones/s",
+               "speedup");
+    }
+
+    int failed = 0;
+    for (int i = 0; i < nz; i++) {
+        int n = (int)zones[i];
+        double base_us = 0;
+        for (int impl = 0; impl < IMPLS; impl++) {
+            run_impl(impl, n);      // 워밍업 (캐시/페이지 폴트)
+            uint64_t iters = 0, t0 = monotonic_ns(), elapsed;
+            do {
+                for (int k = 0; k < 8; k++) {
+                    run_impl(impl, n);
+                }
+                iters += 8;
+                elapsed = monotonic_ns() - t0;
+            } while (elapsed < MIN_BENCH_NS);
+            double us = elapsed / 1000.0 / iters;
+            if (impl == IMPL_BYTE) {
+                base_us = us;
+            } else if (verify(n) != 0) {
+                fprintf(stderr, "%s: 구역 %d개 판정 결과가 byte 구현과 다름\n", impl_names[impl], n);
+                failed = 1;
+            }
+            double ns_zone = us * 1000.0 / n;
+            if (csv) {
+                printf("%d,%s,%.3f,%.4f,%.1f,%.2f\n", n, impl_names[impl], us, ns_zone, 1000.0 / ns_zone,
+                       base_us / us);
+            } else {
+                printf("%10d %-7s %12.2f %11.4f %12.1f %7.2fx\n", n, impl_names[impl], us, ns_zone,
+                       1000.0 / ns_zone, base_us / us);
+            }
+        }
+    }
+    if (!csv) {
+        printf("결과: %s\n", failed ? "FAIL (판정 불일치)" : "OK");
+    }
+    return failed;
+}
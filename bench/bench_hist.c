@@ -0,0 +1,242 @@
+/*
+ * ==============================================================================
+ * 파일명: bench_hist.c
+ * 역할: 구역별 압축 이력(zone_hist) 압축률, 추가/복호화 비용 측정
+ *
+ * 측정 방법:
+ *   - 구역 N개마다 센서와 같은 물리 모델(히터/팬 임계값 28°C / 70%, ±0.1 노이즈)로
+ *     D초 동안 간격 I ms 표본 생성 (0.5%는 1초 늦게 도착 - 시각 delta-of-delta 발생)
+ *   - append : 표본당 zone_hist_append 평균 시간
+ *   - decode : 구역 전체를 hist_cursor_next로 스트리밍 복호화한 표본당 평균 시간
+ *   - B/표본 : 남은 블록이 차지한 바이트 / 표본 (표본 = 시각 + 온도 + 습도, 원본 12바이트)
+ *     닫힌 블록은 헤더와 남는 꼬리까지 블록 전체로 계산 (zone_hist_usage)
+ *   - B/표본이 예산(-b, 기본 2.0 - 요청 목표)을 넘으면 FAIL, 종료 코드 1
+ *   - 복호화한 값이 (반올림한) 입력과 모두 같은지 검증 (다르면 종료 코드 1), 최대 반올림 오차 출력
+ *
+ * 이 벤치마크만 구역당 블록 수를 ZONE_HIST_BLOCKS=4096 (1MB, 무손실 1Hz 24시간 분량)로 빌드
+ * 반올림 모드 측정: make -B bin/bench_hist CFLAGS+=-DZONE_HIST_QUANTUM_SHIFT=5
+ *
+ * 사용법:
+ *   ./bin/bench_hist [-z 구역수] [-d 초] [-i 간격ms] [-b 바이트/표본] [-c]
+ *   -c: CSV 출력
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/zone_hist.h"
+
+#include <math.h>
+
+#define TEMP_THRESH     28.0f
+#define HUM_THRESH      70.0f
+#define RAW_SAMPLE_BYTES 12             // 시각 4 + 온도 4 + 습도 4
+#define SAMPLE_BUDGET   2.0             // 표본당 바이트 예산 (기본값)
+
+typedef struct {
+    float temp, hum;
+} SimZone;
+
+static inline uint32_t xorshift32(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+/* 센서 물리 모델 한 단계 (main_sensor.c update_physics와 같은 규칙) */
+static void sim_step(SimZone *z, uint32_t *seed) {
+    if (z->temp < TEMP_THRESH) {
+        z->temp += 0.2f;
+        if (z->temp > 40.0f) z->temp = 40.0f;
+    } else {
+        z->temp -= (z->temp - 25.0f) * 0.05f;
+        if (z->temp < 20.0f) z->temp = 20.0f;
+    }
+    if (z->hum > HUM_THRESH) {
+        z->hum -= 0.5f;
+        if (z->hum < 30.0f) z->hum = 30.0f;
+    } else {
+        z->hum += 0.3f;
+        if (z->hum > 90.0f) z->hum = 90.0f;
+    }
+    z->temp += ((float)(xorshift32(seed) % 21) - 10.0f) / 100.0f;
+    z->hum += ((float)(xorshift32(seed) % 21) - 10.0f) / 100.0f;
+}
+
+/* ============================================================================
+ * 메인 함수
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    long zones = 100, duration = 86400, interval_ms = 1000;
+    double budget = SAMPLE_BUDGET;
+    int csv = 0, opt;
+    while ((opt = getopt(argc, argv, "z:d:i:b:c")) != -1) {
+        switch (opt) {
+            case 'z': zones = strtol(optarg, NULL, 10); break;
+            case 'd': duration = strtol(optarg, NULL, 10); break;
+            case 'i': interval_ms = strtol(optarg, NULL, 10); break;
+            case 'b': budget = strtod(optarg, NULL); break;
+            case 'c': csv = 1; break;
+            default:
+                fprintf(stderr, "사용법: %s [-z 구역수] [-d 초] [-i 간격ms] [-b 바이트/표본] [-c]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (zones < 1 || zones > 100000 || duration < 1 || interval_ms < 1 || budget <= 0) {
+        fprintf(stderr, "구역 수는 1~100000, 기간과 간격은 1 이상, 예산은 0보다 커야 함\n");
+        return 1;
+    }
+    long steps = duration * 1000 / interval_ms;
+
+    ZoneHist *hist = calloc(zones, sizeof(ZoneHist));
+    SimZone *sim = malloc(zones * sizeof(SimZone));
+    if (hist == NULL || sim == NULL) {
+        perror("메모리 할당 실패");
+        return 1;
+    }
+    uint32_t seed = 42;
+    for (long z = 0; z < zones; z++) {
+        sim[z].temp = 20.0f + (xorshift32(&seed) % 1000) / 100.0f;
+        sim[z].hum = 40.0f + (xorshift32(&seed) % 4000) / 100.0f;
+    }
+
+    // 추가: 시각 순서대로 모든 구역에 표본 하나씩 (서버 수신 순서와 같음)
+    uint32_t t0 = 1764633600u;
+    uint64_t append_ns = 0;
+    for (long s = 0; s < steps; s++) {
+        uint32_t ts = t0 + (uint32_t)(s * interval_ms / 1000);
+        for (long z = 0; z < zones; z++) {
+            sim_step(&sim[z], &seed);
+            uint32_t late = xorshift32(&seed) % 200 == 0;
+            uint64_t t1 = monotonic_ns();
+            zone_hist_append(&hist[z], ts + late, sim[z].temp, sim[z].hum);
+            append_ns += monotonic_ns() - t1;
+        }
+    }
+
+    // 복호화 + 검증: 같은 시드로 입력을 다시 만들어 대조
+    uint64_t samples = 0, bytes = 0, decoded = 0, decode_ns = 0;
+    long mismatches = 0;
+    double max_err = 0;
+    for (long z = 0; z < zones; z++) {
+        zone_hist_usage(&hist[z], &samples, &bytes);
+    }
+    HistPoint *points = malloc(steps * sizeof(HistPoint));
+    if (points == NULL) {
+        perror("메모리 할당 실패");
+        return 1;
+    }
+    for (long z = 0; z < zones; z++) {
+        HistCursor c;
+        long n = 0;
+        uint64_t t1 = monotonic_ns();
+        hist_cursor_init(&c, &hist[z]);
+        while (n < steps && hist_cursor_next(&c, &points[n])) {
+            n++;
+        }
+        decode_ns += monotonic_ns() - t1;
+        decoded += n;
+        if (hist[z].head > ZONE_HIST_BLOCKS) {
+            continue;       // 링이 한 바퀴 돌면 앞부분이 없으므로 검증 생략
+        }
+        if (n != steps) {
+            mismatches += labs(steps - n);
+        }
+    }
+    // 입력 재생성 (구역 순서 그대로) → 남아 있는 전체 이력과 비교 (링이 돌지 않은 경우)
+    if (hist[0].head <= ZONE_HIST_BLOCKS) {
+        seed = 42;
+        for (long z = 0; z < zones; z++) {
+            sim[z].temp = 20.0f + (xorshift32(&seed) % 1000) / 100.0f;
+            sim[z].hum = 40.0f + (xorshift32(&seed) % 4000) / 100.0f;
+        }
+        HistCursor *cur = malloc(zones * sizeof(HistCursor));
+        if (cur == NULL) {
+            perror("메모리 할당 실패");
+            return 1;
+        }
+        for (long z = 0; z < zones; z++) {
+            hist_cursor_init(&cur[z], &hist[z]);
+        }
+        for (long s = 0; s < steps; s++) {
+            uint32_t ts = t0 + (uint32_t)(s * interval_ms / 1000);
+            for (long z = 0; z < zones; z++) {
+                sim_step(&sim[z], &seed);
+                uint32_t late = xorshift32(&seed) % 200 == 0;
+                HistPoint p;
+                if (!hist_cursor_next(&cur[z], &p) || p.ts != ts + late ||
+                    p.temperature != zone_hist_quantize(sim[z].temp) ||
+                    p.humidity != zone_hist_quantize(sim[z].hum)) {
+                    mismatches++;
+                    continue;
+                }
+                double et = p.temperature - sim[z].temp, eh = p.humidity - sim[z].hum;
+                if (et < 0) et = -et;
+                if (eh < 0) eh = -eh;
+                if (et > max_err) max_err = et;
+                if (eh > max_err) max_err = eh;
+            }
+        }
+        free(cur);
+    }
+
+    double per_sample = samples ? (double)bytes / samples : 0.0;
+    int over = per_sample > budget;
+    double append_per = (double)append_ns / (steps * zones);
+    double decode_per = decoded ? (double)decode_ns / decoded : 0.0;
+    // 같은 간격으로 24시간 10,000구역 환산
+    double day_samples = 86400.0 * 1000 / interval_ms * 10000;
+    double day_mb = per_sample * day_samples / (1024.0 * 1024.0);
+    double raw_mb = RAW_SAMPLE_BYTES * day_samples / (1024.0 * 1024.0);
+    int verified = hist[0].head <= ZONE_HIST_BLOCKS;
+    char quantum[32] = "lossless";
+    if (ZONE_HIST_QUANTUM_SHIFT) {
+        snprintf(quantum, sizeof(quantum), "1/%d", 1 << ZONE_HIST_QUANTUM_SHIFT);
+    }
+    if (csv) {
+        printf("# build=%s block_bytes=%d blocks=%d quantum=%s\n", SMARTFARM_BUILD,
+               ZONE_HIST_BLOCK_BYTES, ZONE_HIST_BLOCKS, quantum);
+        printf("zones,seconds,interval_ms,samples,bytes_per_sample,budget,ratio,append_ns,"
+               "decode_ns,max_err,day_10k_mb\n");
+        printf("%ld,%ld,%ld,%llu,%.3f,%.3f,%.2f,%.1f,%.1f,%.4f,%.0f\n", zones, duration, interval_ms,
+               (unsigned long long)samples, per_sample, budget,
+               per_sample > 0 ? RAW_SAMPLE_BYTES / per_sample : 0.0, append_per, decode_per,
+               verified ? max_err : NAN, day_mb);
+    } else {
+        printf("압축 이력 벤치마크 (빌드: %s, 블록 %dB × %d, %s%s)\n", SMARTFARM_BUILD,
+               ZONE_HIST_BLOCK_BYTES, ZONE_HIST_BLOCKS, ZONE_HIST_QUANTUM_SHIFT ? "반올림 " : "무손실",
+               ZONE_HIST_QUANTUM_SHIFT ? quantum : "");
+        printf("  구역 %ld개 × %ld초 (간격 %ldms) = 표본 %llu개 보존\n", zones, duration, interval_ms,
+               (unsigned long long)samples);
+        printf("  B/표본 %.3f (원본 %dB, %.1fx, 예산 %.2f)\n", per_sample, RAW_SAMPLE_BYTES,
+               per_sample > 0 ? RAW_SAMPLE_BYTES / per_sample : 0.0, budget);
+        printf("  추가 %.1f ns/표본, 복호화 %.1f ns/표본\n", append_per, decode_per);
+        if (verified) {
+            printf("  최대 복원 오차 %.4f\n", max_err);
+        } else {
+            printf("  (블록 링이 한 바퀴 돌아 입력 대조 생략 - -d를 줄이면 검증)\n");
+        }
+        printf("  같은 간격 24시간 10,000구역 환산: %.0f MB (원본 %.0f MB)\n", day_mb, raw_mb);
+        if (mismatches) {
+            printf("결과: FAIL (복호화 불일치)\n");
+        } else if (over) {
+            printf("결과: FAIL (B/표본 %.3f > 예산 %.2f)\n", per_sample, budget);
+        } else {
+            printf("결과: OK\n");
+        }
+    }
+    if (mismatches && csv) {
+        fprintf(stderr, "복호화 불일치 %ld건\n", mismatches);
+    }
+    if (over && csv) {
+        fprintf(stderr, "B/표본 %.3f > 예산 %.2f\n", per_sample, budget);
+    }
+    free(points);
+    free(sim);
+    free(hist);
+    return mismatches != 0 || over;
+}
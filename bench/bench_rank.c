@@ -0,0 +1,221 @@
+/*
+ * ==============================================================================
+ * 파일명: bench_rank.c
+ * 역할: 극값 순위(zone_rank) 유지 비용 vs 조회마다 구역 전체 스캔 비교
+ *
+ * 측정 방법:
+ *   - 구역 N개의 온도/습도를 무작위 구역 하나씩 ±0.5 범위로 흔드는 표본 S개 (무작위 걷기)
+ *   - rank : 표본마다 zone_ranker_update, Q개 표본마다 zone_ranker_publish (서버의 이벤트 묶음 게시)
+ *   - scan : Q개 표본마다 구역 전체를 훑어 크기 K 힙으로 상위/하위 K개 계산 (순위 유지 없이 조회할 때)
+ *   - 조회 시점마다 rank 게시 결과의 값이 scan 결과와 순서대로 같은지 검증 (다르면 종료 코드 1)
+ *   - 재계산(rebuild) 횟수: 힙 밖 구역이 순위에 들 수 있어 전체를 다시 훑은 횟수
+ *
+ * 구역 수는 빌드 시 MAX_ZONES (ZONES 미지정 시 이 벤치마크만 1048576)
+ *
+ * 사용법:
+ *   ./bin/bench_rank [-z 10000,100000,1000000] [-s 표본수] [-q 조회간격] [-c]
+ *   -c: CSV 출력
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/zone_rank.h"
+
+#define MAX_LIST        16
+
+static ZoneTable *zt;
+static ZoneRank rank_out;
+
+static inline uint32_t xorshift32(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static inline float jitter(uint32_t *seed) {
+    return ((float)(xorshift32(seed) % 1001) - 500.0f) / 1000.0f;
+}
+
+/* 기준 구현: 구역 전체를 훑어 크기 K 최소 힙 (key = 값 또는 -값) → key 내림차순 */
+static int scan_topk(int n, int kind, float *out) {
+    float heap[ZONE_RANK_K];
+    int len = 0, desc = zone_rank_descending(kind);
+    const float *v = kind == RANK_HOT || kind == RANK_COLD ? zt->current_temp : zt->current_humidity;
+    for (int z = 0; z < n; z++) {
+        float key = desc ? v[z] : -v[z];
+        int i;
+        if (len < ZONE_RANK_K) {
+            i = len++;
+            while (i > 0 && heap[(i - 1) / 2] > key) {
+                heap[i] = heap[(i - 1) / 2];
+                i = (i - 1) / 2;
+            }
+            heap[i] = key;
+        } else if (key > heap[0]) {
+            i = 0;
+            for (;;) {
+                int c = 2 * i + 1;
+                if (c >= len) break;
+                if (c + 1 < len && heap[c + 1] < heap[c]) c++;
+                if (key <= heap[c]) break;
+                heap[i] = heap[c];
+                i = c;
+            }
+            heap[i] = key;
+        }
+    }
+    // 힙 → 내림차순
+    for (int i = 0; i < len; i++) {
+        float key = heap[i];
+        int j = i;
+        while (j > 0 && out[j - 1] < key) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = key;
+    }
+    for (int i = 0; i < len; i++) {
+        out[i] = desc ? out[i] : -out[i];
+    }
+    return len;
+}
+
+static int parse_list(const char *s, long *out) {
+    char buf[256];
+    int n = 0;
+    snprintf(buf, sizeof(buf), "%s", s);
+    for (char *tok = strtok(buf, ","); tok && n < MAX_LIST; tok = strtok(NULL, ",")) {
+        out[n++] = strtol(tok, NULL, 10);
+    }
+    return n;
+}
+
+/* ============================================================================
+ * 메인 함수
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    long zones[MAX_LIST];
+    long samples = 2000000, query_every = 1000;
+    int nz = parse_list("10000,100000,1000000", zones), csv = 0, opt;
+    while ((opt = getopt(argc, argv, "z:s:q:c")) != -1) {
+        switch (opt) {
+            case 'z': nz = parse_list(optarg, zones); break;
+            case 's': samples = strtol(optarg, NULL, 10); break;
+            case 'q': query_every = strtol(optarg, NULL, 10); break;
+            case 'c': csv = 1; break;
+            default:
+                fprintf(stderr, "사용법: %s [-z 구역수,...] [-s 표본수] [-q 조회간격] [-c]\n", argv[0]);
+                return 1;
+        }
+    }
+    for (int i = 0; i < nz; i++) {
+        if (zones[i] < ZONE_RANK_K || zones[i] > MAX_ZONES) {
+            fprintf(stderr, "구역 수는 %d~%d\n", ZONE_RANK_K, MAX_ZONES);
+            return 1;
+        }
+    }
+    if (samples < 1 || query_every < 1) {
+        fprintf(stderr, "표본 수와 조회 간격은 1 이상\n");
+        return 1;
+    }
+    zt = malloc(sizeof(ZoneTable));
+    if (zt == NULL) {
+        perror("메모리 할당 실패");
+        return 1;
+    }
+
+    if (csv) {
+        printf("# build=%s k=%d samples=%ld query_every=%ld\n", SMARTFARM_BUILD, ZONE_RANK_K, samples,
+               query_every);
+        printf("zones,update_ns,publish_us,scan_us,rank_ns_per_sample,scan_ns_per_sample,speedup,"
+               "rebuilds,queries\n");
+    } else {
+        printf("극값 순위 벤치마크 (빌드: %s, K=%d, 표본 %ld개, %ld개마다 조회)\n", SMARTFARM_BUILD,
+               ZONE_RANK_K, samples, query_every);
+        printf("%10s %11s %12s %12s %14s %14s %8s %9s\n", "zones", "update(ns)", "publish(us)",
+               "scan(us)", "rank ns/표본", "scan ns/표본", "speedup", "rebuilds");
+    }
+
+    int failed = 0;
+    for (int i = 0; i < nz; i++) {
+        int n = (int)zones[i];
+        uint32_t seed = 42;
+        for (int z = 0; z < n; z++) {
+            zt->last_update[z] = 1;
+            zt->current_temp[z] = 15.0f + 20.0f * (xorshift32(&seed) % 10000) / 10000.0f;
+            zt->current_humidity[z] = 30.0f + 65.0f * (xorshift32(&seed) % 10000) / 10000.0f;
+        }
+        ZoneRanker *zr = zone_ranker_create(0, n);
+        if (zr == NULL) {
+            perror("순위 생성 실패");
+            return 1;
+        }
+        memset(&rank_out, 0, sizeof(rank_out));
+        zone_ranker_publish(zr, zt, &rank_out, 1);      // 첫 게시 = 전체 재계산 (측정 제외)
+        uint32_t rebuilds0 = zone_ranker_rebuilds(zr);
+
+        uint64_t update_ns = 0, publish_ns = 0, scan_ns = 0, queries = 0;
+        float expect[ZONE_RANK_K];
+        for (long s = 0; s < samples; s++) {
+            int z = (int)(xorshift32(&seed) % (uint32_t)n);
+            float t = zt->current_temp[z] + jitter(&seed);
+            float h = zt->current_humidity[z] + jitter(&seed);
+            zt->current_temp[z] = t;
+            zt->current_humidity[z] = h;
+            uint64_t t0 = monotonic_ns();
+            zone_ranker_update(zr, z, t, h);
+            update_ns += monotonic_ns() - t0;
+
+            if ((s + 1) % query_every != 0) {
+                continue;
+            }
+            queries++;
+            t0 = monotonic_ns();
+            zone_ranker_publish(zr, zt, &rank_out, 0);
+            uint64_t t1 = monotonic_ns();
+            publish_ns += t1 - t0;
+            for (int k = 0; k < RANK_KINDS; k++) {
+                int m = scan_topk(n, k, expect);
+                if ((int)rank_out.count[k] != m) {
+                    failed = 1;
+                }
+                for (int j = 0; j < m && j < (int)rank_out.count[k]; j++) {
+                    if (rank_out.e[k][j].value != expect[j]) {
+                        if (!failed) {
+                            fprintf(stderr, "구역 %d개 %s %d위: %.3f (기대 %.3f)\n", n, zone_rank_name(k),
+                                    j + 1, rank_out.e[k][j].value, expect[j]);
+                        }
+                        failed = 1;
+                    }
+                }
+            }
+            scan_ns += monotonic_ns() - t1;
+        }
+
+        double upd = (double)update_ns / samples;
+        double pub_us = queries ? publish_ns / 1000.0 / queries : 0.0;
+        double scan_us = queries ? scan_ns / 1000.0 / queries : 0.0;
+        double rank_per = (double)(update_ns + publish_ns) / samples;
+        double scan_per = (double)scan_ns / samples;
+        uint32_t rebuilds = zone_ranker_rebuilds(zr) - rebuilds0;
+        if (csv) {
+            printf("%d,%.1f,%.2f,%.1f,%.1f,%.1f,%.1f,%u,%llu\n", n, upd, pub_us, scan_us, rank_per,
+                   scan_per, rank_per > 0 ? scan_per / rank_per : 0.0, rebuilds,
+                   (unsigned long long)queries);
+        } else {
+            printf("%10d %11.1f %12.2f %12.1f %14.1f %14.1f %7.1fx %9u\n", n, upd, pub_us, scan_us,
+                   rank_per, scan_per, rank_per > 0 ? scan_per / rank_per : 0.0, rebuilds);
+        }
+        zone_ranker_destroy(zr);
+    }
+    if (!csv) {
+        printf("결과: %s\n", failed ? "FAIL (순위 불일치)" : "OK");
+    }
+    free(zt);
+    return failed;
+}
@@ -0,0 +1,233 @@
+/*
+ * ==============================================================================
+ * 파일명: bench_registry.c
+ * 역할: 센서 등록 색인(sensor_index) 규모/동시성 벤치마크
+ *
+ * 측정 항목:
+ *   - add      : 센서 N개 등록 (빈 색인에서 시작, 슬롯은 0번부터 차례로)
+ *   - hit/miss : 등록된/등록되지 않은 ID 조회 (단일 프로세스, 무작위 순서)
+ *   - churn    : 기록자 1개가 뒤쪽 절반의 ID를 해제 → 새 ID 등록을 반복하는 동안
+ *                읽기 프로세스 P개가 앞쪽 절반(해제되지 않는 ID)을 잠금 없이 조회
+ *                → 조회 결과가 한 번이라도 틀리면(다른 슬롯/미등록) 실패
+ *   - 해제/등록을 반복한 뒤에도 탐사 길이와 next_fresh(새 슬롯 소비)가 늘지 않는지 확인
+ *
+ * 색인은 MAP_SHARED 익명 매핑에 만들어 서버/센서와 같은 프로세스 간 구조를 흉내 냄
+ * (실제 시스템에서 기록자를 직렬화하는 세마포어는 기록자가 하나라 생략)
+ * 구역 수는 빌드 시 MAX_ZONES (ZONES 미지정 시 이 벤치마크만 131072) - 센서 수 상한
+ *
+ * 사용법:
+ *   ./bin/bench_registry [-n 센서수] [-l 조회수] [-c 해제/등록 반복] [-p 읽기 프로세스수]
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/sensor_index.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define MAX_READERS     16
+
+/* 읽기 프로세스별 결과 */
+typedef struct {
+    uint64_t lookups;
+    uint64_t wrong;             // 다른 슬롯 또는 미등록으로 조회됨
+    uint64_t busy;              // SENSOR_INDEX_BUSY (기록자 선점 - 양보 후 재조회)
+    uint64_t elapsed_ns;
+} __attribute__((aligned(64))) ReaderResult;
+
+/* 프로세스 간 공유 영역 */
+typedef struct {
+    int start __attribute__((aligned(64)));
+    int stop __attribute__((aligned(64)));
+    ReaderResult readers[MAX_READERS];
+    SensorIndex index;
+} BenchShared;
+
+static BenchShared *bs;
+
+/* i번째 센서 ID: 홀수 곱셈은 32비트에서 일대일 → 중복 없는 흩어진 ID */
+static inline uint32_t sensor_id_of(uint32_t i) {
+    return (i + 1) * 2654435761u;
+}
+
+static inline uint32_t xorshift32(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+/* ============================================================================
+ * 함수: run_reader
+ * 설명: 출발 신호 후 stop까지 안정 구간(앞쪽 절반) ID를 무작위 조회하며 슬롯 검증
+ * ============================================================================ */
+static void run_reader(int r, uint32_t stable, const int32_t *expect) {
+    ReaderResult *res = &bs->readers[r];
+    uint32_t seed = 0x9e3779b9u + (uint32_t)r * 7919u;
+    while (!__atomic_load_n(&bs->start, __ATOMIC_ACQUIRE)) {
+        futex_wait(&bs->start, 0, -1);
+    }
+    uint64_t t0 = monotonic_ns(), lookups = 0, wrong = 0, busy = 0;
+    while (!__atomic_load_n(&bs->stop, __ATOMIC_RELAXED)) {
+        for (int k = 0; k < 256; k++) {
+            uint32_t i = xorshift32(&seed) % stable;
+            int slot;
+            while ((slot = sensor_index_lookup(&bs->index, sensor_id_of(i))) == SENSOR_INDEX_BUSY) {
+                busy++;         // 서버는 여기서 세마포어를 잡고 기다림 (sensor_lookup)
+                sched_yield();
+            }
+            if (slot != expect[i]) {
+                wrong++;
+            }
+        }
+        lookups += 256;
+    }
+    res->elapsed_ns = monotonic_ns() - t0;
+    res->lookups = lookups;
+    res->wrong = wrong;
+    res->busy = busy;
+}
+
+static void print_probe(const char *label) {
+    double avg;
+    uint32_t max;
+    sensor_index_probe_stats(&bs->index, &avg, &max);
+    printf("  %-22s 등록 %u개, 적재율 %.2f, 탐사 평균 %.2f / 최대 %u, next_fresh %u, 빈 슬롯 %u\n",
+           label, bs->index.count, (double)bs->index.count / SENSOR_INDEX_BUCKETS, avg, max,
+           bs->index.next_fresh, bs->index.free_top);
+}
+
+/* ============================================================================
+ * 메인 함수
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    long n = MAX_ZONES < 100000 ? MAX_ZONES : 100000;
+    long lookups = 2000000, churn = 200000;
+    int readers = 2, opt;
+    while ((opt = getopt(argc, argv, "n:l:c:p:")) != -1) {
+        switch (opt) {
+            case 'n': n = strtol(optarg, NULL, 10); break;
+            case 'l': lookups = strtol(optarg, NULL, 10); break;
+            case 'c': churn = strtol(optarg, NULL, 10); break;
+            case 'p': readers = atoi(optarg); break;
+            default:
+                fprintf(stderr, "사용법: %s [-n 센서수] [-l 조회수] [-c 해제/등록 반복] [-p 읽기 프로세스수]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (n < 2 || n > MAX_ZONES || readers < 0 || readers > MAX_READERS || lookups < 1 || churn < 0) {
+        fprintf(stderr, "센서 수는 2~%d, 읽기 프로세스는 0~%d\n", MAX_ZONES, MAX_READERS);
+        return 1;
+    }
+
+    bs = mmap(NULL, sizeof(BenchShared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    int32_t *expect = malloc(n * sizeof(int32_t));
+    if (bs == MAP_FAILED || expect == NULL) {
+        perror("메모리 할당 실패");
+        return 1;
+    }
+    printf("센서 등록 색인: 센서 %ld개, 구역 슬롯 %d개, 버킷 %d개 (색인 %.1f MB)\n",
+           n, MAX_ZONES, SENSOR_INDEX_BUCKETS, sizeof(SensorIndex) / 1048576.0);
+
+    // 등록
+    uint64_t t0 = monotonic_ns();
+    for (long i = 0; i < n; i++) {
+        expect[i] = sensor_index_add(&bs->index, sensor_id_of(i));
+        if (expect[i] != i) {
+            fprintf(stderr, "등록 %ld: 슬롯 %d (기대 %ld)\n", i, expect[i], i);
+            return 1;
+        }
+    }
+    double add_ns = (double)(monotonic_ns() - t0) / n;
+    printf("  add                    %8.1f ns/건\n", add_ns);
+    print_probe("probe after add");
+
+    // 조회 (적중 / 미등록)
+    uint32_t seed = 12345;
+    long wrong = 0;
+    t0 = monotonic_ns();
+    for (long k = 0; k < lookups; k++) {
+        uint32_t i = xorshift32(&seed) % n;
+        wrong += sensor_index_lookup(&bs->index, sensor_id_of(i)) != expect[i];
+    }
+    double hit_ns = (double)(monotonic_ns() - t0) / lookups;
+    t0 = monotonic_ns();
+    for (long k = 0; k < lookups; k++) {
+        uint32_t i = (uint32_t)n + xorshift32(&seed) % (uint32_t)n;     // 아직 등록하지 않은 ID
+        wrong += sensor_index_lookup(&bs->index, sensor_id_of(i)) != -1;
+    }
+    double miss_ns = (double)(monotonic_ns() - t0) / lookups;
+    printf("  lookup hit             %8.1f ns/건\n", hit_ns);
+    printf("  lookup miss            %8.1f ns/건\n", miss_ns);
+
+    // 해제/등록 반복 + 동시 조회
+    uint32_t stable = (uint32_t)(n / 2);
+    pid_t pids[MAX_READERS];
+    for (int r = 0; r < readers; r++) {
+        pids[r] = fork();
+        if (pids[r] == 0) {
+            run_reader(r, stable, expect);
+            _exit(0);
+        }
+    }
+    __atomic_store_n(&bs->start, 1, __ATOMIC_RELEASE);
+    futex_wake(&bs->start, INT_MAX);
+
+    // 뒤쪽 절반을 링처럼 돌며: 가장 오래된 ID 해제 → 새 ID 등록 (해제한 슬롯을 재사용해야 함)
+    uint32_t live_lo = stable, live_hi = (uint32_t)n;   // 현재 등록된 churn ID 범위 [lo, hi)
+    t0 = monotonic_ns();
+    for (long k = 0; k < churn; k++) {
+        int freed = sensor_index_remove(&bs->index, sensor_id_of(live_lo++));
+        int slot = sensor_index_add(&bs->index, sensor_id_of(live_hi++));
+        if (freed == -1 || slot != freed) {
+            fprintf(stderr, "반복 %ld: 해제 슬롯 %d, 새 슬롯 %d\n", k, freed, slot);
+            wrong++;
+            break;
+        }
+    }
+    double churn_ns = churn > 0 ? (double)(monotonic_ns() - t0) / (2.0 * churn) : 0.0;
+    __atomic_store_n(&bs->stop, 1, __ATOMIC_RELAXED);
+    for (int r = 0; r < readers; r++) {
+        waitpid(pids[r], NULL, 0);
+    }
+
+    uint64_t rl = 0, rw = 0, rb = 0, rns = 0;
+    for (int r = 0; r < readers; r++) {
+        rl += bs->readers[r].lookups;
+        rw += bs->readers[r].wrong;
+        rb += bs->readers[r].busy;
+        rns += bs->readers[r].elapsed_ns;
+    }
+    printf("  churn add/remove       %8.1f ns/건 (해제+등록 %ld회)\n", churn_ns, churn);
+    if (readers > 0) {
+        printf("  lookup under churn     %8.1f ns/건 (읽기 %d개, 조회 %llu건, 오류 %llu, busy %llu)\n",
+               rl ? (double)rns / rl : 0.0, readers, (unsigned long long)rl,
+               (unsigned long long)rw, (unsigned long long)rb);
+    }
+    print_probe("probe after churn");
+
+    // 반복 후 전체 검증: 안정 구간 + 현재 등록된 churn 구간
+    for (uint32_t i = 0; i < stable; i++) {
+        wrong += sensor_index_lookup(&bs->index, sensor_id_of(i)) != expect[i];
+    }
+    for (uint32_t i = live_lo; i < live_hi; i++) {
+        wrong += sensor_index_lookup(&bs->index, sensor_id_of(i)) < 0;
+    }
+    if (bs->index.next_fresh != (uint32_t)n) {
+        fprintf(stderr, "해제한 슬롯이 재사용되지 않음 (next_fresh %u)\n", bs->index.next_fresh);
+        wrong++;
+    }
+
+    int ok = wrong == 0 && rw == 0;
+    printf("결과: %s\n", ok ? "OK" : "FAIL (조회 결과 불일치)");
+    free(expect);
+    munmap(bs, sizeof(BenchShared));
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,555 @@
+/*
+ * ==============================================================================
+ * 파일명: bench_soak.c
+ * 역할: 전체 파이프라인 부하(soak)/확장성 벤치마크 + 기준선(baseline) 회귀 검사
+ *
+ * 측정 방법:
+ *   - 조합(구역 수 × 초당 메시지 수)마다 실제 bin/server를 새 인스턴스로 기동
+ *     (임시 작업 디렉토리, 체크포인트 off) 하고 준비 배리어(server_ready)까지 대기
+ *   - 부하 생성기 G개(fork)가 실제 센서와 같은 SensorDataMsg를 전송 계층으로 보냄
+ *     구역은 라운드 로빈, 1ms 단위로 목표 개수만큼 보내는 방식으로 속도 유지
+ *     (센서 1초 주기를 압축한 시간 가속 부하)
+ *   - 서버가 보낸 만큼 모두 처리할 때까지 기다린 뒤 제어 소켓 stats로
+ *     처리 건수와 수신 지연 분포(p50/p99/최대)를 수집
+ *   - -u 퍼센트: 별도 생성기 하나가 속도의 그 비율만큼 긴급 표시 메시지를 긴급 경로로 전송
+ *     → 일반/긴급 p99 비교 (일반 메시지가 밀려도 긴급 메시지가 앞질러 처리되는지 확인)
+ *     긴급 전용 프로세스로 분리해야 일반 전송이 막힌 생성기 뒤에 긴급 메시지가 줄 서지 않음
+ *   - 과부하로 서버가 집계 모드에 들어가면 생략(집계)된 표본 수와 모드 전환 횟수도 수집
+ *   - CPU: 서버 + 로그 자식 프로세스의 utime+stime 증가분 / 처리 건수
+ *   - RSS: 종료 직전 서버 상주 메모리
+ *
+ * 기준선 파일 (CSV, '#' 주석):
+ *   zones,rate,min_throughput,max_p99_us,max_cpu_us_per_sample,max_rss_kb
+ *   - 측정값이 하나라도 예산을 넘으면 해당 조합 FAIL, 종료 코드 1
+ *   - -W 로 현재 측정값에 여유(처리량 80%, p99 3배, CPU 1.5배+2tick, RSS 1.5배)를 둔 기준선 기록
+ *
+ * 사용법:
+ *   ./bin/bench_soak [-z 16,256,1024] [-r 1000,10000,50000] [-d 초] [-g 생성기수]
+ *                    [-u 긴급%] [-b 기준선.csv] [-W 기준선.csv] [-o 결과.csv]
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/procstat.h"
+#include "../include/shm_store.h"
+#include "../include/transport.h"
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define MAX_LIST            16
+#define MAX_GENERATORS      16
+#define MAX_BASELINE        64
+#define READY_TIMEOUT_MS    5000
+#define DRAIN_TIMEOUT_MS    10000   // 부하 종료 후 서버가 밀린 메시지를 처리할 최대 시간
+#define PACE_TICK_NS        1000000 // 속도 조절 단위 (1ms)
+
+/* 생성기 → 부모 결과 (MAP_SHARED) */
+typedef struct {
+    uint64_t sent[MAX_GENERATORS + 1];     // 마지막 칸: 긴급 생성기
+    int stop;
+} GenShared;
+
+/* 한 조합의 측정 결과 */
+typedef struct {
+    long zones, rate;
+    uint64_t sent, processed;
+    double throughput;          // 처리 msg/s
+    double p50_us, p99_us, max_us;
+    uint64_t urgent;            // 처리된 긴급 메시지 수
+    double urgent_p99_us;
+    uint64_t shed;              // 집계 모드에서 최신 값에 합쳐진 표본 수
+    long mode_changes;
+    double cpu_us_per_sample;
+    long rss_kb;
+} SoakResult;
+
+/* 기준선 예산 */
+typedef struct {
+    long zones, rate;
+    double min_throughput, max_p99_us, max_cpu_us_per_sample;
+    long max_rss_kb;
+} Budget;
+
+static char bin_dir[PATH_MAX];
+static char work_dir[PATH_MAX];
+static GenShared *gs;
+static int urgent_pct = 0;          // 긴급 메시지 비율 (%)
+
+static int parse_list(const char *s, long *out) {
+    int n = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", s);
+    for (char *tok = strtok(buf, ","); tok != NULL && n < MAX_LIST; tok = strtok(NULL, ",")) {
+        out[n++] = strtol(tok, NULL, 10);
+    }
+    return n;
+}
+
+/* ============================================================================
+ * 함수: control_query
+ * 설명: 서버 제어 소켓에 명령 한 줄을 보내고 응답 한 줄을 받음
+ * ============================================================================ */
+static int control_query(const char *cmd, char *reply, size_t len) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    control_socket_path(addr.sun_path, sizeof(addr.sun_path));
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        write(fd, cmd, strlen(cmd)) == -1) {
+        close(fd);
+        return -1;
+    }
+    ssize_t n = read(fd, reply, len - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    reply[n] = '\0';
+    return 0;
+}
+
+/* 응답에서 "key=값" 숫자 읽기 */
+static double reply_value(const char *reply, const char *key) {
+    char pat[64];
+    snprintf(pat, sizeof(pat), " %s=", key);
+    const char *p = strstr(reply, pat);
+    return p != NULL ? strtod(p + strlen(pat), NULL) : 0;
+}
+
+/* ============================================================================
+ * 함수: start_server
+ * 설명: 임시 작업 디렉토리에서 bin/server 실행 → 공유 메모리 준비 배리어 대기
+ * 반환: 서버 PID (실패 시 -1), shm 에 읽기 전용 매핑
+ * ============================================================================ */
+static pid_t start_server(ShmHandle *shm) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        char path[PATH_MAX + 16];
+        snprintf(path, sizeof(path), "%s/server", bin_dir);
+        if (chdir(work_dir) == -1) _exit(127);
+        int out = open("server.out", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out != -1) {
+            dup2(out, STDOUT_FILENO);
+            dup2(out, STDERR_FILENO);
+        }
+        execl(path, "server", "--cold", (char *)NULL);
+        _exit(127);
+    }
+    if (pid == -1) {
+        return -1;
+    }
+
+    uint64_t deadline = monotonic_ns() + (uint64_t)READY_TIMEOUT_MS * 1000000ull;
+    memset(shm, 0, sizeof(*shm));
+    while (monotonic_ns() < deadline && pid_alive(pid)) {
+        if (shm->data == NULL && shm_store_open(shm, SHM_STORE_RDONLY) == 0 &&
+            !shared_header_valid(shm->data)) {
+            shm_store_close(shm);
+        }
+        if (shm->data != NULL) {
+            const SharedData *sd = shm->data;
+            int seq = __atomic_load_n(&sd->ready_seq, __ATOMIC_ACQUIRE);
+            if (sd->hdr.server_pid == pid && __atomic_load_n(&sd->server_ready, __ATOMIC_ACQUIRE)) {
+                return pid;
+            }
+            futex_wait((int *)&sd->ready_seq, seq, 50);
+        } else {
+            usleep(1000);
+        }
+    }
+    fprintf(stderr, "[SOAK] 서버 준비 실패 (%s/server.out 확인)\n", work_dir);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    shm_store_close(shm);
+    return -1;
+}
+
+/* ============================================================================
+ * 함수: generator
+ * 설명: 부하 생성기 - gid번 생성기가 구역 gid, gid+G, ... 를 돌며 rate msg/s로 전송
+ *       1ms마다 "경과 시간 × 속도"까지 따라잡는 방식 (느려지면 몰아서 보냄)
+ *       urgent면 모든 메시지를 긴급 표시해 긴급 경로로 보냄
+ * ============================================================================ */
+static void generator(int gid, int ngen, long zones, double rate, uint64_t duration_ns, int urgent) {
+    TransportKind kind = transport_kind_from_env();
+    int shared_queue = (kind == TRANSPORT_SYSV);
+    Transport *t = transport_open(kind, urgent ? shard_urgent_key(1, shared_queue)
+                                               : shard_channel_key(1, shared_queue), 0);
+    if (t == NULL) {
+        perror("[SOAK] 전송 채널 연결 실패");
+        _exit(1);
+    }
+    SensorDataMsg msg = {
+        .msg_type = urgent ? SHARD_URGENT_MSG_TYPE(1) : SHARD_MSG_TYPE(1),
+        .flags = urgent ? SENSOR_FLAG_BREACH : 0,
+    };
+    uint64_t sent = 0;
+    long zone = gid % zones;
+    uint64_t start = monotonic_ns();
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (;;) {
+        uint64_t now = monotonic_ns();
+        if (now - start >= duration_ns) {
+            break;
+        }
+        uint64_t target = (uint64_t)((now - start) / 1e9 * rate);
+        while (sent < target) {
+            msg.zone_id = (int)zone;
+            msg.temperature = 20.0f + (float)(sent % 160) / 10.0f;
+            msg.humidity = 40.0f + (float)(sent % 400) / 10.0f;
+            msg.timestamp = time(NULL);
+            msg.sent_ns = monotonic_ns();
+            if (transport_send(t, &msg, sizeof(msg)) == -1) {
+                if (errno == EINTR) continue;
+                perror("[SOAK] 전송 실패");
+                _exit(1);
+            }
+            sent++;
+            zone += ngen;
+            if (zone >= zones) zone = gid % zones;
+        }
+        next.tv_nsec += PACE_TICK_NS;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    gs->sent[gid] = sent;
+    transport_close(t);
+    _exit(0);
+}
+
+/* 서버 + 로그 자식의 CPU 시간 (clock tick) */
+static unsigned long long pipeline_cpu_ticks(const SharedData *sd, pid_t server, long *rss_kb) {
+    ProcSample s;
+    unsigned long long ticks = 0;
+    if (procstat_sample(server, &s) == 0) {
+        ticks += s.utime + s.stime;
+        if (rss_kb != NULL) *rss_kb = s.rss_kb;
+    }
+    for (int i = 0; i < MAX_PROCS; i++) {
+        if (sd->procs[i].role == PROC_ROLE_LOGGER && sd->procs[i].pid > 0 &&
+            procstat_sample(sd->procs[i].pid, &s) == 0) {
+            ticks += s.utime + s.stime;
+        }
+    }
+    return ticks;
+}
+
+/* ============================================================================
+ * 함수: run_case
+ * 설명: 한 조합 실행 - 서버 기동 → 부하 → 처리 완료 대기 → 통계 수집 → 서버 종료
+ * ============================================================================ */
+static int run_case(long zones, long rate, int duration_s, int ngen, SoakResult *r) {
+    ShmHandle shm;
+    memset(r, 0, sizeof(*r));
+    r->zones = zones;
+    r->rate = rate;
+
+    pid_t server = start_server(&shm);
+    if (server == -1) {
+        return -1;
+    }
+    const SharedData *sd = shm.data;
+    char reply[512];
+    control_query("stats reset\n", reply, sizeof(reply));
+
+    long rss_kb = 0;
+    long hz = sysconf(_SC_CLK_TCK);
+    unsigned long long cpu0 = pipeline_cpu_ticks(sd, server, NULL);
+    memset(gs, 0, sizeof(*gs));
+    uint64_t t0 = monotonic_ns();
+
+    int gens = ngen < zones ? ngen : (int)zones;
+    uint64_t duration_ns = (uint64_t)duration_s * 1000000000ull;
+    double urgent_rate = (double)rate * urgent_pct / 100.0;
+    for (int g = 0; g < gens; g++) {
+        if (fork() == 0) {
+            generator(g, gens, zones, ((double)rate - urgent_rate) / gens, duration_ns, 0);
+        }
+    }
+    int procs = gens;
+    if (urgent_rate > 0) {
+        if (fork() == 0) {
+            generator(MAX_GENERATORS, 1, zones, urgent_rate, duration_ns, 1);
+        }
+        procs++;
+    }
+    for (int g = 0; g < procs; g++) {
+        wait(NULL);
+    }
+    for (int g = 0; g <= MAX_GENERATORS; g++) {
+        r->sent += gs->sent[g];
+    }
+
+    // 밀린 메시지 처리 대기 (stats의 msgs가 보낸 수에 도달할 때까지)
+    uint64_t deadline = monotonic_ns() + (uint64_t)DRAIN_TIMEOUT_MS * 1000000ull;
+    while (monotonic_ns() < deadline) {
+        if (control_query("stats\n", reply, sizeof(reply)) == 0 &&
+            (uint64_t)reply_value(reply, "msgs") >= r->sent) {
+            break;
+        }
+        usleep(5000);
+    }
+    uint64_t elapsed = monotonic_ns() - t0;
+    unsigned long long cpu1 = pipeline_cpu_ticks(sd, server, &rss_kb);
+
+    if (control_query("stats\n", reply, sizeof(reply)) == 0) {
+        r->processed = (uint64_t)reply_value(reply, "msgs");
+        r->p50_us = reply_value(reply, "lat_p50_us");
+        r->p99_us = reply_value(reply, "lat_p99_us");
+        r->max_us = reply_value(reply, "lat_max_us");
+        r->urgent = (uint64_t)reply_value(reply, "urgent_msgs");
+        r->urgent_p99_us = reply_value(reply, "urgent_p99_us");
+        r->shed = (uint64_t)reply_value(reply, "shed");
+        r->mode_changes = (long)reply_value(reply, "mode_changes");
+    }
+    r->throughput = r->processed / (elapsed / 1e9);
+    r->cpu_us_per_sample = r->processed ? (cpu1 - cpu0) * 1e6 / hz / r->processed : 0;
+    r->rss_kb = rss_kb;
+
+    shm_store_close(&shm);
+    kill(server, SIGINT);
+    waitpid(server, NULL, 0);
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: load_baseline
+ * ============================================================================ */
+static int load_baseline(const char *path, Budget *b) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+    char line[256];
+    int n = 0;
+    while (fgets(line, sizeof(line), f) != NULL && n < MAX_BASELINE) {
+        if (line[0] == '#' || strncmp(line, "zones", 5) == 0) {
+            continue;
+        }
+        if (sscanf(line, "%ld,%ld,%lf,%lf,%lf,%ld", &b[n].zones, &b[n].rate, &b[n].min_throughput,
+                   &b[n].max_p99_us, &b[n].max_cpu_us_per_sample, &b[n].max_rss_kb) == 6) {
+            n++;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+/* 예산 검사 - 반환: 초과 항목 수 (why에 설명) */
+static int check_budget(const SoakResult *r, const Budget *b, char *why, size_t len) {
+    int fails = 0;
+    why[0] = '\0';
+    size_t off = 0;
+    if (r->throughput < b->min_throughput) {
+        off += snprintf(why + off, len - off, " throughput %.0f<%.0f", r->throughput, b->min_throughput);
+        fails++;
+    }
+    if (r->p99_us > b->max_p99_us && off < len) {
+        off += snprintf(why + off, len - off, " p99 %.1f>%.1f", r->p99_us, b->max_p99_us);
+        fails++;
+    }
+    if (r->cpu_us_per_sample > b->max_cpu_us_per_sample && off < len) {
+        off += snprintf(why + off, len - off, " cpu %.2f>%.2f", r->cpu_us_per_sample,
+                        b->max_cpu_us_per_sample);
+        fails++;
+    }
+    if (r->rss_kb > b->max_rss_kb && off < len) {
+        snprintf(why + off, len - off, " rss %ld>%ld", r->rss_kb, b->max_rss_kb);
+        fails++;
+    }
+    return fails;
+}
+
+/* ============================================================================
+ * 메인 함수
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    long zones[MAX_LIST], rates[MAX_LIST];
+    int nz = parse_list("16,256,1024", zones);
+    int nr = parse_list("1000,10000,50000", rates);
+    int duration_s = 3, ngen = 2, opt;
+    const char *baseline_path = NULL, *write_path = NULL, *csv_path = NULL;
+
+    while ((opt = getopt(argc, argv, "z:r:d:g:u:b:W:o:")) != -1) {
+        switch (opt) {
+            case 'z': nz = parse_list(optarg, zones); break;
+            case 'r': nr = parse_list(optarg, rates); break;
+            case 'd': duration_s = atoi(optarg); break;
+            case 'g': ngen = atoi(optarg); break;
+            case 'u': urgent_pct = atoi(optarg); break;
+            case 'b': baseline_path = optarg; break;
+            case 'W': write_path = optarg; break;
+            case 'o': csv_path = optarg; break;
+            default:
+                fprintf(stderr, "사용법: %s [-z 구역수,...] [-r 초당메시지,...] [-d 초] [-g 생성기수] "
+                        "[-u 긴급%%] [-b 기준선] [-W 기준선기록] [-o 결과CSV]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (duration_s < 1 || ngen < 1 || ngen > MAX_GENERATORS || urgent_pct < 0 || urgent_pct > 100) {
+        fprintf(stderr, "[SOAK] -d는 1 이상, -g는 1~%d, -u는 0~100\n", MAX_GENERATORS);
+        return 2;
+    }
+    for (int i = 0; i < nz; i++) {
+        if (zones[i] < 1 || zones[i] > MAX_ZONES) {
+            fprintf(stderr, "[SOAK] 구역 수는 1~%d (make ZONES=N 으로 변경)\n", MAX_ZONES);
+            return 2;
+        }
+    }
+
+    Budget budgets[MAX_BASELINE];
+    int nbudget = 0;
+    if (baseline_path != NULL && (nbudget = load_baseline(baseline_path, budgets)) < 0) {
+        perror("[SOAK] 기준선 파일 열기 실패");
+        return 2;
+    }
+
+    // 실행 파일 위치, 전용 인스턴스, 임시 작업 디렉토리 (로그/이력이 저장소를 건드리지 않게)
+    char self[PATH_MAX];
+    ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (n <= 0) {
+        perror("[SOAK] 실행 파일 위치 확인 실패");
+        return 2;
+    }
+    self[n] = '\0';
+    snprintf(bin_dir, sizeof(bin_dir), "%s", dirname(self));
+    char inst[32];
+    snprintf(inst, sizeof(inst), "soak-%d", getpid());
+    setenv(INSTANCE_ENV, inst, 1);
+    setenv("SMARTFARM_CHECKPOINT", "off", 1);
+    snprintf(work_dir, sizeof(work_dir), "/tmp/smartfarm-%s", inst);
+    if (mkdir(work_dir, 0755) == -1 && errno != EEXIST) {
+        perror("[SOAK] 작업 디렉토리 생성 실패");
+        return 2;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    gs = mmap(NULL, sizeof(GenShared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (gs == MAP_FAILED) {
+        perror("[SOAK] mmap 실패");
+        return 2;
+    }
+
+    FILE *csv = NULL;
+    if (csv_path != NULL && (csv = fopen(csv_path, "w")) == NULL) {
+        perror("[SOAK] 결과 파일 열기 실패");
+        return 2;
+    }
+    if (csv != NULL) {
+        fprintf(csv, "# build: %s, transport: %s, duration: %ds, generators: %d, urgent: %d%%\n",
+                SMARTFARM_BUILD, transport_kind_name(transport_kind_from_env()), duration_s, ngen,
+                urgent_pct);
+        fprintf(csv, "zones,rate,sent,processed,throughput,p50_us,p99_us,max_us,urgent,urgent_p99_us,"
+                     "shed,mode_changes,cpu_us_per_sample,rss_kb,verdict\n");
+    }
+
+    printf("부하 벤치마크 (조합당 %d초, 생성기 %d개, 전송 %s, 긴급 %d%%, 기준선 %s)\n", duration_s,
+           ngen, transport_kind_name(transport_kind_from_env()), urgent_pct,
+           baseline_path != NULL ? baseline_path : "없음");
+    printf("빌드: %s\n\n", SMARTFARM_BUILD);
+    printf("%6s %7s %10s %10s %9s %9s %10s %10s %9s %10s %8s  %s\n", "ZONES", "RATE", "PROCESSED",
+           "MSG/s", "p50(us)", "p99(us)", "max(us)", "긴급p99", "SHED", "CPU us/건", "RSS(kB)", "판정");
+    printf("-----------------------------------------------------------------------------------------------------------------------\n");
+    fflush(stdout);
+
+    SoakResult results[MAX_LIST * MAX_LIST];
+    int nres = 0, failed = 0;
+    for (int zi = 0; zi < nz; zi++) {
+        for (int ri = 0; ri < nr; ri++) {
+            SoakResult *r = &results[nres];
+            if (run_case(zones[zi], rates[ri], duration_s, ngen, r) == -1) {
+                failed++;
+                continue;
+            }
+            nres++;
+
+            const char *verdict = "-";
+            char why[160] = "";
+            for (int b = 0; b < nbudget; b++) {
+                if (budgets[b].zones == r->zones && budgets[b].rate == r->rate) {
+                    verdict = check_budget(r, &budgets[b], why, sizeof(why)) ? "FAIL" : "ok";
+                    if (strcmp(verdict, "FAIL") == 0) failed++;
+                }
+            }
+            if (r->processed < r->sent) {
+                verdict = "FAIL";
+                snprintf(why, sizeof(why), " 미처리 %llu건",
+                         (unsigned long long)(r->sent - r->processed));
+                failed++;
+            }
+            char urgent_col[24] = "-";
+            if (r->urgent > 0) {
+                snprintf(urgent_col, sizeof(urgent_col), "%.1f", r->urgent_p99_us);
+            }
+            printf("%6ld %7ld %10llu %10.0f %9.1f %9.1f %10.1f %10s %9llu %10.2f %8ld  %s%s\n",
+                   r->zones, r->rate, (unsigned long long)r->processed, r->throughput,
+                   r->p50_us, r->p99_us, r->max_us, urgent_col, (unsigned long long)r->shed,
+                   r->cpu_us_per_sample, r->rss_kb, verdict, why);
+            fflush(stdout);
+            if (csv != NULL) {
+                fprintf(csv, "%ld,%ld,%llu,%llu,%.0f,%.1f,%.1f,%.1f,%llu,%.1f,%llu,%ld,%.3f,%ld,%s\n",
+                        r->zones, r->rate, (unsigned long long)r->sent,
+                        (unsigned long long)r->processed, r->throughput, r->p50_us, r->p99_us,
+                        r->max_us, (unsigned long long)r->urgent, r->urgent_p99_us,
+                        (unsigned long long)r->shed, r->mode_changes, r->cpu_us_per_sample,
+                        r->rss_kb, verdict);
+            }
+        }
+    }
+    if (csv != NULL) {
+        fclose(csv);
+    }
+
+    if (write_path != NULL) {
+        FILE *f = fopen(write_path, "w");
+        if (f == NULL) {
+            perror("[SOAK] 기준선 기록 실패");
+            return 2;
+        }
+        fprintf(f, "# bench_soak 기준선 - build: %s, transport: %s, duration: %ds, generators: %d\n",
+                SMARTFARM_BUILD, transport_kind_name(transport_kind_from_env()), duration_s, ngen);
+        fprintf(f, "# 여유: 처리량 80%%, p99 3배, CPU 1.5배+2tick, RSS 1.5배\n");
+        fprintf(f, "zones,rate,min_throughput,max_p99_us,max_cpu_us_per_sample,max_rss_kb\n");
+        for (int i = 0; i < nres; i++) {
+            const SoakResult *r = &results[i];
+            // CPU 시간은 clock tick 단위라 저부하 조합에서 양자화 오차가 큼 → 2 tick 여유 추가
+            double tick_us = r->processed ? 2e6 / sysconf(_SC_CLK_TCK) / r->processed : 0;
+            fprintf(f, "%ld,%ld,%.0f,%.1f,%.3f,%ld\n", r->zones, r->rate, r->throughput * 0.8,
+                    r->p99_us * 3, r->cpu_us_per_sample * 1.5 + tick_us, r->rss_kb * 3 / 2);
+        }
+        fclose(f);
+        printf("\n기준선 기록: %s\n", write_path);
+    }
+
+    // 전용 인스턴스의 흔적 정리 (서버 리더 잠금 파일, 작업 디렉토리)
+    char cmd[PATH_MAX + 64];
+    snprintf(cmd, sizeof(cmd), "/tmp/smartfarm.%s.lock", inst);
+    unlink(cmd);
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", work_dir);
+    if (system(cmd) != 0) {
+        fprintf(stderr, "[SOAK] 작업 디렉토리 삭제 실패: %s\n", work_dir);
+    }
+    munmap(gs, sizeof(GenShared));
+
+    if (failed > 0) {
+        printf("\n❌ 예산 초과/실패 %d건\n", failed);
+        return 1;
+    }
+    printf("\n✅ 모든 조합 통과\n");
+    return 0;
+}
@@ -0,0 +1,437 @@
+/*
+ * ==============================================================================
+ * 파일명: bench_sync.c
+ * 역할: 동기화 기법별 비용 비교 마이크로벤치마크 (sem_lock/sem_unlock 대체 검토용)
+ *
+ * 비교 대상:
+ *   - semop     : System V 세마포어 (common.h의 sem_lock/sem_unlock, SEM_UNDO)
+ *   - futex     : futex 기반 3상태 뮤텍스 (0=해제, 1=잠금, 2=대기자 있음)
+ *   - pthread   : PTHREAD_PROCESS_SHARED 뮤텍스
+ *   - spin      : test-and-test-and-set 스핀락 + 지수 백오프 (상한 도달 시 sched_yield)
+ *   - seqlock   : 시퀀스 잠금 읽기 (procs>1 이면 1개 프로세스가 계속 기록, 나머지가 읽기)
+ *
+ * 측정 방법:
+ *   - 임계 구역은 서버의 SharedData 접근 패턴을 흉내 냄
+ *     (임계값 읽기 → 구역의 온도/습도/히터/팬/갱신 시각 기록, 구역은 64개를 순환)
+ *   - 프로세스 P개(fork)가 futex 출발 신호에 맞춰 동시에 시작, 각자 N회 수행
+ *   - 처리량 = 전체 연산 수 / 가장 늦게 끝난 프로세스까지의 시간
+ *   - 지연(p50/p99)은 연산 일부를 표본으로 clock_gettime 측정 (측정 오버헤드 포함)
+ *   - procs=1 은 경쟁 없는 비용, procs>1 은 경쟁 비용
+ *
+ * 사용법:
+ *   ./bin/bench_sync [-m semop,futex,pthread,spin,seqlock] [-p 1,2,4,8]
+ *                    [-n 프로세스당 반복] [-c] [-o CSV파일]
+ *   -c: CSV 출력, -o: 표 출력과 함께 CSV 파일 저장
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/control_state.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+
+#define MAX_LIST            16
+#define MAX_BENCH_PROCS     64
+#define MAX_SAMPLES         4096    // 프로세스당 지연 표본 수
+#define BENCH_ZONES         64      // 임계 구역에서 순환하는 구역 수
+#define SPIN_BACKOFF_MAX    1024    // 스핀락 백오프 상한 (pause 횟수)
+
+enum { PRIM_SEMOP, PRIM_FUTEX, PRIM_PTHREAD, PRIM_SPIN, PRIM_SEQLOCK, PRIM_KINDS };
+static const char *prim_names[PRIM_KINDS] = { "semop", "futex", "pthread", "spin", "seqlock" };
+
+/* 프로세스별 결과 */
+typedef struct {
+    uint64_t ops;
+    uint64_t retries;           // seqlock 재시도 / spin 백오프 횟수
+    uint64_t end_ns;
+    uint32_t nsamples;
+    uint32_t samples[MAX_SAMPLES];
+} __attribute__((aligned(64))) ProcResult;
+
+/* 프로세스 간 공유 영역 (MAP_SHARED 익명 매핑) */
+typedef struct {
+    int start __attribute__((aligned(64)));     // 출발 신호 (futex 워드)
+    int stop __attribute__((aligned(64)));      // seqlock 기록자 정지
+    uint64_t t0;
+    int futex_word __attribute__((aligned(64)));
+    int spin_word __attribute__((aligned(64)));
+    unsigned seq __attribute__((aligned(64)));
+    pthread_mutex_t pmutex __attribute__((aligned(64)));
+    ProcResult results[MAX_BENCH_PROCS];
+    SharedData sd;
+} BenchShared;
+
+static BenchShared *bs;
+static int sem_id = -1;
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int parse_list(const char *s, long *out) {
+    int n = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", s);
+    for (char *tok = strtok(buf, ","); tok != NULL && n < MAX_LIST; tok = strtok(NULL, ",")) {
+        out[n++] = strtol(tok, NULL, 10);
+    }
+    return n;
+}
+
+/* ============================================================================
+ * futex 뮤텍스 (Drepper, "Futexes Are Tricky"의 mutex2)
+ * ============================================================================ */
+static inline void futex_mutex_lock(int *m) {
+    int c = 0;
+    if (__atomic_compare_exchange_n(m, &c, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+    if (c != 2) {
+        c = __atomic_exchange_n(m, 2, __ATOMIC_ACQUIRE);
+    }
+    while (c != 0) {
+        futex_wait(m, 2, -1);
+        c = __atomic_exchange_n(m, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+static inline void futex_mutex_unlock(int *m) {
+    if (__atomic_fetch_sub(m, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(m, 0, __ATOMIC_RELEASE);
+        futex_wake(m, 1);
+    }
+}
+
+/* ============================================================================
+ * 스핀락 (test-and-test-and-set + 지수 백오프)
+ * ============================================================================ */
+static inline uint64_t spin_lock(int *l) {
+    uint64_t backoffs = 0;
+    int delay = 1;
+    for (;;) {
+        if (!__atomic_load_n(l, __ATOMIC_RELAXED) &&
+            !__atomic_exchange_n(l, 1, __ATOMIC_ACQUIRE)) {
+            return backoffs;
+        }
+        backoffs++;
+        if (delay >= SPIN_BACKOFF_MAX) {
+            sched_yield();      // 보유자가 선점된 경우 (CPU보다 프로세스가 많을 때)
+            continue;
+        }
+        for (int i = 0; i < delay; i++) {
+            cpu_relax();
+        }
+        delay <<= 1;
+    }
+}
+
+static inline void spin_unlock(int *l) {
+    __atomic_store_n(l, 0, __ATOMIC_RELEASE);
+}
+
+/* ============================================================================
+ * 임계 구역: 서버의 handle_sensor_data 가 SharedData에 하는 접근
+ * ============================================================================ */
+static inline void cs_write(SharedData *sd, long i) {
+    int z = (int)(i % BENCH_ZONES);
+    int t = sd->temp_threshold, h = sd->humidity_threshold;
+    float temp = 20.0f + (float)(i % 16), hum = 40.0f + (float)(i % 32);
+    sd->zones.current_temp[z] = temp;
+    sd->zones.current_humidity[z] = hum;
+    control_put(sd, CTRL_HEATER, z, temp < t);
+    control_put(sd, CTRL_FAN, z, hum > h);
+    sd->zones.last_update[z] = (time_t)i;
+}
+
+/* seqlock 기록 (기록자 1개) */
+static inline void seqlock_write(SharedData *sd, long i) {
+    __atomic_store_n(&bs->seq, bs->seq + 1, __ATOMIC_RELAXED);     // 홀수: 기록 중
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    cs_write(sd, i);
+    __atomic_store_n(&bs->seq, bs->seq + 1, __ATOMIC_RELEASE);     // 짝수: 완료
+}
+
+/* seqlock 읽기 - 일관된 스냅샷을 얻을 때까지 재시도, 반환: 재시도 횟수 */
+static inline uint64_t seqlock_read(const SharedData *sd, long i, float *out) {
+    int z = (int)(i % BENCH_ZONES);
+    uint64_t retries = 0;
+    for (;;) {
+        unsigned s0 = __atomic_load_n(&bs->seq, __ATOMIC_ACQUIRE);
+        if (s0 & 1) {
+            retries++;
+            cpu_relax();
+            continue;
+        }
+        float temp = *(volatile const float *)&sd->zones.current_temp[z];
+        float hum = *(volatile const float *)&sd->zones.current_humidity[z];
+        uint64_t heater_w = *(volatile const uint64_t *)&sd->zones.ctrl[CTRL_HEATER][z / 64];
+        uint64_t fan_w = *(volatile const uint64_t *)&sd->zones.ctrl[CTRL_FAN][z / 64];
+        int heater = (int)((heater_w >> (z % 64)) & 1), fan = (int)((fan_w >> (z % 64)) & 1);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&bs->seq, __ATOMIC_RELAXED) == s0) {
+            *out = temp + hum + (float)(heater + fan);
+            return retries;
+        }
+        retries++;
+    }
+}
+
+/* ============================================================================
+ * 함수: worker
+ * 설명: 자식 프로세스 - 출발 신호를 기다린 뒤 iters회 수행
+ *       writer=1 이면 seqlock 기록자로 stop 신호까지 기록만 반복 (집계 제외)
+ * ============================================================================ */
+static void worker(int prim, int id, long iters, int writer) {
+    ProcResult *r = &bs->results[id];
+    SharedData *sd = &bs->sd;
+    long stride = iters / MAX_SAMPLES + 1;
+    float sink = 0;
+
+    while (__atomic_load_n(&bs->start, __ATOMIC_ACQUIRE) == 0) {
+        futex_wait(&bs->start, 0, -1);
+    }
+
+    if (writer) {
+        for (long i = 0; !__atomic_load_n(&bs->stop, __ATOMIC_RELAXED); i++) {
+            seqlock_write(sd, i);
+        }
+        _exit(0);
+    }
+
+    for (long i = 0; i < iters; i++) {
+        int sample = (i % stride == 0) && r->nsamples < MAX_SAMPLES;
+        uint64_t t = sample ? monotonic_ns() : 0;
+        switch (prim) {
+            case PRIM_SEMOP:
+                sem_lock(sem_id);
+                cs_write(sd, i);
+                sem_unlock(sem_id);
+                break;
+            case PRIM_FUTEX:
+                futex_mutex_lock(&bs->futex_word);
+                cs_write(sd, i);
+                futex_mutex_unlock(&bs->futex_word);
+                break;
+            case PRIM_PTHREAD:
+                pthread_mutex_lock(&bs->pmutex);
+                cs_write(sd, i);
+                pthread_mutex_unlock(&bs->pmutex);
+                break;
+            case PRIM_SPIN:
+                r->retries += spin_lock(&bs->spin_word);
+                cs_write(sd, i);
+                spin_unlock(&bs->spin_word);
+                break;
+            case PRIM_SEQLOCK:
+                r->retries += seqlock_read(sd, i, &sink);
+                break;
+        }
+        if (sample) {
+            uint64_t d = monotonic_ns() - t;
+            r->samples[r->nsamples++] = d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+        }
+    }
+    r->ops = (uint64_t)iters;
+    r->end_ns = monotonic_ns();
+    (void)sink;
+    _exit(0);
+}
+
+/* 결과 한 행 */
+typedef struct {
+    double ns_per_op, mops, p50_ns, p99_ns, retries_per_op;
+    uint64_t total_ops;
+    int workers;
+} CaseResult;
+
+/* ============================================================================
+ * 함수: run_case
+ * 설명: 한 조합(기법, 프로세스 수) 실행
+ * ============================================================================ */
+static void run_case(int prim, long procs, long iters, CaseResult *out) {
+    memset(bs->results, 0, sizeof(bs->results));
+    bs->start = 0;
+    bs->stop = 0;
+    bs->futex_word = 0;
+    bs->spin_word = 0;
+
+    // seqlock은 procs>1 이면 0번이 기록자 (나머지가 측정 대상 읽기)
+    int has_writer = (prim == PRIM_SEQLOCK && procs > 1);
+    pid_t writer_pid = -1;
+    for (long p = 0; p < procs; p++) {
+        int writer = has_writer && p == 0;
+        pid_t pid = fork();
+        if (pid == 0) {
+            worker(prim, (int)p, iters, writer);
+        }
+        if (writer) writer_pid = pid;
+    }
+
+    usleep(20000);   // 모든 자식이 출발 신호 대기에 들어갈 시간
+    bs->t0 = monotonic_ns();
+    __atomic_store_n(&bs->start, 1, __ATOMIC_RELEASE);
+    futex_wake(&bs->start, INT_MAX);
+
+    // 측정 대상(읽기/잠금) 프로세스가 모두 끝나면 기록자 정지
+    int remaining = (int)procs - has_writer;
+    while (remaining > 0) {
+        pid_t pid = wait(NULL);
+        if (pid == -1) break;
+        if (pid != writer_pid) remaining--;
+    }
+    __atomic_store_n(&bs->stop, 1, __ATOMIC_RELAXED);
+    while (wait(NULL) > 0) ;
+
+    uint64_t end = 0, ops = 0, retries = 0;
+    uint32_t *all = malloc(sizeof(uint32_t) * MAX_SAMPLES * procs);
+    size_t n = 0;
+    for (long p = has_writer; p < procs; p++) {
+        ProcResult *r = &bs->results[p];
+        if (r->end_ns > end) end = r->end_ns;
+        ops += r->ops;
+        retries += r->retries;
+        memcpy(all + n, r->samples, r->nsamples * sizeof(uint32_t));
+        n += r->nsamples;
+    }
+    qsort(all, n, sizeof(uint32_t), cmp_u32);
+
+    double elapsed_ns = (double)(end - bs->t0);
+    out->workers = (int)(procs - has_writer);
+    out->total_ops = ops;
+    out->mops = ops ? ops / (elapsed_ns / 1e3) : 0;
+    out->ns_per_op = ops ? elapsed_ns * out->workers / ops : 0;    // 프로세스당 연산 1회 비용
+    out->p50_ns = n ? all[n / 2] : 0;
+    out->p99_ns = n ? all[(n * 99) / 100] : 0;
+    out->retries_per_op = ops ? (double)retries / ops : 0;
+    free(all);
+}
+
+/* ============================================================================
+ * 메인 함수
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    long prims[MAX_LIST], procs[MAX_LIST];
+    int nm = 0, np = 0, csv = 0;
+    long iters = 100000;
+    const char *csv_path = NULL;
+
+    for (int i = 0; i < PRIM_KINDS; i++) prims[nm++] = i;
+    np = parse_list("1,2,4,8", procs);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "m:p:n:co:")) != -1) {
+        switch (opt) {
+            case 'm': {
+                char buf[128];
+                nm = 0;
+                snprintf(buf, sizeof(buf), "%s", optarg);
+                for (char *tok = strtok(buf, ","); tok && nm < MAX_LIST; tok = strtok(NULL, ",")) {
+                    int k = -1;
+                    for (int i = 0; i < PRIM_KINDS; i++) {
+                        if (strcmp(tok, prim_names[i]) == 0) k = i;
+                    }
+                    if (k < 0) {
+                        fprintf(stderr, "알 수 없는 기법: %s\n", tok);
+                        return 1;
+                    }
+                    prims[nm++] = k;
+                }
+                break;
+            }
+            case 'p': np = parse_list(optarg, procs); break;
+            case 'n': iters = strtol(optarg, NULL, 10); break;
+            case 'c': csv = 1; break;
+            case 'o': csv_path = optarg; break;
+            default:
+                fprintf(stderr, "사용법: %s [-m 기법,...] [-p 프로세스수,...] [-n 반복] [-c] [-o CSV파일]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    for (int i = 0; i < np; i++) {
+        if (procs[i] < 1 || procs[i] > MAX_BENCH_PROCS) {
+            fprintf(stderr, "프로세스 수는 1~%d\n", MAX_BENCH_PROCS);
+            return 1;
+        }
+    }
+
+    // 공유 영역과 세마포어 준비
+    bs = mmap(NULL, sizeof(BenchShared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (bs == MAP_FAILED) {
+        perror("[BENCH] mmap 실패");
+        return 1;
+    }
+    bs->sd.temp_threshold = 28;
+    bs->sd.humidity_threshold = 70;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&bs->pmutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    sem_id = semget(IPC_PRIVATE, 1, IPC_CREAT | 0600);
+    if (sem_id == -1) {
+        perror("[BENCH] semget 실패");
+        return 1;
+    }
+    union semun arg = { .val = 1 };
+    semctl(sem_id, 0, SETVAL, arg);
+
+    FILE *out = NULL;
+    if (csv_path != NULL && (out = fopen(csv_path, "w")) == NULL) {
+        perror("[BENCH] CSV 파일 열기 실패");
+        semctl(sem_id, 0, IPC_RMID);
+        return 1;
+    }
+    const char *header = "primitive,procs,workers,ops,ns_per_op,mops_per_sec,p50_ns,p99_ns,retries_per_op\n";
+    if (out != NULL) {
+        fprintf(out, "# build: %s, cpus: %ld\n%s", SMARTFARM_BUILD, sysconf(_SC_NPROCESSORS_ONLN), header);
+    }
+    if (csv) {
+        fprintf(stderr, "# build: %s, cpus: %ld\n", SMARTFARM_BUILD, sysconf(_SC_NPROCESSORS_ONLN));
+        printf("%s", header);
+    } else {
+        printf("동기화 기법 벤치마크 (프로세스당 %ld회, CPU %ld개, seqlock은 procs>1 이면 기록자 1개 포함)\n",
+               iters, sysconf(_SC_NPROCESSORS_ONLN));
+        printf("빌드: %s\n\n", SMARTFARM_BUILD);
+        printf("%-8s %5s %12s %10s %10s %10s %10s\n",
+               "PRIM", "PROCS", "ns/op", "Mops/s", "p50(ns)", "p99(ns)", "retry/op");
+        printf("----------------------------------------------------------------------\n");
+    }
+    fflush(stdout);
+
+    for (int m = 0; m < nm; m++) {
+        for (int p = 0; p < np; p++) {
+            CaseResult r;
+            run_case((int)prims[m], procs[p], iters, &r);
+            const char *name = prim_names[prims[m]];
+            if (out != NULL) {
+                fprintf(out, "%s,%ld,%d,%llu,%.1f,%.3f,%.0f,%.0f,%.3f\n", name, procs[p], r.workers,
+                        (unsigned long long)r.total_ops, r.ns_per_op, r.mops, r.p50_ns, r.p99_ns,
+                        r.retries_per_op);
+            }
+            if (csv) {
+                printf("%s,%ld,%d,%llu,%.1f,%.3f,%.0f,%.0f,%.3f\n", name, procs[p], r.workers,
+                       (unsigned long long)r.total_ops, r.ns_per_op, r.mops, r.p50_ns, r.p99_ns,
+                       r.retries_per_op);
+            } else {
+                printf("%-8s %5ld %12.1f %10.3f %10.0f %10.0f %10.3f\n", name, procs[p],
+                       r.ns_per_op, r.mops, r.p50_ns, r.p99_ns, r.retries_per_op);
+            }
+            fflush(stdout);
+        }
+    }
+
+    if (out != NULL) {
+        fclose(out);
+    }
+    semctl(sem_id, 0, IPC_RMID);
+    pthread_mutex_destroy(&bs->pmutex);
+    munmap(bs, sizeof(BenchShared));
+    return 0;
+}
@@ -0,0 +1,239 @@
+/*
+ * ==============================================================================
+ * 파일명: bench_transport.c
+ * 역할: 전송 계층 백엔드별 처리량/지연 시간 비교 벤치마크
+ *
+ * 측정 방법:
+ *   - 처리량: 생산자 P개(fork)가 각각 N개 메시지를 최대 속도로 전송,
+ *             소비자(부모)가 모두 수신할 때까지의 시간으로 msg/s, MB/s 계산
+ *             메시지에 담긴 송신 시각으로 부하 상태 지연(p50/p99)도 함께 측정
+ *   - 무부하 지연: 생산자 1개가 일정 간격으로 전송하여 단방향 지연(p50/p99) 측정
+ *   - 시각은 CLOCK_MONOTONIC (같은 호스트의 프로세스 간 비교 가능)
+ *   - -N: 서버처럼 TRANSPORT_NONBLOCK 수신으로 비우기 (EAGAIN이면 양보 후 재시도)
+ *         → 서버 수신 경로의 논블로킹 수신 비용까지 포함한 처리량
+ *
+ * 사용법:
+ *   ./bin/bench_transport [-b sysv,mq,shmring,unix] [-s 32,256,1024,4096]
+ *                         [-p 1,2,4] [-n 메시지수] [-N] [-c]
+ *   -c: CSV 출력
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/transport.h"
+
+#include <sched.h>
+#include <stdint.h>
+
+#define MAX_LIST            16
+#define LATENCY_SAMPLES     2000    // 무부하 지연 측정 메시지 수
+#define LATENCY_GAP_NS      50000   // 무부하 측정 시 송신 간격 (50us)
+
+static int recv_flags;              // -N: TRANSPORT_NONBLOCK
+
+typedef struct {
+    long msg_type;
+    uint64_t send_ns;               // 송신 시각
+    uint32_t producer;
+    uint32_t seq;
+    char payload[];
+} BenchMsg;
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* ============================================================================
+ * 함수: parse_list
+ * 설명: "1,2,4" 형식의 쉼표 목록 파싱
+ * ============================================================================ */
+static int parse_list(const char *s, long *out) {
+    int n = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", s);
+    for (char *tok = strtok(buf, ","); tok != NULL && n < MAX_LIST; tok = strtok(NULL, ",")) {
+        out[n++] = strtol(tok, NULL, 10);
+    }
+    return n;
+}
+
+/* ============================================================================
+ * 함수: producer
+ * 설명: 자식 프로세스 - count개 메시지 전송 (gap_ns > 0 이면 간격 유지)
+ * ============================================================================ */
+static void producer(TransportKind kind, key_t key, uint32_t id, long size,
+                     long count, uint64_t gap_ns) {
+    Transport *t = transport_open(kind, key, 0);
+    if (t == NULL) {
+        perror("[BENCH] 생산자 채널 연결 실패");
+        _exit(1);
+    }
+    BenchMsg *msg = calloc(1, size);
+    msg->msg_type = 1;
+    msg->producer = id;
+
+    uint64_t next = monotonic_ns();
+    for (long i = 0; i < count; i++) {
+        if (gap_ns > 0) {
+            while (monotonic_ns() < next) ;   // 바쁜 대기로 간격 유지 (sleep 지터 배제)
+            next += gap_ns;
+        }
+        msg->seq = (uint32_t)i;
+        msg->send_ns = monotonic_ns();
+        if (transport_send(t, msg, size) == -1) {
+            perror("[BENCH] 전송 실패");
+            _exit(1);
+        }
+    }
+    free(msg);
+    transport_close(t);
+    _exit(0);
+}
+
+/* ============================================================================
+ * 함수: run_case
+ * 설명: 한 조합(백엔드, 크기, 생산자 수) 실행
+ *       producers=0 은 무부하 지연 측정 모드
+ * 반환: 0=성공, -1=백엔드 사용 불가
+ * ============================================================================ */
+static int run_case(TransportKind kind, long size, long producers, long count,
+                    double *msgs_per_sec, double *p50_us, double *p99_us) {
+    key_t key = (key_t)(0x5A000000 | (getpid() & 0xffff));
+    Transport *rx = transport_open(kind, key, TRANSPORT_CREATE);
+    if (rx == NULL) {
+        return -1;
+    }
+
+    int latency_mode = (producers == 0);
+    long nprod = latency_mode ? 1 : producers;
+    long per = latency_mode ? LATENCY_SAMPLES : count;
+    long total = nprod * per;
+    uint64_t *lat = malloc(total * sizeof(uint64_t));
+    char *buf = malloc(TRANSPORT_MAX_MSG);
+
+    uint64_t start = monotonic_ns();
+    for (long p = 0; p < nprod; p++) {
+        if (fork() == 0) {
+            producer(kind, key, (uint32_t)p, size, per, latency_mode ? LATENCY_GAP_NS : 0);
+        }
+    }
+
+    long got = 0;
+    while (got < total) {
+        ssize_t n = transport_recv(rx, buf, TRANSPORT_MAX_MSG, 0, recv_flags);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN && (recv_flags & TRANSPORT_NONBLOCK)) {
+                sched_yield();
+                continue;
+            }
+            perror("[BENCH] 수신 실패");
+            break;
+        }
+        lat[got++] = monotonic_ns() - ((BenchMsg *)buf)->send_ns;
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+    while (wait(NULL) > 0) ;
+
+    qsort(lat, got, sizeof(uint64_t), cmp_u64);
+    *msgs_per_sec = got / (elapsed / 1e9);
+    *p50_us = got ? lat[got / 2] / 1000.0 : 0;
+    *p99_us = got ? lat[(got * 99) / 100] / 1000.0 : 0;
+
+    free(lat);
+    free(buf);
+    transport_destroy(rx);
+    return 0;
+}
+
+/* ============================================================================
+ * 메인 함수
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    long backends[MAX_LIST], sizes[MAX_LIST], prods[MAX_LIST];
+    int nb = 0, ns = 0, np = 0, csv = 0;
+    long count = 20000;
+
+    for (int i = 0; i < TRANSPORT_KINDS; i++) backends[nb++] = i;
+    ns = parse_list("32,256,1024,4096", sizes);
+    np = parse_list("1,2,4", prods);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:s:p:n:Nc")) != -1) {
+        switch (opt) {
+            case 'b': {
+                char buf[128];
+                nb = 0;
+                snprintf(buf, sizeof(buf), "%s", optarg);
+                for (char *tok = strtok(buf, ","); tok && nb < MAX_LIST; tok = strtok(NULL, ",")) {
+                    int k = transport_parse_kind(tok);
+                    if (k < 0) {
+                        fprintf(stderr, "알 수 없는 백엔드: %s\n", tok);
+                        return 1;
+                    }
+                    backends[nb++] = k;
+                }
+                break;
+            }
+            case 's': ns = parse_list(optarg, sizes); break;
+            case 'p': np = parse_list(optarg, prods); break;
+            case 'n': count = strtol(optarg, NULL, 10); break;
+            case 'N': recv_flags = TRANSPORT_NONBLOCK; break;
+            case 'c': csv = 1; break;
+            default:
+                fprintf(stderr, "사용법: %s [-b 백엔드,...] [-s 크기,...] [-p 생산자,...] [-n 개수] [-N] [-c]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    if (csv) {
+        fprintf(stderr, "# build: %s\n", SMARTFARM_BUILD);
+        printf("backend,msg_size,producers,msgs_per_sec,mb_per_sec,p50_us,p99_us\n");
+    } else {
+        printf("전송 계층 벤치마크 (생산자당 %ld개, 무부하 지연은 producers=0, 수신: %s)\n", count,
+               recv_flags ? "논블로킹" : "블로킹");
+        printf("빌드: %s\n\n", SMARTFARM_BUILD);
+        printf("%-8s %8s %9s %12s %9s %10s %10s\n",
+               "BACKEND", "SIZE(B)", "PRODUCERS", "MSG/s", "MB/s", "p50(us)", "p99(us)");
+        printf("----------------------------------------------------------------------\n");
+    }
+
+    for (int b = 0; b < nb; b++) {
+        for (int s = 0; s < ns; s++) {
+            long size = sizes[s];
+            if (size < (long)sizeof(BenchMsg)) size = sizeof(BenchMsg);
+            if (size > TRANSPORT_MAX_MSG) size = TRANSPORT_MAX_MSG;
+
+            // 무부하 지연 (producers=0) + 생산자 수별 처리량
+            for (int p = -1; p < np; p++) {
+                long producers = (p < 0) ? 0 : prods[p];
+                double rate, p50, p99;
+                if (run_case((TransportKind)backends[b], size, producers, count,
+                             &rate, &p50, &p99) == -1) {
+                    fprintf(stderr, "[BENCH] %s 백엔드 사용 불가: %s\n",
+                            transport_kind_name(backends[b]), strerror(errno));
+                    goto next_backend;
+                }
+                double mbps = rate * size / (1024.0 * 1024.0);
+                if (csv) {
+                    printf("%s,%ld,%ld,%.0f,%.2f,%.2f,%.2f\n",
+                           transport_kind_name(backends[b]), size, producers,
+                           rate, mbps, p50, p99);
+                } else {
+                    printf("%-8s %8ld %9ld %12.0f %9.2f %10.2f %10.2f\n",
+                           transport_kind_name(backends[b]), size, producers,
+                           rate, mbps, p50, p99);
+                }
+                fflush(stdout);
+            }
+        }
+next_backend:
+        ;
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * ==============================================================================
+ * 파일명: checkpoint.h
+ * 역할: SharedData 상태 체크포인트 (mmap 파일, 이중 버퍼)
+ *
+ * 구조:
+ *   - state/<인스턴스>.ckpt : [파일 헤더][슬롯 0][슬롯 1]
+ *   - 각 슬롯은 [메타(seq, 체크섬, 크기, 저장 시각)][SharedData 스냅샷]
+ *   - 저장은 항상 오래된 슬롯에 기록: 데이터 msync → 메타 msync 순서
+ *     → 기록 도중 전원이 나가도 다른 슬롯의 직전 스냅샷은 온전함
+ *   - 읽기는 체크섬이 맞는 슬롯 중 seq가 가장 큰 것을 선택
+ *   - 재부팅 등으로 공유 메모리가 사라진 뒤 서버가 시작하면 이 파일에서 복원
+ *   - 구역별 압축 이력(SharedData.hist, 마지막 멤버)은 저장하지 않음
+ *     → 스냅샷 복사/체크섬 비용과 파일 크기가 이력 크기(ZONE_HIST_BLOCKS)와 무관, 복원 시 이력은 빈 상태
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "common.h"
+
+#include <stddef.h>
+
+#define CHECKPOINT_ENV          "SMARTFARM_CHECKPOINT"      // 파일 경로 또는 "off"
+#define CHECKPOINT_PERIOD_ENV   "SMARTFARM_CHECKPOINT_SEC"  // 저장 주기 (초)
+#define CHECKPOINT_DIR          "state"
+#define CHECKPOINT_MAGIC        0x5346434B  // 'SFCK'
+#define CHECKPOINT_VERSION      2
+#define CHECKPOINT_PERIOD_SEC   10          // 기본 저장 주기
+#define CHECKPOINT_SLOTS        2
+#define CHECKPOINT_DATA_SIZE    offsetof(SharedData, hist)     // 스냅샷 범위 (압축 이력 제외)
+
+_Static_assert(offsetof(SharedData, hist) + sizeof(((SharedData *)0)->hist) == sizeof(SharedData),
+               "SharedData.hist must be the last member (excluded from checkpoints)");
+
+/* 파일 헤더 (파일 첫 페이지) */
+typedef struct {
+    uint32_t magic;             // CHECKPOINT_MAGIC
+    uint32_t version;           // CHECKPOINT_VERSION
+    uint64_t slot_size;         // 슬롯 하나의 데이터 영역 크기 (페이지 배수)
+} CheckpointFileHeader;
+
+/* 슬롯 메타 (각 슬롯의 첫 페이지) */
+typedef struct {
+    uint64_t seq;               // 저장 순번 (0=빈 슬롯)
+    uint64_t checksum;          // 스냅샷 FNV-1a 64비트
+    uint64_t size;              // 스냅샷 크기 (CHECKPOINT_DATA_SIZE)
+    int64_t saved_at;           // 저장 시각
+} CheckpointSlotMeta;
+
+typedef struct {
+    int fd;
+    char *map;                  // 파일 전체 매핑
+    size_t map_size;
+    size_t slot_size;
+    uint64_t seq;               // 마지막으로 기록된 seq
+    int next;                   // 다음에 기록할 슬롯
+    char path[256];
+} Checkpoint;
+
+/* 체크포인트 파일 경로 (환경 변수 또는 state/<인스턴스>.ckpt)
+ * 반환: 0=사용, -1=비활성("off") */
+int checkpoint_default_path(char *buf, size_t len);
+
+/* 파일 열기/생성 및 매핑 - 형식이 다르면 빈 파일로 초기화 */
+int checkpoint_open(Checkpoint *ck, const char *path);
+
+/* 가장 최근의 유효한 스냅샷을 out에 복사 (압축 이력은 비움) - 반환: 0=복원, -1=없음 */
+int checkpoint_load(Checkpoint *ck, SharedData *out, time_t *saved_at);
+
+/* 저장 (2단계): begin이 돌려준 영역에 스냅샷(앞 CHECKPOINT_DATA_SIZE바이트)을 복사한 뒤 commit
+ * - 복사는 호출자가 세마포어 잠금 안에서 수행 (잠금 구간 = memcpy 한 번) */
+SharedData *checkpoint_begin(Checkpoint *ck);
+int checkpoint_commit(Checkpoint *ck);
+
+void checkpoint_close(Checkpoint *ck);
+
+#endif /* CHECKPOINT_H */
@@ -31,6 +31,10 @@
 #include <pthread.h>        // pthread - 쓰레드
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <linux/futex.h>    // futex - 프로세스 간 대기/깨우기
+#include <sys/syscall.h>
 
 /* ============================================================================
  * IPC 키 정의 (System V IPC)
@@ -39,48 +43,384 @@
 #define SHM_KEY         0x9ABC      // 공유 메모리 키 (설정값 + 제어 상태 공유)
 #define SEM_KEY         0xDEF0      // 세마포어 키 (동기화)
 
+/* ============================================================================
+ * 인스턴스 정의
+ * - SMARTFARM_INSTANCE 가 설정되면 모든 IPC 키/이름을 인스턴스별로 분리하여
+ *   한 호스트에서 여러 스마트팜을 동시에 실행 가능
+ * ============================================================================ */
+#define INSTANCE_ENV    "SMARTFARM_INSTANCE"
+
+/* ============================================================================
+ * 서버 제어 소켓 (Unix 스트림 소켓, 한 줄 텍스트 명령)
+ * - 예: echo status | nc -U /tmp/smartfarm.default.ctl
+ * ============================================================================ */
+#define CONTROL_SOCK_FMT    "/tmp/smartfarm.%s.ctl"
+#define CONTROL_SOCK_SHARD_FMT "/tmp/smartfarm.%s.shard%d.ctl"   // 2번 이후 샤드
+
+/* ============================================================================
+ * 서버 샤드 (구역 범위별 분할)
+ * - ./bin/server --shard <번호>/<개수> : 번호는 1부터, 구역을 개수만큼 균등 분할
+ * - 1번 샤드가 IPC 자원 생성/삭제, 체크포인트, 대기 서버 감시 대상 (기존 단일 서버와 동일)
+ * - System V 큐는 하나를 공유하고 msgrcv 타입(= 샤드 번호)으로 나눠 받음
+ *   그 외 전송 방식은 샤드마다 채널 (키 = 데이터 키 + 샤드 번호 - 1)
+ * - 센서는 공유 메모리의 라우팅 테이블에서 자기 구역의 샤드를 찾음
+ * ============================================================================ */
+#define MAX_SHARDS              16
+
+/* ============================================================================
+ * 긴급 우선 경로 (priority lane)
+ * - 센서가 임계값 크게 이탈(서버 경고 조건과 동일) 또는 센서 고장 값이면 긴급 표시
+ * - 긴급 전용 채널 (키 = 데이터 키 + MAX_SHARDS + 샤드 번호 - 1): 일반 채널이 가득 차
+ *   송신자가 막혀도 긴급 메시지는 자기 용량으로 들어감
+ *   System V는 긴급 큐 하나를 모든 샤드가 공유하고 긴급 타입(샤드 타입 + MAX_SHARDS)으로 나눔
+ * - 서버는 긴급 채널을 먼저 비우고, 일반 메시지를 URGENT_POLL_BATCH건 처리할 때마다 다시 확인
+ *   (일반 메시지가 수천 건 밀려 있어도 긴급 메시지는 그 뒤에서 기다리지 않음)
+ * ============================================================================ */
+#define SENSOR_FLAG_BREACH      0x1     // 임계값 크게 이탈 (고온/저온/고습)
+#define SENSOR_FLAG_FAULT       0x2     // 물리적으로 불가능한 값 (센서 고장)
+#define SENSOR_FLAGS_URGENT     (SENSOR_FLAG_BREACH | SENSOR_FLAG_FAULT)
+#define URGENT_POLL_BATCH       32      // 일반 메시지 이 건수마다 긴급 채널 재확인
+
+/* ============================================================================
+ * 빌드 프로필 (Makefile의 PROFILE과 최적화 플래그 - 벤치마크 결과 비교용)
+ * ============================================================================ */
+#ifndef SMARTFARM_BUILD
+#define SMARTFARM_BUILD         "unknown"
+#endif
+
 /* ============================================================================
  * 메시지 타입 정의
  * ============================================================================ */
-#define MSG_TYPE_SENSOR_DATA    1   // 센서 -> 서버: 센서 데이터
+#define MSG_TYPE_SENSOR_DATA    1   // 센서 -> 서버: 센서 데이터 (1번 샤드)
+#define SHARD_MSG_TYPE(shard)   (MSG_TYPE_SENSOR_DATA + (shard) - 1)    // 샤드별 msgrcv 타입
+#define SHARD_URGENT_MSG_TYPE(shard) (SHARD_MSG_TYPE(shard) + MAX_SHARDS) // 샤드별 긴급 타입
+
+/* ============================================================================
+ * 구역(Zone) 정의
+ * - 센서 데이터, 제어 상태, 이력은 구역 번호로 구분
+ * - 최대 구역 수는 빌드 시 변경 가능 (make ZONES=65536)
+ * ============================================================================ */
+#define DEFAULT_ZONE_ID         0   // 기본 구역 번호
+#ifndef MAX_ZONES
+#define MAX_ZONES               1024 // 최대 구역 수
+#endif
 
 /* ============================================================================
  * 센서 데이터 메시지 구조체
  * - 센서 프로세스(P1)가 서버(P3)로 전송
- * - 온도, 습도, 타임스탬프 포함
+ * - 구역 번호, 온도, 습도, 타임스탬프 포함
+ * - sent_ns: 송신 시각 (CLOCK_MONOTONIC) - 서버가 수신 지연 분포 집계 (0=미기록)
+ * - flags: SENSOR_FLAG_* (0=일반, 그 외=긴급 경로로 전송)
+ * - sensor_id: 등록 색인의 센서 ID (0=ID 없음, zone_id 그대로 사용)
+ *   ID가 있으면 서버는 zone_id 대신 색인이 배정한 구역 슬롯을 사용
  * ============================================================================ */
 typedef struct {
     long msg_type;              // 메시지 타입 (MSG_TYPE_SENSOR_DATA)
+    int zone_id;                // 구역 번호
     float temperature;          // 현재 온도 (섭씨)
     float humidity;             // 현재 습도 (%)
+    uint32_t flags;             // SENSOR_FLAG_*
+    uint32_t sensor_id;         // 센서 ID (0=없음)
     time_t timestamp;           // 측정 시각
+    uint64_t sent_ns;           // 송신 시각 (CLOCK_MONOTONIC)
 } SensorDataMsg;
 
+/* ============================================================================
+ * 프로세스 등록 테이블 (생존 테이블)
+ * - 각 프로세스가 시작 시 자신의 PID와 역할을 공유 메모리에 등록
+ * - 모니터가 이를 통해 전체 구성 요소를 찾아 /proc 자원 사용량을 조회
+ * - 슬롯 하나가 캐시 라인 하나: 각 프로세스는 자기 슬롯만 잠금 없이 갱신
+ *   (하트비트 시각, 루프 횟수) → 서로 다른 프로세스의 갱신이 false sharing 없음
+ * - 서버는 하트비트가 주기(period_ms)의 PROC_STALE_FACTOR배 이상 멈춘 프로세스를
+ *   응답 없음(stale)으로 표시하고, 모니터는 이를 그대로 읽어 출력
+ * ============================================================================ */
+#define MAX_PROCS               32  // 등록 가능한 최대 프로세스 수
+#define PROC_STALE_FACTOR       4   // 하트비트 주기의 몇 배 동안 갱신이 없으면 응답 없음
+
+#define PROC_ROLE_NONE          0
+#define PROC_ROLE_SERVER        1   // [P3] 서버
+#define PROC_ROLE_LOGGER        2   // [P3] 로그 기록 자식 프로세스
+#define PROC_ROLE_SENSOR        3   // [P1] 센서
+#define PROC_ROLE_ACTUATOR      4   // [P2] 액추에이터
+#define PROC_ROLE_MONITOR       5   // [P4] 모니터
+
+typedef struct {
+    pid_t pid;                  // 프로세스 ID (0=빈 슬롯)
+    int role;                   // PROC_ROLE_*
+    int zone;                   // 담당 구역 (-1=없음)
+    uint32_t period_ms;         // 하트비트 주기 (0=주기 없음: 대화형/이벤트 구동, 감시 제외)
+    uint64_t started_ns;        // 등록 시각 (CLOCK_MONOTONIC)
+    uint64_t heartbeat_ns;      // 마지막 하트비트 (CLOCK_MONOTONIC)
+    uint64_t loops;             // 메인 루프 반복 횟수
+    uint64_t work;              // 처리한 작업 수 (전송/수신 메시지 등)
+    uint32_t stale;             // 응답 없음 표시 (서버만 기록)
+} __attribute__((aligned(64))) ProcSlot;
+
+_Static_assert(sizeof(ProcSlot) == 64, "ProcSlot must fill exactly one cache line");
+
+/* ============================================================================
+ * 구역 테이블 (SoA: 필드별 배열)
+ * - 같은 필드를 연속 배치하여 전체 구역 스캔 시 캐시/TLB 효율 확보
+ * - 서버에서 수정, 센서/액추에이터/모니터에서 읽기
+ * - 제어 상태는 장치별 비트셋 (구역당 1비트, 64개 구역 = 워드 하나)
+ *   읽기/쓰기는 control_state.h (control_get / control_set)
+ * ============================================================================ */
+#define ZONE_WORDS              ((MAX_ZONES + 63) / 64)    // 구역 비트셋 워드 수
+
+#define CTRL_HEATER             0   // 히터
+#define CTRL_FAN                1   // 팬
+#define CTRL_LED                2   // LED
+#define CTRL_DEVICES            3
+
+typedef struct {
+    time_t last_update[MAX_ZONES] __attribute__((aligned(64)));        // 마지막 수신 시각 (0=미사용 구역)
+    float current_temp[MAX_ZONES] __attribute__((aligned(64)));        // 현재 온도
+    float current_humidity[MAX_ZONES] __attribute__((aligned(64)));    // 현재 습도
+    uint64_t ctrl[CTRL_DEVICES][ZONE_WORDS] __attribute__((aligned(64)));  // 제어 상태 (비트 1=ON)
+} ZoneTable;
+
+/* ============================================================================
+ * 제어 상태 게시 기록 (공유 메모리, control_state.h)
+ * - 서버는 ZoneTable.ctrl을 바꿀 때 바뀐 워드를 dirty에 표시하고, 모아서 게시(publish):
+ *   dirty 워드만 published와 XOR → 바뀐 구역과 장치를 changes 링에 추가 → 세대(gen) 증가
+ * - 세대마다 changes 링의 구간 [first, first+count)가 그 세대의 변경 집합
+ *   → 액추에이터는 마지막으로 본 세대 이후 바뀐 구역만 처리
+ * - 변경 기록이 덮어써졌거나 한 세대의 변경이 링보다 크면(count=CONTROL_GEN_RESYNC)
+ *   읽는 쪽은 published 전체를 다시 읽음
+ * ============================================================================ */
+#define CONTROL_LOG_GENS        256     // 보관하는 세대 수
+#define CONTROL_LOG_ZONES       4096    // 보관하는 변경 구역 항목 수
+#define CONTROL_DIRTY_WORDS     ((ZONE_WORDS + 63) / 64)
+#define CONTROL_ZONE_BITS       28      // 변경 항목: 구역 번호 | 바뀐 장치 비트 << CONTROL_ZONE_BITS
+#define CONTROL_GEN_RESYNC      UINT32_MAX
+_Static_assert(MAX_ZONES <= (1 << CONTROL_ZONE_BITS), "zone number must fit a control change entry");
+
+typedef struct {
+    uint32_t gen;               // 세대 번호 (슬롯 재사용 확인)
+    uint32_t count;             // 바뀐 구역 수 (CONTROL_GEN_RESYNC=전체 다시 읽기)
+    uint64_t first;             // changes 링에서 첫 항목의 누적 위치
+} ControlGen;
+
+typedef struct {
+    uint32_t gen;               // 마지막 게시 세대 (0=게시 전)
+    uint32_t reserved;
+    uint64_t head;              // 지금까지 추가한 변경 항목 수 (누적)
+    uint64_t dirty[CONTROL_DIRTY_WORDS] __attribute__((aligned(64)));                // 게시 후 바뀐 ctrl 워드
+    uint64_t published[CTRL_DEVICES][ZONE_WORDS] __attribute__((aligned(64)));       // 마지막 게시 상태
+    ControlGen gens[CONTROL_LOG_GENS] __attribute__((aligned(64)));
+    uint32_t changes[CONTROL_LOG_ZONES] __attribute__((aligned(64)));
+} ControlLog;
+
+/* ============================================================================
+ * 센서 등록 색인 (공유 메모리, sensor_index.h)
+ * - 센서 ID(0이 아닌 32비트) → 구역 슬롯: 개방 주소법(선형 탐사) 해시
+ *   버킷 수 = 구역 수 × 2 → 적재율 0.5 이하, 버킷 하나 = 64비트(상위 ID, 하위 슬롯)라 한 번에 읽힘
+ * - 등록/해제는 세마포어 구간에서 하고 색인 전체를 seqlock으로 감싸 읽는 쪽(서버 수신 경로)은
+ *   잠금 없이 조회, 해제는 묘비 없이 뒤 항목을 당겨 채움(backward shift) → 탐사 길이가 늘지 않음
+ * - 해제된 슬롯은 free_slots 스택으로 재사용, 한 번도 배정하지 않은 슬롯은 next_fresh부터 차례로
+ *   → 모두 0인 상태가 빈 색인 (콜드 시작 memset 그대로)
+ * ============================================================================ */
+#define SENSOR_INDEX_BUCKETS    (2 * MAX_ZONES)
+
+typedef struct {
+    uint32_t seq;                       // seqlock (홀수=변경 중)
+    uint32_t count;                     // 등록된 센서 수
+    uint32_t next_fresh;                // 아직 배정한 적 없는 첫 슬롯
+    uint32_t free_top;                  // free_slots 스택 깊이
+    uint64_t added;                     // 누적 등록 수
+    uint64_t removed;                   // 누적 해제 수
+    uint32_t owner[MAX_ZONES] __attribute__((aligned(64)));        // 슬롯 → 센서 ID (0=빈 슬롯)
+    uint32_t free_slots[MAX_ZONES] __attribute__((aligned(64)));   // 해제된 슬롯 스택
+    uint64_t bucket[SENSOR_INDEX_BUCKETS] __attribute__((aligned(64)));
+} __attribute__((aligned(64))) SensorIndex;
+
+/* ============================================================================
+ * 구역별 최근 표본 링 (공유 메모리, zone_ring.h)
+ * - 서버가 구역마다 마지막 ZONE_RING_SAMPLES개 표본을 기록 (구역 담당 샤드 하나만 기록)
+ * - 링마다 seqlock: 기록자는 seq를 홀수로 → 기록 → 짝수로, 읽는 쪽은 잠금 없이 복사 후
+ *   seq가 그대로이면 채택 (대시보드/경고가 로그 파일이나 추가 IPC 없이 추세 계산)
+ * - 크기 변경: make CFLAGS+=-DZONE_RING_SAMPLES=64 (2의 거듭제곱)
+ * ============================================================================ */
+#ifndef ZONE_RING_SAMPLES
+#define ZONE_RING_SAMPLES       32
+#endif
+_Static_assert((ZONE_RING_SAMPLES & (ZONE_RING_SAMPLES - 1)) == 0,
+               "ZONE_RING_SAMPLES must be a power of two");
+
+typedef struct {
+    uint32_t ts;                // 측정 시각 (time_t 하위 32비트)
+    float temperature;
+    float humidity;
+    uint16_t samples;           // 이 표본이 대표하는 수신 건수 (집계 모드에서 >1)
+    uint16_t flags;             // SENSOR_FLAG_*
+} RingSample;
+
+typedef struct {
+    uint32_t seq;               // seqlock (홀수=기록 중)
+    uint32_t count;             // 지금까지 기록한 표본 수 (다음 기록 위치)
+    uint32_t reserved[2];
+    RingSample s[ZONE_RING_SAMPLES];
+} __attribute__((aligned(64))) ZoneRing;
+
+/* ============================================================================
+ * 구역별 압축 이력 (공유 메모리, zone_hist.h)
+ * - 서버가 구역마다 수신한 표본(시각, 온도, 습도)을 Gorilla 방식으로 압축해 고정 크기 블록 링에 기록
+ *   시각: delta-of-delta 가변 길이 부호, 값: 직전 값과 XOR한 뒤 의미 있는 비트만 기록
+ * - 기본은 무손실 (float 비트 그대로 XOR, 센서 노이즈 때문에 표본당 약 6.4바이트)
+ *   손실 압축은 선택: make CFLAGS+=-DZONE_HIST_QUANTUM_SHIFT=5 → 값을 1/32 단위로 반올림한 뒤 기록
+ *   (최대 오차 1/64 = 0.016, 가수의 아래 비트가 0이 되어 표본당 약 2.8바이트)
+ *   어느 쪽도 표본당 2바이트 목표에는 못 미침 (bench_hist가 예산 초과로 FAIL 보고)
+ * - 가장 오래된 블록부터 덮어씀, 구역마다 seqlock (모니터는 복사본을 복호화)
+ * - 보관 기간 (센서 1초 주기): 기본 32블록(8KB)이면 무손실 약 21분, 1/32 반올림 약 48분
+ * - 크기 변경: make CFLAGS+=-DZONE_HIST_BLOCKS=N (구역당 블록 수, 블록 256바이트)
+ *   24시간: 무손실 2304블록(576KB), 1/32 반올림 1024블록(256KB)
+ * - 체크포인트에는 넣지 않음 (SharedData 마지막 멤버, checkpoint.h)
+ * ============================================================================ */
+#ifndef ZONE_HIST_BLOCK_BYTES
+#define ZONE_HIST_BLOCK_BYTES   256
+#endif
+#ifndef ZONE_HIST_BLOCKS
+#define ZONE_HIST_BLOCKS        32
+#endif
+#ifndef ZONE_HIST_QUANTUM_SHIFT
+#define ZONE_HIST_QUANTUM_SHIFT 0
+#endif
+#define ZONE_HIST_WORDS         ((ZONE_HIST_BLOCK_BYTES - 16) / 8)     // 블록당 비트 스트림 워드 수
+
+typedef struct {
+    uint32_t t_first;           // 첫 표본 시각 (time_t 하위 32비트)
+    uint32_t t_last;            // 마지막 표본 시각
+    uint16_t count;             // 표본 수
+    uint16_t bits;              // 비트 스트림에서 사용한 비트 수
+    uint32_t reserved;
+    uint64_t data[ZONE_HIST_WORDS];     // 비트 스트림 (워드의 최상위 비트부터)
+} HistBlock;
+
+_Static_assert(sizeof(HistBlock) == ZONE_HIST_BLOCK_BYTES, "ZONE_HIST_BLOCK_BYTES must be a multiple of 8");
+_Static_assert(ZONE_HIST_BLOCK_BYTES >= 64 && ZONE_HIST_BLOCK_BYTES <= 8192,
+               "ZONE_HIST_BLOCK_BYTES must be 64~8192 (16-bit bit count)");
+
+typedef struct {
+    uint32_t seq;               // seqlock (홀수=기록 중)
+    uint32_t head;              // 지금까지 연 블록 수 (0=비어 있음, 현재 블록 = (head-1) % ZONE_HIST_BLOCKS)
+    uint64_t samples;           // 누적 기록 표본 수
+
+    /* 부호기 상태 (서버 전용 - 다음 표본을 현재 블록에 이어 쓰기 위한 직전 값) */
+    uint32_t prev_ts;
+    int32_t prev_delta;
+    uint32_t prev_value[2];     // 직전 온도/습도 (float 비트)
+    uint8_t lead[2];            // 직전 XOR 창: 앞쪽 0 비트 수 (0xff=창 없음)
+    uint8_t trail[2];           // 직전 XOR 창: 뒤쪽 0 비트 수
+    HistBlock blocks[ZONE_HIST_BLOCKS] __attribute__((aligned(64)));
+} __attribute__((aligned(64))) ZoneHist;
+
+/* ============================================================================
+ * 구역 극값 순위 (공유 메모리, zone_rank.h)
+ * - 샤드마다 담당 구역의 온도 상위/하위, 습도 상위/하위 ZONE_RANK_K개를 정렬된 목록으로 게시
+ * - 서버는 표본마다 순위 힙을 O(log K)로 갱신하고 이벤트 묶음이 끝날 때 목록만 기록 (seqlock)
+ * - 대시보드/경고는 구역 테이블을 훑지 않고 샤드별 목록을 병합해 읽음
+ * - 크기 변경: make CFLAGS+=-DZONE_RANK_K=50
+ * ============================================================================ */
+#ifndef ZONE_RANK_K
+#define ZONE_RANK_K             20
+#endif
+
+#define RANK_HOT                0   // 온도 높은 순
+#define RANK_COLD               1   // 온도 낮은 순
+#define RANK_HUMID              2   // 습도 높은 순
+#define RANK_DRY                3   // 습도 낮은 순
+#define RANK_KINDS              4
+
+typedef struct {
+    int32_t zone;
+    float value;                // 온도(°C) 또는 습도(%)
+} RankEntry;
+
+typedef struct {
+    uint32_t seq;               // seqlock (홀수=기록 중)
+    uint32_t count[RANK_KINDS]; // 목록별 항목 수 (담당 구역 중 데이터가 있는 구역이 K개 미만이면 그만큼)
+    uint32_t rebuilds;          // 구역 전체를 다시 훑어 순위를 재계산한 횟수
+    uint64_t published_ns;      // 마지막 게시 시각 (CLOCK_MONOTONIC)
+    RankEntry e[RANK_KINDS][ZONE_RANK_K];   // 가장 극단적인 구역부터
+} __attribute__((aligned(64))) ZoneRank;
+
+/* ============================================================================
+ * 공유 메모리 헤더
+ * - 서버가 재시작할 때 기존 세그먼트를 그대로 이어받아도 되는지 판별 (웜 재시작)
+ * - magic은 콜드 초기화가 끝난 뒤 마지막에 기록 → 초기화 도중 죽은 세그먼트는 무효
+ * - SharedData 배치를 바꾸면 SHARED_VERSION을 올려 구 세그먼트를 채택하지 않게 함
+ * ============================================================================ */
+#define SHARED_MAGIC            0x53465344  // 'SFSD'
+#define SHARED_VERSION          13
+
+typedef struct {
+    uint32_t magic;             // SHARED_MAGIC (0=초기화 전)
+    uint32_t version;           // SHARED_VERSION
+    uint64_t size;              // sizeof(SharedData) - MAX_ZONES 등 빌드 설정 포함
+    uint32_t generation;        // 서버 시작(콜드/웜) 횟수
+    pid_t server_pid;           // 현재 서버 PID (0=서버 없음)
+    uint64_t heartbeat_ns;      // 서버가 주기적으로 갱신하는 CLOCK_MONOTONIC 시각 (대기 서버가 감시)
+    uint32_t heartbeat_period_ms;   // 현재 하트비트 주기 (유휴 서버는 늦춤 - 대기 서버의 정지 판정 기준)
+} SharedHeader;
+
+/* 샤드 라우팅 테이블 항목 (1번 샤드가 범위를 기록, 각 샤드가 자기 pid를 기록) */
+typedef struct {
+    int lo, hi;                 // 담당 구역 [lo, hi)
+    pid_t pid;                  // 실행 중인 샤드 서버 (0=없음)
+    int reserved;
+} ShardRoute;
+
 /* ============================================================================
  * 공유 메모리 구조체
  * - 서버(P3), 센서(P1), 액추에이터(P2), 모니터(P4)가 공유
- * - 임계값 설정 및 제어 상태 관리
+ * - 임계값 설정 및 구역별 제어 상태 관리
  * - 세마포어로 동기화하여 Race Condition 방지
+ * - 생성/연결은 shm_store.c (System V 또는 POSIX shm + mmap)
  *
  * [변경사항] 제어 상태(heater_on, fan_on, led_on)를 공유 메모리로 이동
  *           → 메시지 큐 경쟁 문제 해결
+ * [변경사항] 단일 구역 필드를 구역 테이블(ZoneTable)로 확장
+ * [변경사항] 제어 상태를 장치별 비트셋으로 압축 + 세대별 변경 집합 게시(ControlLog)
  * ============================================================================ */
 typedef struct {
-    /* 임계값 설정 (모니터에서 수정, 서버에서 읽기) */
+    SharedHeader hdr;           // 형식 식별 (웜 재시작 검증)
+
+    /* 임계값 설정 (모니터에서 수정, 서버에서 읽기) - 전체 구역 공통 */
     int temp_threshold;         // 온도 임계값 (기본: 28도)
     int humidity_threshold;     // 습도 임계값 (기본: 70%)
 
-    /* 제어 상태 (서버에서 수정, 센서/액추에이터에서 읽기) */
-    int heater_on;              // 히터 상태 (1=ON, 0=OFF)
-    int fan_on;                 // 팬 상태 (1=ON, 0=OFF)
-    int led_on;                 // LED 상태 (1=ON, 0=OFF)
+    /* 시스템 상태 */
+    int system_running;         // 시스템 실행 상태 플래그 (0=종료 요청, futex 워드)
+    int detach_seq;             // 등록 해제 횟수 (futex 워드 - 서버의 종료 확인 대기용)
+    int server_ready;           // 서버 이벤트 루프 준비 완료 (시작 시 0)
+    int ready_seq;              // 준비 완료 알림 횟수 (futex 워드 - smartfarmd의 준비 대기용)
+    int active_zones;           // 데이터를 받은 가장 큰 구역 번호 + 1 (스캔 범위)
+
+    /* 샤드 라우팅 테이블 (센서가 잠금 없이 읽음, shard_count는 마지막에 release로 기록) */
+    int shard_count;
+    ShardRoute shards[MAX_SHARDS];
 
-    /* 현재 센서 데이터 (서버에서 수정, 액추에이터/모니터에서 읽기) */
-    float current_temp;         // 현재 온도
-    float current_humidity;     // 현재 습도
+    /* 프로세스 등록 테이블 (각 프로세스가 등록/해제, 모니터에서 읽기) */
+    ProcSlot procs[MAX_PROCS];
 
-    /* 시스템 상태 */
-    int system_running;         // 시스템 실행 상태 플래그 (0=종료 요청)
+    /* 구역별 센서 데이터 및 제어 상태 */
+    ZoneTable zones;
+
+    /* 제어 상태 게시 세대와 변경 집합 (서버 기록, 액추에이터 읽기) */
+    ControlLog control;
+
+    /* 구역별 최근 표본 링 (서버 기록, 누구나 잠금 없이 읽기) */
+    ZoneRing recent[MAX_ZONES];
+
+    /* 샤드별 극값 순위 (각 샤드 서버 기록, 누구나 잠금 없이 읽기) */
+    ZoneRank rank[MAX_SHARDS];
+
+    /* 센서 ID → 구역 슬롯 등록 색인 */
+    SensorIndex sensors;
+
+    /* 구역별 압축 이력 (서버 기록, 모니터/제어 소켓 조회 - 디스크를 읽지 않음)
+     * 마지막 멤버로 둠: 체크포인트는 이 앞까지만 저장 (checkpoint.h CHECKPOINT_DATA_SIZE) */
+    ZoneHist hist[MAX_ZONES];
 } SharedData;
 
 /* ============================================================================
@@ -92,12 +432,94 @@ union semun {
     unsigned short *array;      // GETALL, SETALL용 배열
 };
 
+/* ============================================================================
+ * 함수: ipc_key
+ * 설명: 인스턴스 이름이 설정되어 있으면 기본 키에 인스턴스 해시를 섞어 반환
+ *       (미설정 시 기본 키 그대로 → 기존 실행 방식과 호환)
+ * ============================================================================ */
+static inline key_t ipc_key(key_t base) {
+    const char *inst = getenv(INSTANCE_ENV);
+    if (inst == NULL || *inst == '\0') {
+        return base;
+    }
+    unsigned int h = 2166136261u;               // FNV-1a
+    for (const char *p = inst; *p; p++) {
+        h = (h ^ (unsigned char)*p) * 16777619u;
+    }
+    return base ^ (key_t)((((h & 0x7fff) | 0x1) << 16));
+}
+
+// 인스턴스 이름 (미설정 시 "default") - POSIX 객체/소켓 이름에 사용
+static inline const char *instance_name(void) {
+    const char *inst = getenv(INSTANCE_ENV);
+    return (inst != NULL && *inst != '\0') ? inst : "default";
+}
+
+// 서버 제어 소켓 경로
+static inline void control_socket_path(char *buf, size_t len) {
+    snprintf(buf, len, CONTROL_SOCK_FMT, instance_name());
+}
+
+// 샤드 제어 소켓 경로 (1번 샤드는 기존 단일 서버 경로)
+static inline void shard_control_socket_path(char *buf, size_t len, int shard) {
+    if (shard <= 1) {
+        control_socket_path(buf, len);
+    } else {
+        snprintf(buf, len, CONTROL_SOCK_SHARD_FMT, instance_name(), shard);
+    }
+}
+
+// 샤드 번호(1부터)의 담당 구역 [lo, hi) - 균등 분할
+static inline void shard_range(int shard, int count, int *lo, int *hi) {
+    *lo = (int)((long)(shard - 1) * MAX_ZONES / count);
+    *hi = (int)((long)shard * MAX_ZONES / count);
+}
+
+// 샤드별 데이터 채널 키 (shared_queue: System V처럼 큐 하나를 타입으로 나눠 쓰는 경우)
+static inline key_t shard_channel_key(int shard, int shared_queue) {
+    return ipc_key(MSG_KEY_DATA) + (shared_queue ? 0 : shard - 1);
+}
+
+// 샤드별 긴급 채널 키 (shared_queue면 모든 샤드가 긴급 큐 하나를 타입으로 나눠 씀)
+static inline key_t shard_urgent_key(int shard, int shared_queue) {
+    return ipc_key(MSG_KEY_DATA) + MAX_SHARDS + (shared_queue ? 0 : shard - 1);
+}
+
+// 측정값의 긴급 표시 (서버 경고 조건과 같은 기준 + 센서 측정 범위 밖은 고장)
+static inline uint32_t sensor_urgent_flags(float temp, float hum, int temp_thresh, int hum_thresh) {
+    if (!(temp >= -40.0f && temp <= 85.0f) || !(hum >= 0.0f && hum <= 100.0f)) {
+        return SENSOR_FLAG_FAULT;       // NaN도 여기서 걸림
+    }
+    if (temp > temp_thresh + 5 || temp < 20.0f || hum > hum_thresh + 10) {
+        return SENSOR_FLAG_BREACH;
+    }
+    return 0;
+}
+
+// 구역 번호 유효성 검사
+static inline int zone_valid(int zone) {
+    return zone >= 0 && zone < MAX_ZONES;
+}
+
+// 구역을 담당하는 샤드 번호 (라우팅 테이블이 없거나 범위 밖이면 1번)
+static inline int shard_for_zone(const SharedData *sd, int zone) {
+    int n = __atomic_load_n(&sd->shard_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < n && i < MAX_SHARDS; i++) {
+        if (zone >= sd->shards[i].lo && zone < sd->shards[i].hi) {
+            return i + 1;
+        }
+    }
+    return 1;
+}
+
 /* ============================================================================
  * 함수 프로토타입 - 세마포어 유틸리티
  * ============================================================================ */
 // 세마포어 P 연산 (잠금)
+// SEM_UNDO: 잠금을 쥔 채 프로세스가 죽으면 커널이 되돌림
+//           (서버가 세마포어를 재초기화하지 않는 웜 재시작에서도 교착 없음)
 static inline void sem_lock(int sem_id) {
-    struct sembuf sb = {0, -1, 0};  // 세마포어 0번을 1 감소 (잠금)
+    struct sembuf sb = {0, -1, SEM_UNDO};   // 세마포어 0번을 1 감소 (잠금)
     if (semop(sem_id, &sb, 1) == -1) {
         perror("sem_lock failed");
     }
@@ -105,12 +527,181 @@ static inline void sem_lock(int sem_id) {
 
 // 세마포어 V 연산 (해제)
 static inline void sem_unlock(int sem_id) {
-    struct sembuf sb = {0, 1, 0};   // 세마포어 0번을 1 증가 (해제)
+    struct sembuf sb = {0, 1, SEM_UNDO};    // 세마포어 0번을 1 증가 (해제)
     if (semop(sem_id, &sb, 1) == -1) {
         perror("sem_unlock failed");
     }
 }
 
+/* ============================================================================
+ * 함수 프로토타입 - futex 유틸리티 (공유 메모리 위의 32비트 워드 대기/깨우기)
+ * - FUTEX_PRIVATE 플래그 없이 사용하므로 서로 다른 프로세스 간에도 동작
+ * ============================================================================ */
+// *addr == expected 인 동안 대기 (timeout_ms < 0 이면 무한 대기)
+static inline int futex_wait(volatile int *addr, int expected, int timeout_ms) {
+    struct timespec ts, *tsp = NULL;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+        tsp = &ts;
+    }
+    return (int)syscall(SYS_futex, addr, FUTEX_WAIT, expected, tsp, NULL, 0);
+}
+
+// addr 에서 대기 중인 프로세스를 최대 count 개 깨움
+static inline int futex_wake(volatile int *addr, int count) {
+    return (int)syscall(SYS_futex, addr, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+// CLOCK_MONOTONIC 나노초 (같은 호스트의 프로세스 간 비교 가능)
+static inline uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// 스핀 대기 한 번 (seqlock 재시도 등 - 하이퍼스레드 형제에게 실행 자원 양보)
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ volatile("pause");
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+// 프로세스 생존 확인 (좀비는 죽은 것으로 처리 - 부모가 아직 회수하지 않은 경우)
+static inline int pid_alive(pid_t pid) {
+    if (pid <= 0 || (kill(pid, 0) == -1 && errno == ESRCH)) {
+        return 0;
+    }
+    char path[32], buf[256];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return 1;               // /proc 없음 → kill() 결과만 사용
+    }
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+    char *p = strrchr(buf, ')');  // comm에 공백/괄호가 있어도 마지막 ')' 뒤가 상태
+    return !(p != NULL && p[1] == ' ' && p[2] == 'Z');
+}
+
+// 공유 메모리가 현재 빌드와 같은 형식으로 초기화되어 있는지 확인
+static inline int shared_header_valid(const SharedData *sd) {
+    return __atomic_load_n(&sd->hdr.magic, __ATOMIC_ACQUIRE) == SHARED_MAGIC &&
+           sd->hdr.version == SHARED_VERSION &&
+           sd->hdr.size == sizeof(SharedData);
+}
+
+/* ============================================================================
+ * 함수 프로토타입 - 프로세스 등록 유틸리티
+ * ============================================================================ */
+// 역할 이름
+static inline const char *proc_role_name(int role) {
+    switch (role) {
+        case PROC_ROLE_SERVER:   return "server";
+        case PROC_ROLE_LOGGER:   return "logger";
+        case PROC_ROLE_SENSOR:   return "sensor";
+        case PROC_ROLE_ACTUATOR: return "actuator";
+        case PROC_ROLE_MONITOR:  return "monitor";
+        default:                 return "-";
+    }
+}
+
+// 준비 완료 알림: ready_seq를 올리고 대기 중인 감독 프로세스(smartfarmd)를 깨움
+// 등록(proc_register)과 서버의 이벤트 루프 준비 완료 시 호출
+static inline void ready_announce(SharedData *sd) {
+    __atomic_add_fetch(&sd->ready_seq, 1, __ATOMIC_RELEASE);
+    futex_wake(&sd->ready_seq, INT_MAX);
+}
+
+// 현재 프로세스를 등록 테이블에 추가 (반환: 슬롯 번호, 가득 차면 -1)
+// 비정상 종료로 남은 슬롯(이미 없는 PID)은 재사용
+// zone: 담당 구역(-1=없음), period_ms: proc_heartbeat 호출 주기(0=일정하지 않음)
+static inline int proc_register(SharedData *sd, int sem_id, int role, int zone, uint32_t period_ms) {
+    int slot = -1;
+    sem_lock(sem_id);
+    for (int i = 0; i < MAX_PROCS; i++) {
+        pid_t pid = sd->procs[i].pid;
+        if (pid == 0 || !pid_alive(pid)) {
+            ProcSlot *s = &sd->procs[i];
+            uint64_t now = monotonic_ns();
+            s->role = role;
+            s->zone = zone;
+            s->period_ms = period_ms;
+            s->started_ns = now;
+            s->heartbeat_ns = now;
+            s->loops = 0;
+            s->work = 0;
+            s->stale = 0;
+            __atomic_store_n(&s->pid, getpid(), __ATOMIC_RELEASE);  // pid는 마지막에 공개
+            slot = i;
+            break;
+        }
+    }
+    sem_unlock(sem_id);
+    ready_announce(sd);
+    return slot;
+}
+
+// 하트비트: 메인 루프 1회마다 호출 (잠금 없음 - 자기 슬롯만 기록)
+// work: 이번 루프에서 처리한 작업 수
+static inline void proc_heartbeat(SharedData *sd, int slot, uint64_t work) {
+    if (slot < 0 || slot >= MAX_PROCS) {
+        return;
+    }
+    ProcSlot *s = &sd->procs[slot];
+    __atomic_store_n(&s->loops, s->loops + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->work, s->work + work, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->heartbeat_ns, monotonic_ns(), __ATOMIC_RELEASE);
+}
+
+// 마지막 하트비트 이후 경과 시간 (ms)
+static inline uint64_t proc_heartbeat_age_ms(const ProcSlot *s, uint64_t now) {
+    uint64_t hb = __atomic_load_n(&s->heartbeat_ns, __ATOMIC_ACQUIRE);
+    return now <= hb ? 0 : (now - hb) / 1000000ull;
+}
+
+// 응답 없음 판정: 하트비트가 주기의 PROC_STALE_FACTOR배 이상 멈춤
+static inline int proc_is_stale(const ProcSlot *s, uint64_t now) {
+    return s->period_ms != 0 &&
+           proc_heartbeat_age_ms(s, now) >= (uint64_t)s->period_ms * PROC_STALE_FACTOR;
+}
+
+// 등록 테이블에서 슬롯 해제
+static inline void proc_unregister(SharedData *sd, int sem_id, int slot) {
+    if (slot < 0 || slot >= MAX_PROCS) {
+        return;
+    }
+    sem_lock(sem_id);
+    if (sd->procs[slot].pid == getpid()) {
+        __atomic_store_n(&sd->procs[slot].pid, 0, __ATOMIC_RELEASE);
+        sd->procs[slot].role = PROC_ROLE_NONE;
+    }
+    sem_unlock(sem_id);
+
+    // 종료 확인(ack): 세마포어를 놓은 뒤에 알려야 서버가 바로 IPC를 제거해도 안전
+    __atomic_add_fetch(&sd->detach_seq, 1, __ATOMIC_RELEASE);
+    futex_wake(&sd->detach_seq, INT_MAX);
+}
+
+/* ============================================================================
+ * 함수 프로토타입 - 종료 브로드캐스트
+ * - 서버: system_running=0 후 futex로 대기 중인 모든 프로세스를 한 번에 깨움
+ * - 주기적으로 도는 프로세스: usleep 대신 shutdown_wait로 쉬면 종료 즉시 깨어남
+ * ============================================================================ */
+// 최대 timeout_ms 동안 대기 - 종료 요청이 오면 즉시 반환
+static inline void shutdown_wait(SharedData *sd, int timeout_ms) {
+    futex_wait(&sd->system_running, 1, timeout_ms);
+}
+
+// 모든 프로세스에 종료 알림 (호출자가 세마포어 보유 여부와 무관)
+static inline void shutdown_broadcast(SharedData *sd) {
+    __atomic_store_n(&sd->system_running, 0, __ATOMIC_RELEASE);
+    futex_wake(&sd->system_running, INT_MAX);
+}
+
 /* ============================================================================
  * 디버그 매크로
  * ============================================================================ */
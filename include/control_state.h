@@ -0,0 +1,157 @@
+/*
+ * ==============================================================================
+ * 파일명: control_state.h
+ * 역할: 구역 제어 상태 비트셋 (ZoneTable.ctrl) 읽기/쓰기와 변경 집합 게시 (SharedData.control)
+ *
+ * 구조:
+ *   - 제어 상태는 장치(히터/팬/LED)마다 구역당 1비트 → 구역 1024개 = 장치당 128바이트
+ *   - 서버는 control_set으로 비트를 바꾸고 (값이 같으면 아무것도 하지 않음)
+ *     이벤트 묶음 처리가 끝날 때 control_publish로 한 번에 게시
+ *   - 게시: dirty 워드만 live ^ published → 바뀐 비트마다 변경 항목 하나 → 세대 증가
+ *   - 읽는 쪽은 마지막으로 본 세대 이후의 변경 집합만 훑음 (control_zone_changes)
+ *   - 모든 함수는 세마포어 구간 안에서 호출 (기록자/읽는 쪽 모두)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef CONTROL_STATE_H
+#define CONTROL_STATE_H
+
+#include "common.h"
+
+#define CTRL_MASK(dev)          (1u << (dev))
+
+/* 비트셋에서 구역 하나의 비트 */
+static inline int control_bit(const uint64_t *bits, int zone) {
+    return (int)((bits[zone / 64] >> (zone % 64)) & 1);
+}
+
+/* 현재(게시 전) 제어 상태 */
+static inline int control_get(const ZoneTable *zt, int dev, int zone) {
+    return control_bit(zt->ctrl[dev], zone);
+}
+
+/* 게시된 제어 상태 (변경 집합과 일치하는 상태) */
+static inline int control_published(const ControlLog *cl, int dev, int zone) {
+    return control_bit(cl->published[dev], zone);
+}
+
+/* 장치 하나의 비트 기록 - 바뀌었으면 워드를 dirty로 표시 (기록자 전용) */
+static inline void control_put(SharedData *sd, int dev, int zone, int on) {
+    uint64_t *w = &sd->zones.ctrl[dev][zone / 64];
+    uint64_t bit = 1ull << (zone % 64);
+    uint64_t v = on ? (*w | bit) : (*w & ~bit);
+    if (v != *w) {
+        *w = v;
+        sd->control.dirty[zone / 64 / 64] |= 1ull << (zone / 64 % 64);
+    }
+}
+
+/* 구역 하나의 히터/팬/LED 기록 */
+static inline void control_set(SharedData *sd, int zone, int heater, int fan, int led) {
+    control_put(sd, CTRL_HEATER, zone, heater);
+    control_put(sd, CTRL_FAN, zone, fan);
+    control_put(sd, CTRL_LED, zone, led);
+}
+
+/* 세대 하나 추가 (변경 항목은 이미 changes 링에 기록됨) */
+static inline void control_append_gen(ControlLog *cl, uint64_t first, uint32_t count) {
+    uint32_t gen = cl->gen + 1;
+    ControlGen *g = &cl->gens[gen % CONTROL_LOG_GENS];
+    g->gen = gen;
+    g->count = count;
+    g->first = first;
+    __atomic_store_n(&cl->gen, gen, __ATOMIC_RELEASE);
+}
+
+/* ============================================================================
+ * 함수: control_publish
+ * 설명: dirty 워드의 바뀐 비트를 변경 집합으로 만들어 새 세대로 게시
+ *       변경 항목이 링보다 많으면 항목 대신 전체 다시 읽기 세대를 게시
+ * 반환: 바뀐 구역 수 (0=게시할 것 없음, 세대 그대로)
+ * ============================================================================ */
+static inline uint32_t control_publish(SharedData *sd) {
+    ControlLog *cl = &sd->control;
+    const ZoneTable *zt = &sd->zones;
+    uint64_t first = cl->head;
+    uint32_t count = 0;
+
+    for (int d = 0; d < CONTROL_DIRTY_WORDS; d++) {
+        uint64_t dirty = cl->dirty[d];
+        cl->dirty[d] = 0;
+        while (dirty != 0) {
+            int w = d * 64 + __builtin_ctzll(dirty);
+            dirty &= dirty - 1;
+            uint64_t diff[CTRL_DEVICES], any = 0;
+            for (int dev = 0; dev < CTRL_DEVICES; dev++) {
+                diff[dev] = zt->ctrl[dev][w] ^ cl->published[dev][w];
+                cl->published[dev][w] = zt->ctrl[dev][w];
+                any |= diff[dev];
+            }
+            while (any != 0) {
+                int b = __builtin_ctzll(any);
+                any &= any - 1;
+                uint32_t mask = 0;
+                for (int dev = 0; dev < CTRL_DEVICES; dev++) {
+                    mask |= (uint32_t)((diff[dev] >> b) & 1) << dev;
+                }
+                if (count < CONTROL_LOG_ZONES) {
+                    cl->changes[(first + count) % CONTROL_LOG_ZONES] =
+                        (uint32_t)(w * 64 + b) | mask << CONTROL_ZONE_BITS;
+                }
+                count++;
+            }
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+    cl->head = first + count;   // 링을 넘었으면 이전 세대의 항목도 덮어썼음 → 그 세대들은 무효
+    control_append_gen(cl, first, count > CONTROL_LOG_ZONES ? CONTROL_GEN_RESYNC : count);
+    return count;
+}
+
+/* 게시 도중 죽은 서버가 남긴 상태 정리 (공유 메모리를 채택한 서버가 호출)
+ * - 현재 상태를 그대로 게시 상태로 삼고 전체 다시 읽기 세대를 추가 */
+static inline void control_repair(SharedData *sd) {
+    ControlLog *cl = &sd->control;
+    memcpy(cl->published, sd->zones.ctrl, sizeof(cl->published));
+    memset(cl->dirty, 0, sizeof(cl->dirty));
+    control_append_gen(cl, cl->head, CONTROL_GEN_RESYNC);
+}
+
+/* ============================================================================
+ * 함수: control_zone_changes
+ * 설명: since 세대 이후 게시된 변경 집합에서 구역 하나의 바뀐 장치 확인
+ *       (처음 연결한 읽는 쪽은 이 함수 대신 게시 상태 전체를 읽고 현재 세대를 since로 삼음)
+ * 반환: 바뀐 장치 비트 (CTRL_MASK, 0=변경 없음),
+ *       -1=변경 기록이 남아 있지 않음 (오래됨/덮어씀/전체 다시 읽기 세대) → 게시 상태를 다시 읽음
+ * ============================================================================ */
+static inline int control_zone_changes(const ControlLog *cl, uint32_t since, int zone) {
+    uint32_t now = cl->gen;
+    if (now == since) {
+        return 0;
+    }
+    if (now - since >= CONTROL_LOG_GENS) {
+        return -1;
+    }
+    int mask = 0;
+    for (uint32_t gen = since + 1; gen != now + 1; gen++) {
+        const ControlGen *g = &cl->gens[gen % CONTROL_LOG_GENS];
+        if (g->gen != gen || g->count == CONTROL_GEN_RESYNC ||
+            cl->head - g->first > CONTROL_LOG_ZONES) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < g->count; i++) {
+            uint32_t e = cl->changes[(g->first + i) % CONTROL_LOG_ZONES];
+            if ((int)(e & ((1u << CONTROL_ZONE_BITS) - 1)) == zone) {
+                mask |= (int)(e >> CONTROL_ZONE_BITS);
+            }
+        }
+    }
+    return mask;
+}
+
+#endif /* CONTROL_STATE_H */
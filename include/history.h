@@ -0,0 +1,106 @@
+/*
+ * ==============================================================================
+ * 파일명: history.h
+ * 역할: 구역별 센서 이력 인덱스 (로그 프로세스 기록, 모니터 조회)
+ *
+ * 구조:
+ *   - history/zoneNNNN.min  : 1분 단위 집계 버킷 (최근 수 시간 조회용)
+ *   - history/zoneNNNN.hour : 1시간 단위 집계 버킷 (수일~수개월 조회용)
+ *   - 각 파일은 [헤더][버킷][버킷]... 형태의 고정 크기 레코드 배열
+ *   - 버킷은 시간순으로만 추가되므로 이진 탐색으로 시작 위치를 찾고
+ *     필요한 구간만 pread() 한 번으로 읽는다 (smartfarm.log 전체 스캔 불필요)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+#define HISTORY_DIR             "history"   // 이력 파일 디렉토리
+#define HISTORY_MAGIC           0x53464849  // 'SFHI'
+#define HISTORY_VERSION         1
+#define HISTORY_SPARK_WIDTH     40          // 스파크라인 폭 (문자 수)
+#define HISTORY_MINUTE_SPAN     (6 * 3600)  // 이 구간 이하는 분 단위, 초과 시 시간 단위 사용
+#define HISTORY_FD_CACHE        64          // 파일을 열어 두는 구역 수 (구역당 fd 2개, LRU로 닫음)
+#define HISTORY_RETRY_SEC       30          // 파일 열기에 실패한 구역은 이 시간 동안 기록 생략
+
+/* 집계 레벨 */
+typedef enum {
+    HIST_LEVEL_MINUTE = 0,
+    HIST_LEVEL_HOUR   = 1,
+    HIST_LEVELS
+} HistoryLevel;
+
+/* 파일 헤더 */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t bucket_seconds;    // 버킷 크기 (60 또는 3600)
+    uint32_t record_size;       // sizeof(HistoryBucket)
+} HistoryFileHeader;
+
+/* 집계 버킷 (디스크 레코드) */
+typedef struct {
+    int64_t start;              // 버킷 시작 시각 (epoch 초, bucket_seconds 정렬)
+    uint32_t count;             // 샘플 수
+    float temp_min, temp_max;
+    float hum_min, hum_max;
+    double temp_sum, hum_sum;
+} HistoryBucket;
+
+/* 구역별 기록 상태 (로그 프로세스 내부) */
+typedef struct {
+    int fd[HIST_LEVELS];                // -1=닫힘 (fd 캐시에서 밀려났거나 아직 안 엶)
+    int slot;                           // fd 캐시 슬롯 (-1=없음)
+    int loaded;                         // 파일의 마지막 버킷을 복원했는지 (다시 열 때는 복원 생략)
+    time_t retry_at;                    // 열기 실패 후 다시 시도할 시각
+    off_t offset[HIST_LEVELS];          // 현재 버킷의 파일 오프셋
+    HistoryBucket cur[HIST_LEVELS];     // 현재(열린) 버킷
+} HistoryZoneWriter;
+
+typedef struct {
+    char dir[256];
+    HistoryZoneWriter *zones;           // zone_id로 인덱싱 (필요 시 확장)
+    int nzones;
+    int cache_zone[HISTORY_FD_CACHE];   // 슬롯별 구역 (-1=빈 슬롯)
+    uint64_t cache_used[HISTORY_FD_CACHE];  // 슬롯별 마지막 사용 순번 (LRU)
+    uint64_t tick;
+} HistoryWriter;
+
+/* 조회 결과 */
+typedef struct {
+    int zone;
+    time_t from, to;
+    HistoryLevel level;                 // 사용된 집계 레벨
+    uint32_t buckets;                   // 읽은 버킷 수
+    uint32_t samples;                   // 구간 내 샘플 수
+    float temp_min, temp_max, temp_avg;
+    float hum_min, hum_max, hum_avg;
+    float temp_series[HISTORY_SPARK_WIDTH];   // 열별 평균 (데이터 없으면 NAN)
+    float hum_series[HISTORY_SPARK_WIDTH];
+} HistoryQueryResult;
+
+/* 기록 (로그 프로세스) */
+int  history_writer_init(HistoryWriter *w, const char *dir);
+void history_writer_append(HistoryWriter *w, int zone, time_t ts,
+                           float temp, float hum);
+void history_writer_close(HistoryWriter *w);
+
+/* 조회 (모니터) - 반환: 0=성공, -1=이력 없음/오류 */
+int  history_query(const char *dir, int zone, time_t from, time_t to,
+                   HistoryQueryResult *out);
+
+/* 스파크라인 문자열 생성 (UTF-8 블록 문자, 빈 구간은 공백) */
+void history_sparkline(const float *series, int n, char *buf, size_t buflen);
+
+/* "30m", "6h", "7d", "90" (분) 형식의 기간 문자열 → 초 (실패 시 -1) */
+long history_parse_duration(const char *s);
+
+#endif /* HISTORY_H */
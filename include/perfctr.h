@@ -0,0 +1,73 @@
+/*
+ * ==============================================================================
+ * 파일명: perfctr.h
+ * 역할: 하드웨어 성능 카운터(perf_event_open) 기반 구간별 계측
+ *
+ * 구조:
+ *   - 카운터 5개(cycles, instructions, cache-misses, context-switches, task-clock)를 한 그룹으로 열고
+ *     구간 경계마다 그룹을 한 번의 read()로 읽어 직전 경계와의 차이를 해당 구간에 누적
+ *   - 구간: 수신(ingest) → 제어(control) → 로그(log) → 다음 수신 ...
+ *   - 사용 불가 카운터(가상 머신, perf_event_paranoid 등)는 건너뛰고 나머지만 사용,
+ *     하나도 열리지 않으면 계측 비활성 (호출 비용은 분기 하나)
+ *     소프트웨어 카운터(task-clock)는 PMU가 없어도 열리므로 구간별 CPU 시간은 항상 남음
+ *   - 경계마다 read() 한 번이 들어가므로 그 비용은 다음 구간에 포함됨
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PERFCTR_ENV     "SMARTFARM_PERF"    // "1"이면 계측 활성
+
+typedef enum {
+    PERF_EV_CYCLES = 0,
+    PERF_EV_INSTRUCTIONS,
+    PERF_EV_CACHE_MISSES,
+    PERF_EV_CONTEXT_SWITCHES,
+    PERF_EV_TASK_CLOCK,         // 소프트웨어: CPU 시간 (ns)
+    PERF_EVENTS
+} PerfEvent;
+
+typedef enum {
+    PERF_STAGE_INGEST = 0,      // 전송 계층 수신 + 검증
+    PERF_STAGE_CONTROL,         // 임계값 읽기, 제어 판단, 공유 메모리 기록
+    PERF_STAGE_LOG,             // 화면 출력 + 로그 파이프 전송
+    PERF_STAGES
+} PerfStage;
+
+typedef struct {
+    int enabled;                        // 카운터가 하나라도 열렸는지
+    int group_fd;                       // 그룹 리더 fd (-1=없음)
+    int fds[PERF_EVENTS];               // 이벤트별 fd (-1=사용 불가)
+    int slot[PERF_EVENTS];              // 그룹 read 결과에서의 위치
+    int nr;                             // 열린 카운터 수
+    uint64_t last[PERF_EVENTS];         // 직전 경계의 값
+    uint64_t total[PERF_STAGES][PERF_EVENTS];
+    uint64_t samples[PERF_STAGES];
+} PerfCounters;
+
+/* 환경 변수 확인 후 카운터 열기 - 반환: 열린 카운터 수 (0=비활성) */
+int perfctr_open(PerfCounters *pc);
+
+/* 구간 시작점 기록 (수신 루프 진입 시) */
+void perfctr_mark(PerfCounters *pc);
+
+/* 직전 경계부터 지금까지를 stage에 누적하고 경계를 갱신 */
+void perfctr_stage(PerfCounters *pc, PerfStage stage);
+
+/* 구간별 IPC, 샘플당 CPU 시간/캐시 미스/컨텍스트 스위치를 한 줄로 요약 (사용 불가 항목은 n/a) */
+int perfctr_format(const PerfCounters *pc, char *buf, size_t len);
+
+void perfctr_reset(PerfCounters *pc);
+void perfctr_close(PerfCounters *pc);
+
+const char *perfctr_event_name(PerfEvent ev);
+const char *perfctr_stage_name(PerfStage stage);
+
+#endif /* PERFCTR_H */
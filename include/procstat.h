@@ -0,0 +1,50 @@
+/*
+ * ==============================================================================
+ * 파일명: procstat.h
+ * 역할: /proc/<pid> 기반 프로세스 자원 사용량 샘플링
+ *
+ * 기술 요소:
+ *   - /proc/<pid>/stat   : CPU 시간(utime/stime), 페이지 폴트, 스레드 수
+ *   - /proc/<pid>/status : RSS, 자발적/비자발적 컨텍스트 스위치
+ *   - /proc/<pid>/io     : 읽기/쓰기 계열 시스템 콜 수 (syscr/syscw)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef PROCSTAT_H
+#define PROCSTAT_H
+
+#include <sys/types.h>
+
+typedef struct {
+    pid_t pid;
+    char comm[32];                      // 실행 파일 이름
+    char state;                         // R/S/D/Z ...
+    unsigned long long utime, stime;    // CPU 시간 (clock tick)
+    unsigned long long minflt, majflt;  // 페이지 폴트
+    long threads;                       // 스레드 수
+    long rss_kb;                        // 상주 메모리 (kB)
+    unsigned long long vol_ctxt;        // 자발적 컨텍스트 스위치
+    unsigned long long nonvol_ctxt;     // 비자발적 컨텍스트 스위치
+    unsigned long long syscr, syscw;    // 읽기/쓰기 계열 시스템 콜 수
+    int io_ok;                          // /proc/<pid>/io 읽기 성공 여부
+} ProcSample;
+
+/* 두 샘플 사이의 비율 값 */
+typedef struct {
+    double cpu_percent;                 // CPU 사용률 (%, 1코어=100)
+    double ctxt_per_sec;                // 컨텍스트 스위치/초 (자발+비자발)
+    double syscall_per_sec;             // 읽기/쓰기 시스템 콜/초 (io_ok일 때만)
+    double minflt_per_sec;              // minor 페이지 폴트/초
+} ProcRate;
+
+/* 반환: 0=성공, -1=프로세스 없음/읽기 실패 */
+int  procstat_sample(pid_t pid, ProcSample *out);
+
+/* prev → cur 사이의 비율 계산 (elapsed_sec: 두 샘플 간 경과 시간) */
+void procstat_rate(const ProcSample *prev, const ProcSample *cur,
+                   double elapsed_sec, ProcRate *out);
+
+#endif /* PROCSTAT_H */
@@ -0,0 +1,101 @@
+/*
+ * ==============================================================================
+ * 파일명: sensor_index.h
+ * 역할: 센서 ID → 구역 슬롯 등록 색인 (SharedData.sensors) 조회/등록/해제
+ *
+ * 구조:
+ *   - 조회(sensor_index_lookup): 서버가 표본마다 호출, 잠금 없음
+ *     seq 읽기 → 홈 버킷부터 빈 버킷까지 선형 탐사 → seq 재확인 (변경 중이었으면 다시)
+ *     seq가 움직이는 동안은 계속 재시도 (등록이 몰려도 조회가 실패하지 않음),
+ *     같은 홀수 seq에 멈춰 있을 때만 SENSOR_INDEX_BUSY
+ *   - sensor_lookup: BUSY면 세마포어를 잡고 다시 조회 (선점된 기록자를 기다리고,
+ *     세마포어를 잡은 상태에서도 홀수인 seq는 죽은 기록자의 것이므로 정리)
+ *   - 등록/해제(sensor_index_add/remove): 호출자가 세마포어를 잡고 호출, seq를 홀수로 올린 동안만 변경
+ *   - sensor_register/sensor_deregister: 세마포어까지 잡는 프로세스용 래퍼
+ *     (해제 시 구역 상태와 최근 표본 링도 비워 다음 센서가 이전 값을 물려받지 않음,
+ *      꺼진 히터/팬은 바로 게시)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef SENSOR_INDEX_H
+#define SENSOR_INDEX_H
+
+#include "common.h"
+
+#define SENSOR_INDEX_STUCK_SPINS 1000   // 같은 홀수 seq가 이만큼 계속되면 기록자가 선점되었거나 죽은 것으로 봄
+#define SENSOR_INDEX_BUSY       (-2)    // 조회 실패: 기록자가 변경 도중 멈춤 (sensor_lookup은 세마포어로 재조회)
+
+/* ID → 홈 버킷 (murmur3 fmix32 후 곱셈 축소 - 버킷 수가 2의 거듭제곱이 아니어도 균일) */
+static inline uint32_t sensor_index_home(uint32_t id) {
+    uint32_t h = id;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return (uint32_t)(((uint64_t)h * SENSOR_INDEX_BUCKETS) >> 32);
+}
+
+/* 잠금 없는 조회 - 반환: 구역 슬롯, -1=등록되지 않은 ID, SENSOR_INDEX_BUSY */
+static inline int sensor_index_lookup(const SensorIndex *ix, uint32_t id) {
+    uint32_t odd_seq = 0;
+    int spins = 0;
+    for (;;) {
+        uint32_t s0 = __atomic_load_n(&ix->seq, __ATOMIC_ACQUIRE);
+        if (s0 & 1) {
+            if (s0 != odd_seq) {
+                odd_seq = s0;
+                spins = 0;
+            } else if (++spins >= SENSOR_INDEX_STUCK_SPINS) {
+                return SENSOR_INDEX_BUSY;
+            }
+            cpu_relax();
+            continue;
+        }
+        int slot = -1;
+        uint32_t i = sensor_index_home(id);
+        for (uint32_t n = 0; n < SENSOR_INDEX_BUCKETS; n++) {
+            uint64_t e = __atomic_load_n(&ix->bucket[i], __ATOMIC_RELAXED);
+            if (e == 0) {
+                break;
+            }
+            if ((uint32_t)(e >> 32) == id) {
+                slot = (int)(uint32_t)e;
+                break;
+            }
+            if (++i == SENSOR_INDEX_BUCKETS) {
+                i = 0;
+            }
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&ix->seq, __ATOMIC_RELAXED) == s0) {
+            return slot;
+        }
+    }
+}
+
+/* 등록 (세마포어 보유 상태) - 이미 등록된 ID는 기존 슬롯 반환
+ * 반환: 구역 슬롯, -1=실패 (errno: EINVAL=ID 0, ENOSPC=슬롯 없음) */
+int sensor_index_add(SensorIndex *ix, uint32_t id);
+
+/* 해제 (세마포어 보유 상태) - 반환: 비워진 슬롯, -1=등록되지 않은 ID (errno=ENOENT) */
+int sensor_index_remove(SensorIndex *ix, uint32_t id);
+
+/* 변경 도중 죽은 프로세스가 남긴 홀수 seq 정리 (공유 메모리를 채택한 서버가 호출) */
+void sensor_index_repair(SensorIndex *ix);
+
+/* 탐사 길이 통계 (홈 버킷으로부터의 거리) - 평균/최대 */
+void sensor_index_probe_stats(const SensorIndex *ix, double *avg, uint32_t *max);
+
+/* 서버 수신 경로용: 잠금 없이 조회하고 기록자가 멈춰 있으면 세마포어로 재조회
+ * 반환: 구역 슬롯, -1=등록되지 않은 ID */
+int sensor_lookup(SharedData *sd, int sem_id, uint32_t id);
+
+/* 프로세스용: 세마포어를 잡고 등록/해제 (해제 시 구역 상태와 최근 표본 링 초기화) */
+int sensor_register(SharedData *sd, int sem_id, uint32_t id);
+int sensor_deregister(SharedData *sd, int sem_id, uint32_t id);
+
+#endif /* SENSOR_INDEX_H */
@@ -0,0 +1,68 @@
+/*
+ * ==============================================================================
+ * 파일명: shm_store.h
+ * 역할: SharedData 공유 메모리 생성/연결 (System V 또는 POSIX shm + mmap)
+ *
+ * 환경 변수:
+ *   - SMARTFARM_SHM       : sysv(기본) | posix
+ *   - SMARTFARM_INSTANCE  : 인스턴스 이름 (POSIX 이름 /smartfarm.<이름>,
+ *                           System V 키는 ipc_key()로 분리)
+ *   - SMARTFARM_HUGEPAGES : off(기본) | thp | hugetlb
+ *       thp     - 2MB 정렬 매핑 + madvise(MADV_HUGEPAGE)
+ *                 (shmem_enabled 가 advise/always 일 때 적용)
+ *       hugetlb - POSIX: /dev/hugepages/smartfarm.<이름> 파일 매핑
+ *                 System V: shmget(SHM_HUGETLB)
+ *                 실패 시 경고 후 일반 페이지로 진행
+ *   - SMARTFARM_PREFAULT  : 1(기본) | 0 - MAP_POPULATE 로 연결 시 모든 페이지 미리 매핑
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef SHM_STORE_H
+#define SHM_STORE_H
+
+#include "common.h"
+
+#define SHM_BACKEND_ENV     "SMARTFARM_SHM"
+#define HUGEPAGE_ENV        "SMARTFARM_HUGEPAGES"
+#define PREFAULT_ENV        "SMARTFARM_PREFAULT"
+#define HUGETLBFS_DIR       "/dev/hugepages"
+#define HUGEPAGE_SIZE       (2UL * 1024 * 1024)
+
+/* 백엔드 */
+#define SHM_BACKEND_SYSV    0
+#define SHM_BACKEND_POSIX   1
+
+/* 대형 페이지 방식 */
+#define SHM_HUGE_OFF        0
+#define SHM_HUGE_THP        1
+#define SHM_HUGE_HUGETLB    2
+
+/* shm_store_open() 플래그 */
+#define SHM_STORE_CREATE    0x1     // 없으면 생성 (서버)
+#define SHM_STORE_RDONLY    0x2     // 읽기 전용 연결
+
+typedef struct {
+    int backend;                // SHM_BACKEND_*
+    int huge_requested;         // 요청된 대형 페이지 방식
+    int huge_applied;           // 실제 적용된 방식 (실패 시 SHM_HUGE_OFF)
+    int prefaulted;             // 연결 시 페이지 미리 매핑 여부
+    int shm_id;                 // System V 세그먼트 ID
+    char name[160];             // POSIX 이름 또는 hugetlbfs 경로
+    size_t map_size;            // 매핑 크기
+    SharedData *data;           // 연결된 주소
+} ShmHandle;
+
+/* 연결 (CREATE 시 없으면 생성) - 반환: 0=성공, -1=실패 (errno 유지) */
+int  shm_store_open(ShmHandle *h, int flags);
+
+/* 분리 / 분리 후 삭제 */
+void shm_store_close(ShmHandle *h);
+void shm_store_destroy(ShmHandle *h);
+
+/* 로그 출력용 설명 ("posix /smartfarm.farm1 20480B thp prefault") */
+void shm_store_describe(const ShmHandle *h, char *buf, size_t len);
+
+#endif /* SHM_STORE_H */
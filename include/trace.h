@@ -0,0 +1,111 @@
+/*
+ * ==============================================================================
+ * 파일명: trace.h
+ * 역할: 프로세스별 이벤트 추적 링 (공유 메모리) - Chrome/Perfetto 타임라인용
+ *
+ * 구조:
+ *   - POSIX 공유 메모리 /smartfarm.<인스턴스>.trace 에 링 MAX_PROCS개
+ *     (링 번호 = 프로세스 등록 테이블 슬롯 → 살아 있는 프로세스끼리 겹치지 않음)
+ *   - 링마다 기록자는 자기 프로세스 하나 → 잠금 없이 기록 후 head를 release로 증가
+ *   - 이벤트 = 구간(시작 시각 + 길이) 하나: 시작/끝을 한 슬롯에 담아 링이 한 바퀴 돌아도
+ *     짝 잃은 begin/end가 생기지 않음 (덤프 시 Chrome "X" 이벤트)
+ *   - 비활성(SMARTFARM_TRACE 미설정) 시 trace_ring == NULL 검사 하나로 끝남
+ *   - bin/tracedump 가 모든 링을 읽어 Chrome trace JSON으로 병합
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "common.h"
+
+#define TRACE_ENV           "SMARTFARM_TRACE"       // "1"이면 추적 기록
+#define TRACE_SHM_FMT       "/smartfarm.%s.trace"
+#define TRACE_MAGIC         0x53465452              // 'SFTR'
+#define TRACE_VERSION       1
+#define TRACE_RING_EVENTS   8192                    // 링당 이벤트 수 (2의 거듭제곱)
+
+typedef enum {
+    TRACE_NONE = 0,
+    TRACE_SENSOR_SEND,          // [P1] 센서 측정값 전송
+    TRACE_SERVER_RECV,          // [P3] 전송 계층 수신
+    TRACE_CONTROL,              // [P3] 임계값 비교 → 제어 판단
+    TRACE_PUBLISH,              // [P3] 공유 메모리에 구역 상태 기록
+    TRACE_LOG_WRITE,            // [P3] 로그 자식: 로그 파일 + 이력 인덱스 기록
+    TRACE_ACTUATOR_RENDER,      // [P2] 대시보드 그리기
+    TRACE_IDS
+} TraceId;
+
+/* 이벤트 (16바이트) */
+typedef struct {
+    uint64_t ts_ns;             // 시작 시각 (CLOCK_MONOTONIC, 프로세스 간 공통)
+    uint32_t dur_ns;            // 길이
+    uint16_t id;                // TraceId
+    int16_t zone;               // 구역 번호 (-1=해당 없음)
+} TraceEvent;
+
+/* 링 헤더 (캐시 라인 1개) + 이벤트 */
+typedef struct {
+    pid_t pid;                  // 마지막 기록 프로세스 (0=사용된 적 없음)
+    int role;                   // PROC_ROLE_*
+    int zone;
+    uint32_t reserved;
+    uint64_t head;              // 지금까지 기록한 이벤트 수 (기록자만 증가)
+    char pad[40];
+    TraceEvent ev[TRACE_RING_EVENTS];
+} TraceRing;
+
+_Static_assert(sizeof(TraceRing) == 64 + TRACE_RING_EVENTS * sizeof(TraceEvent),
+               "TraceRing header must stay one cache line");
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rings;             // MAX_PROCS
+    uint32_t ring_events;       // TRACE_RING_EVENTS
+    char pad[48];
+    TraceRing ring[MAX_PROCS];
+} TraceShm;
+
+extern TraceRing *trace_ring;   // 이 프로세스의 링 (NULL=비활성)
+
+/* SMARTFARM_TRACE=1 이면 추적 공유 메모리에 연결(없으면 생성)하고 slot번 링을 차지
+ * 반환: 0=활성, -1=비활성 또는 실패 (실패해도 본 기능은 계속 동작) */
+int trace_init(int slot, int role, int zone);
+
+/* 링 분리 (기록된 내용은 덤프를 위해 남겨 둠) */
+void trace_close(void);
+
+/* 덤프 도구용: 읽기 전용 연결 - 반환: 매핑 (실패 시 NULL) */
+const TraceShm *trace_attach_reader(void);
+void trace_detach_reader(const TraceShm *ts);
+
+/* 추적 공유 메모리 삭제 */
+int trace_unlink(void);
+
+const char *trace_id_name(int id);
+
+/* 구간 시작 시각 (비활성이면 시계를 읽지 않음) */
+static inline uint64_t trace_begin(void) {
+    return trace_ring != NULL ? monotonic_ns() : 0;
+}
+
+/* 구간 종료: [start, 지금) 을 이벤트 하나로 기록 */
+static inline void trace_end(TraceId id, int zone, uint64_t start_ns) {
+    TraceRing *r = trace_ring;
+    if (r == NULL) {
+        return;
+    }
+    uint64_t h = r->head;
+    TraceEvent *e = &r->ev[h & (TRACE_RING_EVENTS - 1)];
+    e->ts_ns = start_ns;
+    e->dur_ns = (uint32_t)(monotonic_ns() - start_ns);
+    e->id = (uint16_t)id;
+    e->zone = (int16_t)zone;
+    __atomic_store_n(&r->head, h + 1, __ATOMIC_RELEASE);
+}
+
+#endif /* TRACE_H */
@@ -0,0 +1,81 @@
+/*
+ * ==============================================================================
+ * 파일명: transport.h
+ * 역할: 센서 → 서버 메시지 전송 계층 (실행 시 백엔드 선택)
+ *
+ * 백엔드:
+ *   - sysv    : System V 메시지 큐 (msgsnd/msgrcv, poll 불가 - 서버가 주기적으로 비움)
+ *   - mq      : POSIX 메시지 큐 (mq_send/mq_receive, poll 가능, 기본값)
+ *   - shmring : POSIX 공유 메모리 링 버퍼 (MPSC, futex 대기, FIFO 도어벨로 poll 가능)
+ *   - unix    : Unix 도메인 데이터그램 소켓 (poll 가능)
+ *
+ * 규약:
+ *   - 모든 메시지는 System V 관례대로 첫 필드가 long msg_type
+ *   - 채널은 IPC 키(key_t) 하나로 식별하며 백엔드별 이름은 키에서 유도
+ *     (mq: /smartfarm.<key>, shmring: /smartfarm.ring.<key>,
+ *      unix: /tmp/smartfarm.<key>.sock)
+ *   - 백엔드는 환경 변수 SMARTFARM_TRANSPORT 로 선택 (서버/센서 동일해야 함)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define TRANSPORT_ENV           "SMARTFARM_TRANSPORT"
+#define TRANSPORT_MAX_MSG       4096    // 최대 메시지 크기 (msg_type 포함, 바이트)
+#define TRANSPORT_DEPTH         256     // 큐 깊이 (mq maxmsg, 링 슬롯 수)
+
+/* transport_open() 플래그 */
+#define TRANSPORT_CREATE        0x1     // 수신측: 채널 생성 (서버)
+
+/* transport_recv() 플래그 */
+#define TRANSPORT_NONBLOCK      0x1     // 메시지 없으면 즉시 -1 (errno=EAGAIN)
+
+typedef enum {
+    TRANSPORT_SYSV = 0,
+    TRANSPORT_POSIX_MQ,
+    TRANSPORT_SHM_RING,
+    TRANSPORT_UNIX_DGRAM,
+    TRANSPORT_KINDS
+} TransportKind;
+
+typedef struct Transport Transport;
+
+/* 채널 열기 - 실패 시 NULL (errno 유지) */
+Transport *transport_open(TransportKind kind, key_t key, int flags);
+
+/* 메시지 전송 (큐가 가득 차면 대기) - 반환: 0=성공, -1=실패 */
+int transport_send(Transport *t, const void *msg, size_t len);
+
+/* 메시지 수신 - 반환: 수신 바이트 수(msg_type 포함), -1=실패
+ * msg_type: System V 백엔드의 msgrcv 타입 필터 (다른 백엔드는 무시, 0=전체) */
+ssize_t transport_recv(Transport *t, void *buf, size_t len, long msg_type, int flags);
+
+/* poll/epoll 가능한 fd (불가능한 백엔드는 -1: sysv, 생성측이 아닌 shmring)
+ * - 읽기 가능 통지 후 TRANSPORT_NONBLOCK 수신이 EAGAIN을 낼 때까지 모두 꺼내야
+ *   다음 통지를 받음 (edge 성격) */
+int transport_fd(const Transport *t);
+
+/* 수신 대기 중인 양과 용량 (과부하 감지용, 단위는 백엔드마다 다르므로 비율로만 사용)
+ * - sysv: 바이트 (msg_cbytes / msg_qbytes, 큐 전체 - 타입 구분 없음)
+ * - mq, shmring: 메시지 수
+ * - unix: 알 수 없음 (-1, errno=ENOTSUP)
+ * 반환: 0=성공, -1=알 수 없음 */
+int transport_backlog(const Transport *t, long *pending, long *capacity);
+
+/* 닫기 / 닫고 채널 삭제 (생성한 쪽에서 호출) */
+void transport_close(Transport *t);
+void transport_destroy(Transport *t);
+
+/* 백엔드 이름 변환 */
+const char *transport_kind_name(TransportKind kind);
+int transport_parse_kind(const char *name);     // 알 수 없는 이름이면 -1
+TransportKind transport_kind_from_env(void);    // 미설정/오류 시 TRANSPORT_POSIX_MQ
+
+#endif /* TRANSPORT_H */
@@ -0,0 +1,43 @@
+/*
+ * ==============================================================================
+ * 파일명: zone_eval.h
+ * 역할: 구역 전체 임계값 일괄 판정 → 비트마스크 (히터/팬 제어, 경고 검사)
+ *
+ * 구조:
+ *   - 입력: ZoneTable의 SoA 배열(온도/습도) 그대로, 임계값은 구역 공통 값 하나
+ *   - 출력: 구역 z의 결과가 bits[z / 64]의 (z % 64)번 비트 (마지막 워드의 남는 비트는 0)
+ *   - AVX2: 8개 구역을 비교 한 번 + movemask로 8비트씩, 64개 구역마다 워드 하나 저장
+ *     CPU가 지원할 때만 사용 (첫 호출에서 판별, SMARTFARM_SIMD=off 이면 스칼라 강제)
+ *   - NaN은 어느 비교도 참이 아님 (스칼라 `<`, `>` 와 같은 결과)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef ZONE_EVAL_H
+#define ZONE_EVAL_H
+
+#include <stdint.h>
+
+#define ZONE_EVAL_ENV       "SMARTFARM_SIMD"        // "off"면 스칼라 구현 사용
+#define ZONE_MASK_WORDS(n)  (((n) + 63) / 64)       // 구역 n개의 비트마스크 워드 수
+
+/* 히터/팬 판정: heater = temp < temp_thresh, fan = hum > hum_thresh */
+void zone_eval_controls(const float *temp, const float *hum, int n, float temp_thresh,
+                        float hum_thresh, uint64_t *heater, uint64_t *fan);
+
+/* 단일 조건: bits = v < thresh / v > thresh */
+void zone_eval_below(const float *v, int n, float thresh, uint64_t *bits);
+void zone_eval_above(const float *v, int n, float thresh, uint64_t *bits);
+
+/* 구현별 진입점 (벤치마크 비교용) - avx2는 미지원 CPU/빌드에서 스칼라로 대체 */
+void zone_eval_controls_scalar(const float *temp, const float *hum, int n, float temp_thresh,
+                               float hum_thresh, uint64_t *heater, uint64_t *fan);
+void zone_eval_controls_avx2(const float *temp, const float *hum, int n, float temp_thresh,
+                             float hum_thresh, uint64_t *heater, uint64_t *fan);
+
+/* 사용 중인 구현 이름: "avx2" | "scalar" */
+const char *zone_eval_impl(void);
+
+#endif /* ZONE_EVAL_H */
@@ -0,0 +1,232 @@
+/*
+ * ==============================================================================
+ * 파일명: zone_hist.h
+ * 역할: 구역별 압축 이력 (SharedData.hist) 기록/스트리밍 복호화/구간 조회
+ *
+ * 구조 (Gorilla 방식, 표본 = 시각 + 온도 + 습도):
+ *   - 고정 크기 블록(기본 256바이트)의 링, 블록마다 [첫 시각][마지막 시각][표본 수][사용 비트][비트 스트림]
+ *   - 블록의 첫 표본: 시각은 블록 헤더, 온도/습도는 float 32비트 그대로
+ *   - 이후 시각: delta-of-delta (dod) 가변 길이 부호
+ *       '0' (dod=0) | '10'+3비트 [-4,3] | '110'+9비트 | '1110'+16비트 | '1111'+32비트
+ *   - 이후 값: 직전 값과 XOR (기본 무손실, ZONE_HIST_QUANTUM_SHIFT를 주면 반올림한 값)
+ *       '0' (같음) | '10'+직전 창의 비트 (앞/뒤 0 비트 수가 직전 창 이상) | '11'+앞 0 수 5비트+길이-1 5비트+비트
+ *   - 부호를 임시로 만들어 현재 블록에 들어가지 않으면 다음 블록을 열어 기록 → 추가 O(1)
+ *   - 읽는 쪽은 seqlock으로 구역 하나를 통째로 복사한 뒤 복사본을 복호화 (기록자를 막지 않음)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef ZONE_HIST_H
+#define ZONE_HIST_H
+
+#include "common.h"
+#include "history.h"
+
+#define ZONE_HIST_READ_RETRIES  1000    // 이만큼 실패하면 기록자가 멈춘 것으로 보고 포기
+#define ZONE_HIST_NO_WINDOW     0xff    // XOR 창 없음 (블록 첫 표본 직후)
+#define ZONE_HIST_BLOCK_BITS    (ZONE_HIST_WORDS * 64)
+
+/* 복호화한 표본 하나 */
+typedef struct {
+    uint32_t ts;
+    float temperature;
+    float humidity;
+} HistPoint;
+
+/* 스트리밍 복호기 (복사본 하나를 가장 오래된 블록부터 순서대로) */
+typedef struct {
+    const ZoneHist *h;
+    uint32_t block;             // 다음에 열 블록 (누적 번호)
+    uint32_t end;               // 마지막 블록 다음 (= head)
+    const HistBlock *b;         // 현재 블록 (NULL=다음 블록 열기)
+    uint32_t pos;               // 현재 블록 비트 위치
+    uint32_t left;              // 현재 블록에 남은 표본 수
+    uint32_t ts;
+    int32_t delta;
+    uint32_t value[2];
+    uint8_t lead[2], trail[2];
+} HistCursor;
+
+/* 값을 1/2^ZONE_HIST_QUANTUM_SHIFT 단위로 반올림 (NaN/무한대는 그대로, 0=무손실이면 그대로) */
+static inline float zone_hist_quantize(float v) {
+    if (ZONE_HIST_QUANTUM_SHIFT == 0) {
+        return v;
+    }
+    const float scale = (float)(1 << ZONE_HIST_QUANTUM_SHIFT);
+    if (!__builtin_isfinite(v) || v > 1e9f || v < -1e9f) {
+        return v;
+    }
+    float s = v * scale;
+    return (float)(int64_t)(s >= 0 ? s + 0.5f : s - 0.5f) / scale;
+}
+
+/* 비트 스트림에서 n비트 (1~32) 읽기 - 블록 끝을 넘으면 -1 */
+static inline int zone_hist_bits(const uint64_t *w, uint32_t *pos, int n, uint32_t *out) {
+    uint32_t p = *pos;
+    if (p + (uint32_t)n > ZONE_HIST_BLOCK_BITS) {
+        return -1;
+    }
+    uint32_t i = p >> 6, o = p & 63;
+    uint64_t v = w[i] << o;
+    if (o + (uint32_t)n > 64) {
+        v |= w[i + 1] >> (64 - o);
+    }
+    *out = (uint32_t)(v >> (64 - n));
+    *pos = p + (uint32_t)n;
+    return 0;
+}
+
+/* 접두 '1'의 개수 (최대 max개, 그 뒤의 '0'까지 소비) */
+static inline int zone_hist_prefix(const uint64_t *w, uint32_t *pos, int max) {
+    int ones = 0;
+    uint32_t bit;
+    while (ones < max && zone_hist_bits(w, pos, 1, &bit) == 0 && bit) {
+        ones++;
+    }
+    return ones;
+}
+
+static inline void hist_cursor_init(HistCursor *c, const ZoneHist *h) {
+    memset(c, 0, sizeof(*c));
+    c->h = h;
+    c->end = h->head;
+    c->block = h->head > ZONE_HIST_BLOCKS ? h->head - ZONE_HIST_BLOCKS : 0;
+}
+
+/* 값 하나 복호화 (XOR 부호) */
+static inline int hist_cursor_value(HistCursor *c, int k) {
+    const uint64_t *w = c->b->data;
+    uint32_t bit, lead, len, x;
+    if (zone_hist_bits(w, &c->pos, 1, &bit) < 0) {
+        return -1;
+    }
+    if (!bit) {
+        return 0;
+    }
+    if (zone_hist_bits(w, &c->pos, 1, &bit) < 0) {
+        return -1;
+    }
+    if (bit) {
+        if (zone_hist_bits(w, &c->pos, 5, &lead) < 0 || zone_hist_bits(w, &c->pos, 5, &len) < 0) {
+            return -1;
+        }
+        len++;
+        if (lead + len > 32) {
+            return -1;
+        }
+        c->lead[k] = (uint8_t)lead;
+        c->trail[k] = (uint8_t)(32 - lead - len);
+    } else if (c->lead[k] == ZONE_HIST_NO_WINDOW) {
+        return -1;
+    }
+    len = 32u - c->lead[k] - c->trail[k];
+    if (zone_hist_bits(w, &c->pos, (int)len, &x) < 0) {
+        return -1;
+    }
+    c->value[k] ^= x << c->trail[k];
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: hist_cursor_next
+ * 설명: 다음 표본 복호화 (블록 경계에서 다음 블록으로 넘어감)
+ * 반환: 1=표본 있음, 0=끝 (손상된 블록은 건너뜀)
+ * ============================================================================ */
+static inline int hist_cursor_next(HistCursor *c, HistPoint *p) {
+    for (;;) {
+        if (c->b == NULL || c->left == 0) {
+            if (c->block >= c->end) {
+                return 0;
+            }
+            c->b = &c->h->blocks[c->block++ % ZONE_HIST_BLOCKS];
+            c->left = c->b->count;
+            c->pos = 0;
+            if (c->left == 0 || c->b->bits > ZONE_HIST_BLOCK_BITS ||
+                zone_hist_bits(c->b->data, &c->pos, 32, &c->value[0]) < 0 ||
+                zone_hist_bits(c->b->data, &c->pos, 32, &c->value[1]) < 0) {
+                c->left = 0;
+                continue;
+            }
+            c->ts = c->b->t_first;
+            c->delta = 0;
+            c->lead[0] = c->lead[1] = ZONE_HIST_NO_WINDOW;
+            c->left--;
+            break;
+        }
+        const uint64_t *w = c->b->data;
+        static const int dod_bits[5] = { 0, 3, 9, 16, 32 };
+        int code = zone_hist_prefix(w, &c->pos, 4);
+        uint32_t raw = 0;
+        if (code > 0 && zone_hist_bits(w, &c->pos, dod_bits[code], &raw) < 0) {
+            c->left = 0;
+            continue;
+        }
+        int32_t dod = 0;
+        if (code == 4) {
+            dod = (int32_t)raw;
+        } else if (code > 0) {
+            // 부호 확장 (2의 보수 dod_bits[code]비트)
+            uint32_t sign = 1u << (dod_bits[code] - 1);
+            dod = (int32_t)((raw ^ sign) - sign);
+        }
+        c->delta = (int32_t)((uint32_t)c->delta + (uint32_t)dod);
+        c->ts += (uint32_t)c->delta;
+        if (hist_cursor_value(c, 0) < 0 || hist_cursor_value(c, 1) < 0) {
+            c->left = 0;
+            continue;
+        }
+        c->left--;
+        break;
+    }
+    p->ts = c->ts;
+    memcpy(&p->temperature, &c->value[0], sizeof(float));
+    memcpy(&p->humidity, &c->value[1], sizeof(float));
+    return 1;
+}
+
+/* 구역 이력 비우기 (센서 등록 해제 - 세마포어 구간) */
+static inline void zone_hist_clear(ZoneHist *h) {
+    uint32_t seq = h->seq;
+    __atomic_store_n(&h->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    h->head = 0;
+    h->samples = 0;
+    __atomic_store_n(&h->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* 기록 도중 죽은 서버가 남긴 홀수 seq 정리 (공유 메모리를 채택한 서버가 호출)
+ * - 현재 블록은 부호기 상태와 어긋났을 수 있으므로 닫아 다음 표본부터 새 블록 */
+static inline void zone_hist_repair(ZoneHist *h) {
+    if (h->seq & 1) {
+        h->prev_ts = 0;
+        h->prev_delta = 0;
+        if (h->head > 0) {
+            h->blocks[(h->head - 1) % ZONE_HIST_BLOCKS].bits = ZONE_HIST_BLOCK_BITS;
+        }
+        __atomic_store_n(&h->seq, h->seq + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/* ============================================================================
+ * src/zone_hist.c
+ * ============================================================================ */
+
+/* 표본 하나 추가 - 서버가 세마포어 구간에서 호출 */
+void zone_hist_append(ZoneHist *h, uint32_t ts, float temp, float hum);
+
+/* 구역 하나를 seqlock으로 복사 (복사본은 hist_cursor_init으로 복호화) - 반환: 0, -1=기록자 정지 */
+int zone_hist_snapshot(const ZoneHist *h, ZoneHist *copy);
+
+/* 남아 있는 가장 오래된 표본 시각 (0=이력 없음) */
+uint32_t zone_hist_oldest(const ZoneHist *h);
+
+/* [from, to] 구간 요약 + 스파크라인 열 평균 (HistoryQueryResult.buckets = 복호화한 블록 수)
+ * 반환: 0=성공, -1=구간에 표본 없음/읽기 실패 */
+int zone_hist_query(const ZoneHist *h, int zone, time_t from, time_t to, HistoryQueryResult *out);
+
+/* 남아 있는 표본 수와 차지한 바이트 (닫힌 블록은 블록 전체, 기록 중인 블록은 헤더 + 사용 비트) */
+void zone_hist_usage(const ZoneHist *h, uint64_t *samples, uint64_t *bytes);
+
+#endif /* ZONE_HIST_H */
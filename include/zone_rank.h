@@ -0,0 +1,140 @@
+/*
+ * ==============================================================================
+ * 파일명: zone_rank.h
+ * 역할: 구역 극값 순위 (온도/습도 상위·하위 K개) 유지와 공유 메모리 게시/읽기
+ *
+ * 구조:
+ *   - 서버(ZoneRanker): 순위 종류마다 크기 2K 최소 힙 + 구역 → 힙 위치 표
+ *     표본 하나 = 힙 안 구역이면 제자리에서 위/아래로 이동, 힙 밖이면 힙의 최솟값과 비교해 교체
+ *     → 표본당 O(log K), 구역 테이블 정렬/스캔 없음
+ *   - 힙 밖 구역 값의 상한(watermark)을 함께 기록: 게시할 때 K번째 값이 상한 이상이면 정확한 순위,
+ *     아니면(힙 안 구역 값이 많이 내려감) 그때만 담당 구역을 한 번 훑어 재계산
+ *     (힙을 K가 아닌 2K로 두어 재계산이 드묾)
+ *   - 게시(zone_ranker_publish): 이벤트 묶음마다 정렬된 K개를 SharedData.rank[샤드]에 seqlock으로 기록
+ *   - 읽기(zone_rank_read): 샤드별 목록을 잠금 없이 복사해 병합 (모니터, 제어 소켓 top)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef ZONE_RANK_H
+#define ZONE_RANK_H
+
+#include "common.h"
+
+#define ZONE_RANK_READ_RETRIES  1000    // 이만큼 실패하면 기록자가 멈춘 것으로 보고 포기
+
+typedef struct ZoneRanker ZoneRanker;
+
+/* 순위 종류 이름 (hot / cold / humid / dry), 이름 → 종류 (-1=없음) */
+static inline const char *zone_rank_name(int kind) {
+    static const char *names[RANK_KINDS] = { "hot", "cold", "humid", "dry" };
+    return kind >= 0 && kind < RANK_KINDS ? names[kind] : "?";
+}
+
+static inline int zone_rank_kind(const char *name) {
+    for (int k = 0; k < RANK_KINDS; k++) {
+        if (strcmp(name, zone_rank_name(k)) == 0) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/* 높은 값이 앞인 순위인지 (hot, humid) */
+static inline int zone_rank_descending(int kind) {
+    return kind == RANK_HOT || kind == RANK_HUMID;
+}
+
+/* 샤드 하나의 목록 복사 - 반환: 항목 수, -1=기록 중 상태가 계속됨 (기록자 정지) */
+static inline int zone_rank_copy(const ZoneRank *r, int kind, RankEntry *out) {
+    for (int attempt = 0; attempt < ZONE_RANK_READ_RETRIES; attempt++) {
+        uint32_t s0 = __atomic_load_n(&r->seq, __ATOMIC_ACQUIRE);
+        if (s0 & 1) {
+            cpu_relax();
+            continue;
+        }
+        uint32_t n = __atomic_load_n(&r->count[kind], __ATOMIC_RELAXED);
+        if (n > ZONE_RANK_K) {
+            n = ZONE_RANK_K;
+        }
+        const volatile RankEntry *src = r->e[kind];
+        for (uint32_t i = 0; i < n; i++) {
+            out[i].zone = src[i].zone;
+            out[i].value = src[i].value;
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&r->seq, __ATOMIC_RELAXED) == s0) {
+            return (int)n;
+        }
+    }
+    return -1;
+}
+
+/* ============================================================================
+ * 함수: zone_rank_read
+ * 설명: 실행 중인 모든 샤드의 목록을 병합해 가장 극단적인 구역부터 최대 max개 (max ≤ ZONE_RANK_K)
+ *       (샤드 목록은 각각 정렬되어 있으므로 앞에서부터 하나씩 고르는 병합)
+ * 반환: 항목 수 (기록 중에 멈춘 샤드는 건너뜀)
+ * ============================================================================ */
+static inline int zone_rank_read(const SharedData *sd, int kind, RankEntry *out, int max) {
+    RankEntry lists[MAX_SHARDS][ZONE_RANK_K];
+    int len[MAX_SHARDS], head[MAX_SHARDS];
+    int shards = __atomic_load_n(&sd->shard_count, __ATOMIC_ACQUIRE);
+    if (shards < 1 || shards > MAX_SHARDS) {
+        shards = 1;
+    }
+    for (int s = 0; s < shards; s++) {
+        len[s] = zone_rank_copy(&sd->rank[s], kind, lists[s]);
+        head[s] = 0;
+    }
+    int desc = zone_rank_descending(kind), n = 0;
+    while (n < max) {
+        int best = -1;
+        for (int s = 0; s < shards; s++) {
+            if (head[s] >= len[s]) {
+                continue;
+            }
+            float v = lists[s][head[s]].value;
+            if (best == -1 || (desc ? v > lists[best][head[best]].value
+                                    : v < lists[best][head[best]].value)) {
+                best = s;
+            }
+        }
+        if (best == -1) {
+            break;
+        }
+        out[n++] = lists[best][head[best]++];
+    }
+    return n;
+}
+
+/* ============================================================================
+ * 서버용: 담당 구역 [zone_lo, zone_hi)의 순위 유지 (src/zone_rank.c)
+ * ============================================================================ */
+ZoneRanker *zone_ranker_create(int zone_lo, int zone_hi);
+void zone_ranker_destroy(ZoneRanker *zr);
+
+/* 표본 하나 반영 - 온도/습도가 NaN/무한대면 해당 순위에서 제외 */
+void zone_ranker_update(ZoneRanker *zr, int zone, float temp, float hum);
+
+/* 구역을 모든 순위에서 제외 (센서 등록 해제 등) */
+void zone_ranker_remove(ZoneRanker *zr, int zone);
+
+/* 바뀐 순위를 out에 게시 (필요하면 zt를 훑어 재계산) - 호출자가 세마포어 구간에서 호출
+ * force: 바뀐 것이 없어도 구역 테이블과 대조(해제된 구역 제외)하고 다시 기록
+ * 반환: 1=게시함, 0=바뀐 것 없음 */
+int zone_ranker_publish(ZoneRanker *zr, const ZoneTable *zt, ZoneRank *out, int force);
+
+/* 재계산 횟수 (진단용) */
+uint32_t zone_ranker_rebuilds(const ZoneRanker *zr);
+
+/* 게시 도중 죽은 서버가 남긴 홀수 seq 정리 (공유 메모리를 채택한 서버가 호출) */
+static inline void zone_rank_repair(ZoneRank *r) {
+    if (r->seq & 1) {
+        __atomic_store_n(&r->seq, r->seq + 1, __ATOMIC_RELEASE);
+    }
+}
+
+#endif /* ZONE_RANK_H */
@@ -0,0 +1,109 @@
+/*
+ * ==============================================================================
+ * 파일명: zone_ring.h
+ * 역할: 구역별 최근 표본 링 (SharedData.recent) 기록/읽기와 추세 계산
+ *
+ * 구조:
+ *   - 기록자는 구역을 담당하는 서버 하나 (구역 상태와 같은 세마포어 구간에서 기록)
+ *   - seqlock: seq 홀수 → 표본 기록 → count 증가 → seq 짝수 (release)
+ *   - 읽는 쪽(액추에이터, 모니터 등)은 세마포어 없이 seq → 복사 → seq 재확인,
+ *     기록 중이거나 바뀌었으면 다시 복사
+ *   - 기록자가 기록 도중 죽으면 seq가 홀수로 남으므로 읽기는 재시도 횟수를 제한하고,
+ *     서버는 공유 메모리를 채택할 때 홀수 seq를 짝수로 되돌림
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#ifndef ZONE_RING_H
+#define ZONE_RING_H
+
+#include "common.h"
+
+#define ZONE_RING_READ_RETRIES  1000    // 이만큼 실패하면 기록자가 멈춘 것으로 보고 포기
+
+/* 표본 하나 기록 (기록자 전용) */
+static inline void zone_ring_push(ZoneRing *r, const RingSample *sample) {
+    uint32_t seq = r->seq;
+    __atomic_store_n(&r->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    r->s[r->count & (ZONE_RING_SAMPLES - 1)] = *sample;
+    __atomic_store_n(&r->count, r->count + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&r->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* 일관된 스냅샷 복사 - out[0]이 가장 오래된 표본, 최대 max개 (최근 것 우선)
+ * 반환: 복사한 표본 수, -1=기록 중 상태가 계속됨 (기록자 정지) */
+static inline int zone_ring_read(const ZoneRing *r, RingSample *out, int max) {
+    for (int attempt = 0; attempt < ZONE_RING_READ_RETRIES; attempt++) {
+        uint32_t s0 = __atomic_load_n(&r->seq, __ATOMIC_ACQUIRE);
+        if (s0 & 1) {
+            cpu_relax();
+            continue;
+        }
+        uint32_t count = __atomic_load_n(&r->count, __ATOMIC_RELAXED);
+        int n = count < ZONE_RING_SAMPLES ? (int)count : ZONE_RING_SAMPLES;
+        if (n > max) {
+            n = max;
+        }
+        const volatile RingSample *src = r->s;
+        for (int i = 0; i < n; i++) {
+            const volatile RingSample *v = &src[(count - n + i) & (ZONE_RING_SAMPLES - 1)];
+            out[i].ts = v->ts;
+            out[i].temperature = v->temperature;
+            out[i].humidity = v->humidity;
+            out[i].samples = v->samples;
+            out[i].flags = v->flags;
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&r->seq, __ATOMIC_RELAXED) == s0) {
+            return n;
+        }
+    }
+    return -1;
+}
+
+/* 기록 도중 죽은 기록자가 남긴 홀수 seq 정리 (공유 메모리를 채택한 서버가 호출) */
+static inline void zone_ring_repair(ZoneRing *r) {
+    if (r->seq & 1) {
+        __atomic_store_n(&r->seq, r->seq + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/* 링 비우기 (기록자 또는 기록자와 같은 세마포어 구간 안에서 호출 - 구역 슬롯 해제 시) */
+static inline void zone_ring_clear(ZoneRing *r) {
+    uint32_t seq = r->seq;
+    __atomic_store_n(&r->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&r->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&r->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* 추세: 시각에 대한 최소제곱 기울기 (단위/분)
+ * 반환: 0=계산됨, -1=표본 2개 미만 또는 모두 같은 시각 */
+static inline int zone_ring_trend(const RingSample *s, int n, float *temp_per_min,
+                                  float *hum_per_min) {
+    if (n < 2) {
+        return -1;
+    }
+    double t0 = s[0].ts, st = 0, sx = 0, sy = 0, stt = 0, stx = 0, sty = 0;
+    for (int i = 0; i < n; i++) {
+        double t = (s[i].ts - t0) / 60.0;
+        st += t;
+        stt += t * t;
+        sx += s[i].temperature;
+        sy += s[i].humidity;
+        stx += t * s[i].temperature;
+        sty += t * s[i].humidity;
+    }
+    double den = n * stt - st * st;
+    if (den <= 0) {
+        return -1;
+    }
+    *temp_per_min = (float)((n * stx - st * sx) / den);
+    *hum_per_min = (float)((n * sty - st * sy) / den);
+    return 0;
+}
+
+#endif /* ZONE_RING_H */
@@ -0,0 +1,189 @@
+/*
+ * ==============================================================================
+ * 파일명: checkpoint.c
+ * 역할: SharedData 상태 체크포인트 구현 (mmap 파일, 이중 버퍼)
+ *
+ * 기술 요소:
+ *   - open(), ftruncate(), mmap(MAP_SHARED): 파일을 메모리처럼 읽고 쓰기
+ *   - msync(MS_SYNC): 데이터 → 메타 순서로 디스크 반영 (크래시 일관성)
+ *   - FNV-1a 체크섬: 찢어진(부분 기록된) 슬롯 검출
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/checkpoint.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static size_t page_size(void) {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static size_t round_up(size_t v, size_t align) {
+    return (v + align - 1) / align * align;
+}
+
+static uint64_t fnv1a64(const void *data, size_t len) {
+    const unsigned char *p = data;
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+/* 슬롯 i의 메타/데이터 위치 */
+static CheckpointSlotMeta *slot_meta(Checkpoint *ck, int i) {
+    return (CheckpointSlotMeta *)(ck->map + page_size() + (size_t)i * (page_size() + ck->slot_size));
+}
+
+static char *slot_data(Checkpoint *ck, int i) {
+    return (char *)slot_meta(ck, i) + page_size();
+}
+
+/* 슬롯이 현재 빌드의 유효한 스냅샷인지 확인 */
+static int slot_valid(Checkpoint *ck, int i) {
+    CheckpointSlotMeta *m = slot_meta(ck, i);
+    return m->seq != 0 && m->size == CHECKPOINT_DATA_SIZE &&
+           fnv1a64(slot_data(ck, i), CHECKPOINT_DATA_SIZE) == m->checksum &&
+           shared_header_valid((const SharedData *)slot_data(ck, i));
+}
+
+/* ============================================================================
+ * 함수: checkpoint_default_path
+ * ============================================================================ */
+int checkpoint_default_path(char *buf, size_t len) {
+    const char *env = getenv(CHECKPOINT_ENV);
+    if (env != NULL && strcmp(env, "off") == 0) {
+        return -1;
+    }
+    if (env != NULL && *env != '\0') {
+        snprintf(buf, len, "%s", env);
+    } else {
+        mkdir(CHECKPOINT_DIR, 0755);
+        snprintf(buf, len, "%s/%s.ckpt", CHECKPOINT_DIR, instance_name());
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: checkpoint_open
+ * ============================================================================ */
+int checkpoint_open(Checkpoint *ck, const char *path) {
+    memset(ck, 0, sizeof(*ck));
+    snprintf(ck->path, sizeof(ck->path), "%s", path);
+    ck->slot_size = round_up(CHECKPOINT_DATA_SIZE, page_size());
+    ck->map_size = page_size() + CHECKPOINT_SLOTS * (page_size() + ck->slot_size);
+
+    ck->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (ck->fd == -1) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(ck->fd, &st) == -1) {
+        goto fail;
+    }
+    int fresh = ((size_t)st.st_size != ck->map_size);
+    if (fresh && ftruncate(ck->fd, ck->map_size) == -1) {
+        goto fail;
+    }
+    ck->map = mmap(NULL, ck->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ck->fd, 0);
+    if (ck->map == MAP_FAILED) {
+        ck->map = NULL;
+        goto fail;
+    }
+
+    CheckpointFileHeader *fh = (CheckpointFileHeader *)ck->map;
+    if (fresh || fh->magic != CHECKPOINT_MAGIC || fh->version != CHECKPOINT_VERSION ||
+        fh->slot_size != ck->slot_size) {
+        // 새 파일이거나 다른 빌드(MAX_ZONES 등)의 파일 → 빈 체크포인트로 초기화
+        memset(ck->map, 0, ck->map_size);
+        fh->magic = CHECKPOINT_MAGIC;
+        fh->version = CHECKPOINT_VERSION;
+        fh->slot_size = ck->slot_size;
+        msync(ck->map, ck->map_size, MS_SYNC);
+    }
+
+    // 다음 기록 위치: 유효한 슬롯 중 오래된 쪽 (없으면 0번)
+    for (int i = 0; i < CHECKPOINT_SLOTS; i++) {
+        if (slot_valid(ck, i) && slot_meta(ck, i)->seq > ck->seq) {
+            ck->seq = slot_meta(ck, i)->seq;
+            ck->next = (i + 1) % CHECKPOINT_SLOTS;
+        }
+    }
+    return 0;
+
+fail:
+    close(ck->fd);
+    ck->fd = -1;
+    return -1;
+}
+
+/* ============================================================================
+ * 함수: checkpoint_load
+ * ============================================================================ */
+int checkpoint_load(Checkpoint *ck, SharedData *out, time_t *saved_at) {
+    int best = -1;
+    for (int i = 0; i < CHECKPOINT_SLOTS; i++) {
+        if (slot_valid(ck, i) && (best < 0 || slot_meta(ck, i)->seq > slot_meta(ck, best)->seq)) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return -1;
+    }
+    memcpy(out, slot_data(ck, best), CHECKPOINT_DATA_SIZE);
+    memset(out->hist, 0, sizeof(out->hist));
+    if (saved_at != NULL) {
+        *saved_at = (time_t)slot_meta(ck, best)->saved_at;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: checkpoint_begin / checkpoint_commit
+ * 설명: 기록할 슬롯의 메타를 먼저 무효화(seq=0)한 뒤 데이터 영역을 넘겨줌
+ *       commit은 데이터 msync → 메타 기록 → 메타 msync
+ * ============================================================================ */
+SharedData *checkpoint_begin(Checkpoint *ck) {
+    slot_meta(ck, ck->next)->seq = 0;
+    return (SharedData *)slot_data(ck, ck->next);
+}
+
+int checkpoint_commit(Checkpoint *ck) {
+    int i = ck->next;
+    CheckpointSlotMeta *m = slot_meta(ck, i);
+    char *data = slot_data(ck, i);
+
+    m->checksum = fnv1a64(data, CHECKPOINT_DATA_SIZE);
+    m->size = CHECKPOINT_DATA_SIZE;
+    m->saved_at = (int64_t)time(NULL);
+    if (msync(data, ck->slot_size, MS_SYNC) == -1) {
+        return -1;
+    }
+    m->seq = ck->seq + 1;
+    if (msync(m, page_size(), MS_SYNC) == -1) {
+        return -1;
+    }
+    ck->seq = m->seq;
+    ck->next = (i + 1) % CHECKPOINT_SLOTS;
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: checkpoint_close
+ * ============================================================================ */
+void checkpoint_close(Checkpoint *ck) {
+    if (ck->map != NULL) {
+        munmap(ck->map, ck->map_size);
+        ck->map = NULL;
+    }
+    if (ck->fd != -1) {
+        close(ck->fd);
+        ck->fd = -1;
+    }
+}
@@ -0,0 +1,455 @@
+/*
+ * ==============================================================================
+ * 파일명: history.c
+ * 역할: 구역별 센서 이력 인덱스 기록/조회 구현
+ *
+ * 기술 요소:
+ *   - open(), pwrite(), pread(): 고정 크기 레코드 파일 I/O
+ *   - 현재 버킷은 샘플마다 같은 위치에 덮어써서 항상 최신 상태 유지
+ *   - 열어 두는 파일은 최근에 쓴 HISTORY_FD_CACHE개 구역뿐 (LRU) → 구역 수가 fd 한도를 넘어도 기록
+ *   - 조회는 이진 탐색(O(log n) pread) + 구간 한 번 읽기
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/history.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+static const uint32_t bucket_seconds[HIST_LEVELS] = { 60, 3600 };
+static const char *level_suffix[HIST_LEVELS] = { "min", "hour" };
+
+/* ============================================================================
+ * 함수: history_path
+ * 설명: 구역/레벨별 이력 파일 경로 생성
+ * ============================================================================ */
+static void history_path(char *buf, size_t len, const char *dir, int zone, int level) {
+    snprintf(buf, len, "%s/zone%04d.%s", dir, zone, level_suffix[level]);
+}
+
+/* ============================================================================
+ * 함수: bucket_add
+ * 설명: 버킷에 샘플 하나 누적
+ * ============================================================================ */
+static void bucket_add(HistoryBucket *b, float temp, float hum) {
+    if (b->count == 0) {
+        b->temp_min = b->temp_max = temp;
+        b->hum_min = b->hum_max = hum;
+    } else {
+        if (temp < b->temp_min) b->temp_min = temp;
+        if (temp > b->temp_max) b->temp_max = temp;
+        if (hum < b->hum_min) b->hum_min = hum;
+        if (hum > b->hum_max) b->hum_max = hum;
+    }
+    b->temp_sum += temp;
+    b->hum_sum += hum;
+    b->count++;
+}
+
+/* ============================================================================
+ * 함수: open_level_file
+ * 설명: 이력 파일을 열고 (없으면 헤더와 함께 생성) 처음 열 때만 마지막 버킷을 복원
+ *       → 로그 프로세스 재시작 시 같은 분/시간 버킷을 이어서 기록
+ *       (fd 캐시에서 밀려난 뒤 다시 열 때는 메모리의 현재 버킷을 그대로 사용)
+ * ============================================================================ */
+static int open_level_file(HistoryWriter *w, HistoryZoneWriter *zw, int zone, int level) {
+    char path[320];
+    history_path(path, sizeof(path), w->dir, zone, level);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        if (errno != EMFILE && errno != ENFILE) {
+            perror("[HISTORY] 이력 파일 열기 실패");     // fd 부족은 호출자가 다른 구역을 닫고 재시도
+        }
+        return -1;
+    }
+
+    struct stat st;
+    fstat(fd, &st);
+    HistoryFileHeader hdr;
+    off_t end;
+
+    if (st.st_size < (off_t)sizeof(hdr)) {
+        hdr.magic = HISTORY_MAGIC;
+        hdr.version = HISTORY_VERSION;
+        hdr.bucket_seconds = bucket_seconds[level];
+        hdr.record_size = sizeof(HistoryBucket);
+        if (pwrite(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) {
+            perror("[HISTORY] 이력 파일 헤더 기록 실패");
+            close(fd);
+            return -1;
+        }
+        end = sizeof(hdr);
+    } else {
+        if (pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+            hdr.magic != HISTORY_MAGIC || hdr.record_size != sizeof(HistoryBucket)) {
+            fprintf(stderr, "[HISTORY] 이력 파일 형식 오류: %s\n", path);
+            close(fd);
+            return -1;
+        }
+        // 마지막 온전한 레코드 뒤를 끝으로 간주 (잘린 레코드는 덮어씀)
+        off_t nrec = (st.st_size - (off_t)sizeof(hdr)) / (off_t)sizeof(HistoryBucket);
+        end = (off_t)sizeof(hdr) + nrec * (off_t)sizeof(HistoryBucket);
+    }
+
+    zw->fd[level] = fd;
+    if (zw->loaded) {
+        return 0;
+    }
+    memset(&zw->cur[level], 0, sizeof(HistoryBucket));
+    zw->offset[level] = end;
+    if (end > (off_t)sizeof(hdr)) {
+        off_t last = end - (off_t)sizeof(HistoryBucket);
+        if (pread(fd, &zw->cur[level], sizeof(HistoryBucket), last) ==
+            (ssize_t)sizeof(HistoryBucket)) {
+            zw->offset[level] = last;   // 마지막 버킷을 현재 버킷으로 이어받음
+        }
+    }
+    return 0;
+}
+
+/* 구역의 열린 파일을 닫고 fd 캐시 슬롯 반납 */
+static void close_zone_files(HistoryWriter *w, HistoryZoneWriter *zw) {
+    for (int l = 0; l < HIST_LEVELS; l++) {
+        if (zw->fd[l] != -1) {
+            close(zw->fd[l]);
+            zw->fd[l] = -1;
+        }
+    }
+    if (zw->slot >= 0) {
+        w->cache_zone[zw->slot] = -1;
+        zw->slot = -1;
+    }
+}
+
+/* 구역 except를 제외하고 가장 오래 쓰지 않은 구역의 파일을 닫음 - 반환: 비운 슬롯, -1=닫을 구역 없음 */
+static int cache_evict(HistoryWriter *w, int except) {
+    int victim = -1;
+    for (int i = 0; i < HISTORY_FD_CACHE; i++) {
+        if (w->cache_zone[i] != -1 && w->cache_zone[i] != except &&
+            (victim == -1 || w->cache_used[i] < w->cache_used[victim])) {
+            victim = i;
+        }
+    }
+    if (victim != -1) {
+        close_zone_files(w, &w->zones[w->cache_zone[victim]]);
+    }
+    return victim;
+}
+
+/* 빈 슬롯, 없으면 가장 오래 쓰지 않은 구역의 파일을 닫고 그 슬롯 */
+static int cache_slot(HistoryWriter *w) {
+    for (int i = 0; i < HISTORY_FD_CACHE; i++) {
+        if (w->cache_zone[i] == -1) {
+            return i;
+        }
+    }
+    return cache_evict(w, -1);
+}
+
+/* ============================================================================
+ * 함수: writer_zone
+ * 설명: 구역별 기록 상태 조회 (파일이 닫혀 있으면 fd 캐시 슬롯을 잡아 엶)
+ *       열기에 실패한 구역은 HISTORY_RETRY_SEC 동안 NULL (샘플마다 open/perror 반복 방지)
+ * ============================================================================ */
+static HistoryZoneWriter *writer_zone(HistoryWriter *w, int zone) {
+    if (zone < 0) {
+        return NULL;
+    }
+    if (zone >= w->nzones) {
+        int n = w->nzones ? w->nzones : 8;
+        while (n <= zone) n *= 2;
+        HistoryZoneWriter *zones = realloc(w->zones, n * sizeof(HistoryZoneWriter));
+        if (zones == NULL) {
+            return NULL;
+        }
+        memset(&zones[w->nzones], 0, (n - w->nzones) * sizeof(HistoryZoneWriter));
+        for (int i = w->nzones; i < n; i++) {
+            for (int l = 0; l < HIST_LEVELS; l++) zones[i].fd[l] = -1;
+            zones[i].slot = -1;
+        }
+        w->zones = zones;
+        w->nzones = n;
+    }
+
+    HistoryZoneWriter *zw = &w->zones[zone];
+    if (zw->slot < 0) {
+        time_t now = time(NULL);
+        if (zw->retry_at > now) {
+            return NULL;
+        }
+        int slot = cache_slot(w);
+        zw->slot = slot;
+        w->cache_zone[slot] = zone;
+        for (int l = 0; l < HIST_LEVELS; l++) {
+            int rc;
+            // 프로세스 fd 한도가 캐시보다 작으면 다른 구역의 파일을 닫아 가며 재시도
+            while ((rc = open_level_file(w, zw, zone, l)) == -1 &&
+                   (errno == EMFILE || errno == ENFILE) && cache_evict(w, zone) != -1) {
+            }
+            if (rc == -1) {
+                if (errno == EMFILE || errno == ENFILE) {
+                    perror("[HISTORY] 이력 파일 열기 실패");
+                }
+                close_zone_files(w, zw);
+                zw->retry_at = now + HISTORY_RETRY_SEC;
+                fprintf(stderr, "[HISTORY] 구역 %d 이력 기록 중단 (%d초 후 다시 시도)\n", zone,
+                        HISTORY_RETRY_SEC);
+                return NULL;
+            }
+        }
+        zw->loaded = 1;
+    }
+    w->cache_used[zw->slot] = ++w->tick;
+    return zw;
+}
+
+/* ============================================================================
+ * 함수: history_writer_init
+ * 설명: 이력 디렉토리 준비
+ * ============================================================================ */
+int history_writer_init(HistoryWriter *w, const char *dir) {
+    memset(w, 0, sizeof(*w));
+    snprintf(w->dir, sizeof(w->dir), "%s", dir);
+    for (int i = 0; i < HISTORY_FD_CACHE; i++) {
+        w->cache_zone[i] = -1;
+    }
+    if (mkdir(dir, 0755) == -1 && errno != EEXIST) {
+        perror("[HISTORY] 이력 디렉토리 생성 실패");
+        return -1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: history_writer_append
+ * 설명: 샘플 하나를 분/시간 버킷에 누적하고 현재 버킷을 제자리에 기록
+ *       - 같은 버킷이면 같은 오프셋에 덮어쓰기
+ *       - 새 버킷이면 파일 끝에 추가
+ *       - 시계가 거꾸로 가면 현재 버킷에 합산 (파일의 시간순 보장)
+ * ============================================================================ */
+void history_writer_append(HistoryWriter *w, int zone, time_t ts,
+                           float temp, float hum) {
+    HistoryZoneWriter *zw = writer_zone(w, zone);
+    if (zw == NULL) {
+        return;
+    }
+
+    for (int l = 0; l < HIST_LEVELS; l++) {
+        HistoryBucket *b = &zw->cur[l];
+        int64_t start = (int64_t)ts - (int64_t)ts % bucket_seconds[l];
+
+        if (b->count > 0 && start > b->start) {
+            zw->offset[l] += sizeof(HistoryBucket);
+            memset(b, 0, sizeof(*b));
+        }
+        if (b->count == 0) {
+            b->start = start;
+        }
+        bucket_add(b, temp, hum);
+
+        if (pwrite(zw->fd[l], b, sizeof(*b), zw->offset[l]) != (ssize_t)sizeof(*b)) {
+            perror("[HISTORY] 이력 기록 실패");
+        }
+    }
+}
+
+/* ============================================================================
+ * 함수: history_writer_close
+ * ============================================================================ */
+void history_writer_close(HistoryWriter *w) {
+    for (int i = 0; i < w->nzones; i++) {
+        close_zone_files(w, &w->zones[i]);
+    }
+    free(w->zones);
+    w->zones = NULL;
+    w->nzones = 0;
+}
+
+/* ============================================================================
+ * 함수: lower_bound
+ * 설명: start >= key 인 첫 버킷 인덱스 (이진 탐색, 레코드당 pread 1회)
+ * ============================================================================ */
+static long lower_bound(int fd, long nrec, int64_t key) {
+    long lo = 0, hi = nrec;
+    while (lo < hi) {
+        long mid = lo + (hi - lo) / 2;
+        int64_t start;
+        off_t off = (off_t)sizeof(HistoryFileHeader) + (off_t)mid * sizeof(HistoryBucket);
+        if (pread(fd, &start, sizeof(start), off) != (ssize_t)sizeof(start)) {
+            return -1;
+        }
+        if (start < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* ============================================================================
+ * 함수: history_query
+ * 설명: [from, to] 구간의 최소/최대/평균과 스파크라인용 열별 평균 계산
+ *       구간 길이에 따라 분/시간 레벨을 선택하므로 읽는 레코드 수가
+ *       전체 이력 길이와 무관하게 수백~수천 개로 제한됨
+ * ============================================================================ */
+int history_query(const char *dir, int zone, time_t from, time_t to,
+                  HistoryQueryResult *out) {
+    memset(out, 0, sizeof(*out));
+    out->zone = zone;
+    out->from = from;
+    out->to = to;
+    out->level = (to - from <= HISTORY_MINUTE_SPAN) ? HIST_LEVEL_MINUTE : HIST_LEVEL_HOUR;
+    for (int i = 0; i < HISTORY_SPARK_WIDTH; i++) {
+        out->temp_series[i] = NAN;
+        out->hum_series[i] = NAN;
+    }
+    if (to <= from) {
+        return -1;
+    }
+
+    char path[320];
+    history_path(path, sizeof(path), dir, zone, out->level);
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+
+    struct stat st;
+    HistoryFileHeader hdr;
+    if (fstat(fd, &st) == -1 ||
+        pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+        hdr.magic != HISTORY_MAGIC || hdr.record_size != sizeof(HistoryBucket)) {
+        close(fd);
+        return -1;
+    }
+    long nrec = (long)((st.st_size - (off_t)sizeof(hdr)) / (off_t)sizeof(HistoryBucket));
+
+    // 'from'을 포함하는 버킷부터 읽기 시작
+    int64_t first = (int64_t)from - (int64_t)from % hdr.bucket_seconds;
+    long begin = lower_bound(fd, nrec, first);
+    if (begin < 0 || begin >= nrec) {
+        close(fd);
+        return -1;
+    }
+
+    // 구간에 해당하는 버킷 수의 상한 (+1: 끝 경계 버킷)
+    long want = (long)((to - first) / hdr.bucket_seconds) + 1;
+    if (want > nrec - begin) want = nrec - begin;
+
+    HistoryBucket *buf = malloc(want * sizeof(HistoryBucket));
+    if (buf == NULL) {
+        close(fd);
+        return -1;
+    }
+    off_t off = (off_t)sizeof(hdr) + (off_t)begin * sizeof(HistoryBucket);
+    ssize_t got = pread(fd, buf, want * sizeof(HistoryBucket), off);
+    close(fd);
+    long n = got > 0 ? got / (ssize_t)sizeof(HistoryBucket) : 0;
+
+    double temp_sum = 0, hum_sum = 0;
+    double col_temp[HISTORY_SPARK_WIDTH] = {0}, col_hum[HISTORY_SPARK_WIDTH] = {0};
+    uint32_t col_count[HISTORY_SPARK_WIDTH] = {0};
+    double span = (double)(to - from) + 1.0;
+
+    for (long i = 0; i < n; i++) {
+        HistoryBucket *b = &buf[i];
+        if (b->start > (int64_t)to) break;
+        if (b->count == 0) continue;
+
+        if (out->samples == 0) {
+            out->temp_min = b->temp_min; out->temp_max = b->temp_max;
+            out->hum_min = b->hum_min;   out->hum_max = b->hum_max;
+        } else {
+            if (b->temp_min < out->temp_min) out->temp_min = b->temp_min;
+            if (b->temp_max > out->temp_max) out->temp_max = b->temp_max;
+            if (b->hum_min < out->hum_min) out->hum_min = b->hum_min;
+            if (b->hum_max > out->hum_max) out->hum_max = b->hum_max;
+        }
+        out->samples += b->count;
+        out->buckets++;
+        temp_sum += b->temp_sum;
+        hum_sum += b->hum_sum;
+
+        // 버킷 중앙 시각이 속하는 열에 누적
+        double mid = (double)b->start + hdr.bucket_seconds / 2.0;
+        int col = (int)((mid - (double)from) * HISTORY_SPARK_WIDTH / span);
+        if (col < 0) col = 0;
+        if (col >= HISTORY_SPARK_WIDTH) col = HISTORY_SPARK_WIDTH - 1;
+        col_temp[col] += b->temp_sum;
+        col_hum[col] += b->hum_sum;
+        col_count[col] += b->count;
+    }
+    free(buf);
+
+    if (out->samples == 0) {
+        return -1;
+    }
+    out->temp_avg = (float)(temp_sum / out->samples);
+    out->hum_avg = (float)(hum_sum / out->samples);
+    for (int c = 0; c < HISTORY_SPARK_WIDTH; c++) {
+        if (col_count[c] > 0) {
+            out->temp_series[c] = (float)(col_temp[c] / col_count[c]);
+            out->hum_series[c] = (float)(col_hum[c] / col_count[c]);
+        }
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: history_sparkline
+ * 설명: 값 배열을 ▁▂▃▄▅▆▇█ 8단계 문자열로 변환 (NAN은 공백)
+ * ============================================================================ */
+void history_sparkline(const float *series, int n, char *buf, size_t buflen) {
+    static const char *ticks[8] = { "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+    float lo = 0, hi = 0;
+    int have = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (isnan(series[i])) continue;
+        if (!have || series[i] < lo) lo = series[i];
+        if (!have || series[i] > hi) hi = series[i];
+        have = 1;
+    }
+
+    size_t pos = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < n; i++) {
+        const char *s = " ";
+        if (!isnan(series[i])) {
+            int level = (hi - lo > 0.01f) ? (int)((series[i] - lo) / (hi - lo) * 7.0f + 0.5f) : 3;
+            s = ticks[level];
+        }
+        size_t len = strlen(s);
+        if (pos + len + 1 > buflen) break;
+        memcpy(buf + pos, s, len);
+        pos += len;
+        buf[pos] = '\0';
+    }
+}
+
+/* ============================================================================
+ * 함수: history_parse_duration
+ * 설명: 기간 문자열 파싱 (단위 없으면 분)
+ * ============================================================================ */
+long history_parse_duration(const char *s) {
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (end == s || v <= 0) {
+        return -1;
+    }
+    switch (*end) {
+        case '\0': case 'm': case 'M': return v * 60;
+        case 'h': case 'H': return v * 3600;
+        case 'd': case 'D': return v * 86400;
+        case 's': case 'S': return v;
+        default: return -1;
+    }
+}
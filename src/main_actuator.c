@@ -6,16 +6,24 @@
  * 기술 요소:
  *   - ANSI Escape Code를 사용한 컬러 터미널 UI
  *   - ASCII Art 애니메이션 (히터 불꽃, 팬 회전, LED 깜빡임)
- *   - Shared Memory: 제어 상태(히터/팬/LED) 읽기
+ *   - Shared Memory: 담당 구역의 제어 상태(히터/팬/LED) 읽기
+ *     (게시 세대의 변경 집합에 담당 구역이 있을 때만 비트셋에서 다시 읽음)
  *   - Semaphore: 동기화
+ *   - 최근 표본 링(seqlock): 세마포어 없이 읽어 추세/스파크라인 표시
  *   - 실시간 상태 표시 대시보드
  *
+ * 실행: ./bin/actuator [구역번호]   (기본: 0)
+ *
  * 작성자: Virtual SmartFarm Team
  * 작성일: 2025-12-02
  * ==============================================================================
  */
 
 #include "../include/common.h"
+#include "../include/control_state.h"
+#include "../include/shm_store.h"
+#include "../include/trace.h"
+#include "../include/zone_ring.h"
 
 /* ANSI Color Codes */
 #define ANSI_RESET   "\x1b[0m"
@@ -32,19 +40,32 @@
 #define ANSI_GRAY    "\x1b[38;5;240m"
 
 /* IPC 자원 */
-static int shm_id = -1;
+static ShmHandle shm;
 static int sem_id = -1;
 static SharedData *shared_data = NULL;
+static int proc_slot = -1;          // 프로세스 등록 테이블 슬롯
+
+/* 담당 구역 */
+static int zone_id = DEFAULT_ZONE_ID;
 
 /* 현재 상태 */
 static int heater_on = 0;
 static int fan_on = 0;
 static int led_on = 0;
 
+/* 제어 상태 게시 추적 (control_state.h) */
+static int ctrl_synced = 0;             // 게시 상태를 전부 읽은 적 있음
+static uint32_t ctrl_seen_gen = 0;      // 마지막으로 확인한 게시 세대
+static uint32_t ctrl_server_gen = 0;    // 그때의 서버 시작 횟수 (바뀌면 다시 읽음)
+static unsigned long ctrl_updates = 0;  // 담당 구역이 변경 집합에 들어 있던 횟수
+
 /* 센서 데이터 */
 static float current_temp = 0.0;
 static float current_humidity = 0.0;
 
+/* 추세 표시 (최근 표본 링) */
+#define SPARK_WIDTH 16
+
 /* 애니메이션 프레임 카운터 */
 static int frame = 0;
 
@@ -55,11 +76,49 @@ void cleanup_and_exit(int signo) {
     (void)signo;
     printf("\n[ACTUATOR] 종료 중...\n");
     if (shared_data != NULL) {
-        shmdt(shared_data);
+        proc_unregister(shared_data, sem_id, proc_slot);
+        shm_store_close(&shm);
     }
     exit(0);
 }
 
+/* ============================================================================
+ * 함수: format_trend
+ * 설명: 최근 표본 링에서 온도/습도 추세(분당 변화)와 온도 스파크라인 생성
+ *       (세마포어 없이 seqlock 스냅샷 - 서버 기록을 막지 않음)
+ * 반환: 스냅샷 표본 수 (-1=서버가 기록 도중 멈춤)
+ * ============================================================================ */
+static int format_trend(char *temp_rate, char *hum_rate, size_t rate_len, char *spark, size_t spark_len) {
+    static const char *bars[] = { "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+    RingSample s[ZONE_RING_SAMPLES];
+    int n = zone_ring_read(&shared_data->recent[zone_id], s, ZONE_RING_SAMPLES);
+    float dt, dh;
+    if (n >= 2 && zone_ring_trend(s, n, &dt, &dh) == 0) {
+        snprintf(temp_rate, rate_len, "%+5.1f", dt);
+        snprintf(hum_rate, rate_len, "%+5.1f", dh);
+    } else {
+        snprintf(temp_rate, rate_len, "  -  ");
+        snprintf(hum_rate, rate_len, "  -  ");
+    }
+
+    // 스파크라인: 마지막 SPARK_WIDTH개 온도, 부족한 칸은 공백
+    int first = n > SPARK_WIDTH ? n - SPARK_WIDTH : 0;
+    float lo = 0, hi = 0;
+    for (int i = first; i < n; i++) {
+        if (i == first || s[i].temperature < lo) lo = s[i].temperature;
+        if (i == first || s[i].temperature > hi) hi = s[i].temperature;
+    }
+    size_t off = 0;
+    for (int i = first; i < n && off < spark_len; i++) {
+        int level = hi > lo ? (int)((s[i].temperature - lo) / (hi - lo) * 7.0f + 0.5f) : 3;
+        off += snprintf(spark + off, spark_len - off, "%s", bars[level]);
+    }
+    for (int i = n > 0 ? n - first : 0; i < SPARK_WIDTH && off < spark_len; i++) {
+        off += snprintf(spark + off, spark_len - off, " ");
+    }
+    return n;
+}
+
 /* ============================================================================
  * 함수: display_dashboard
  * 설명: ASCII 애니메이션이 포함된 대시보드
@@ -96,6 +155,11 @@ void display_dashboard() {
            current_humidity, ANSI_RESET, hum_thresh,
            current_humidity > hum_thresh ? ANSI_RED "▲ 고습!" : ANSI_GREEN "정상   ",
            ANSI_RESET, "", ANSI_CYAN, ANSI_RESET);
+    char temp_rate[16], hum_rate[16], spark[SPARK_WIDTH * 4 + 1];
+    int recent = format_trend(temp_rate, hum_rate, sizeof(temp_rate), spark, sizeof(spark));
+    printf("%s║%s     📈 최근 %2d건  온도 %s°C/분  습도 %s%%/분  %s%s%s      %s║%s\n",
+           ANSI_CYAN, ANSI_RESET, recent < 0 ? 0 : recent, temp_rate, hum_rate,
+           ANSI_YELLOW, spark, ANSI_RESET, ANSI_CYAN, ANSI_RESET);
     printf("%s║%s                                                                          %s║%s\n", ANSI_CYAN, ANSI_RESET, ANSI_CYAN, ANSI_RESET);
     printf("%s╠══════════════════════════════════════════════════════════════════════════╣%s\n", ANSI_CYAN, ANSI_RESET);
     printf("%s║%s  ⚙️  %s장치 상태%s                                                            %s║%s\n",
@@ -241,7 +305,8 @@ void display_dashboard() {
 
     printf("%s║%s                                                                          %s║%s\n", ANSI_CYAN, ANSI_RESET, ANSI_CYAN, ANSI_RESET);
     printf("%s╚══════════════════════════════════════════════════════════════════════════╝%s\n", ANSI_CYAN, ANSI_RESET);
-    printf("\n  %sPID: %d | 0.5초마다 갱신 | Ctrl+C 종료%s\n", ANSI_DIM, getpid(), ANSI_RESET);
+    printf("\n  %sPID: %d | 구역 %d | 제어 세대 %u (변경 %lu회) | 0.5초마다 갱신 | Ctrl+C 종료%s\n",
+           ANSI_DIM, getpid(), zone_id, ctrl_seen_gen, ctrl_updates, ANSI_RESET);
     
     // 프레임 증가
     frame++;
@@ -249,47 +314,71 @@ void display_dashboard() {
 
 /* ============================================================================
  * 함수: read_control_state
+ * 설명: 마지막으로 본 세대 이후 변경 집합에 담당 구역이 있을 때만 제어 비트를 다시 읽음
+ *       (처음 연결, 서버 재시작, 변경 기록이 밀려난 경우는 게시 상태를 그대로 다시 읽음)
  * ============================================================================ */
 void read_control_state() {
     sem_lock(sem_id);
-    heater_on = shared_data->heater_on;
-    fan_on = shared_data->fan_on;
-    led_on = shared_data->led_on;
-    current_temp = shared_data->current_temp;
-    current_humidity = shared_data->current_humidity;
+    const ControlLog *cl = &shared_data->control;
+    int changed = ctrl_synced && shared_data->hdr.generation == ctrl_server_gen
+                  ? control_zone_changes(cl, ctrl_seen_gen, zone_id) : -1;
+    if (changed != 0) {
+        heater_on = control_published(cl, CTRL_HEATER, zone_id);
+        fan_on = control_published(cl, CTRL_FAN, zone_id);
+        led_on = control_published(cl, CTRL_LED, zone_id);
+    }
+    ctrl_seen_gen = cl->gen;
+    ctrl_server_gen = shared_data->hdr.generation;
+    ctrl_synced = 1;
+    current_temp = shared_data->zones.current_temp[zone_id];
+    current_humidity = shared_data->zones.current_humidity[zone_id];
     sem_unlock(sem_id);
+    if (changed > 0) {
+        ctrl_updates++;
+    }
 }
 
 /* ============================================================================
  * 메인 함수
  * ============================================================================ */
-int main() {
-    printf("[ACTUATOR] 프로세스 시작 (PID: %d)\n", getpid());
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        zone_id = atoi(argv[1]);
+        if (!zone_valid(zone_id)) {
+            fprintf(stderr, "[ACTUATOR] 구역 번호는 0~%d 범위여야 합니다\n", MAX_ZONES - 1);
+            exit(1);
+        }
+    }
+    printf("[ACTUATOR] 프로세스 시작 (PID: %d, 구역: %d)\n", getpid(), zone_id);
 
     signal(SIGINT, cleanup_and_exit);
     signal(SIGTERM, cleanup_and_exit);
 
     // 공유 메모리 연결
-    shm_id = shmget(SHM_KEY, sizeof(SharedData), 0666);
-    if (shm_id == -1) {
+    if (shm_store_open(&shm, 0) == -1) {
         perror("[ACTUATOR] 공유 메모리 연결 실패 (서버를 먼저 실행하세요)");
         exit(1);
     }
-    shared_data = (SharedData *)shmat(shm_id, NULL, 0);
-    if (shared_data == (void *)-1) {
-        perror("[ACTUATOR] 공유 메모리 attach 실패");
+    shared_data = shm.data;
+    if (!shared_header_valid(shared_data)) {
+        fprintf(stderr, "[ACTUATOR] 공유 메모리 형식이 다릅니다 (서버 초기화 전이거나 다른 빌드)\n");
         exit(1);
     }
-    printf("[ACTUATOR] 공유 메모리 연결 성공 (ID: %d)\n", shm_id);
+    printf("[ACTUATOR] 공유 메모리 연결 성공 (%s)\n",
+           shm.backend == SHM_BACKEND_POSIX ? shm.name : "System V");
 
     // 세마포어 연결
-    sem_id = semget(SEM_KEY, 1, 0666);
+    sem_id = semget(ipc_key(SEM_KEY), 1, 0666);
     if (sem_id == -1) {
         perror("[ACTUATOR] 세마포어 연결 실패 (서버를 먼저 실행하세요)");
         exit(1);
     }
     printf("[ACTUATOR] 세마포어 연결 성공 (ID: %d)\n", sem_id);
 
+    // 프로세스 등록 (모니터의 자원 현황 조회 및 서버의 생존 감시용)
+    proc_slot = proc_register(shared_data, sem_id, PROC_ROLE_ACTUATOR, zone_id, 500);
+    trace_init(proc_slot, PROC_ROLE_ACTUATOR, zone_id);
+
     sleep(1);  // 초기 메시지 보여주기
 
     // 메인 루프
@@ -304,10 +393,15 @@ int main() {
         }
 
         read_control_state();
+        uint64_t t_render = trace_begin();
         display_dashboard();
+        trace_end(TRACE_ACTUATOR_RENDER, zone_id, t_render);
+        proc_heartbeat(shared_data, proc_slot, 1);
 
-        usleep(500000);  // 0.5초마다 갱신 (애니메이션용)
+        shutdown_wait(shared_data, 500);  // 0.5초마다 갱신 (애니메이션용, 종료 알림 시 즉시 깨어남)
     }
 
+    proc_unregister(shared_data, sem_id, proc_slot);
+    shm_store_close(&shm);
     return 0;
 }
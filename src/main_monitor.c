@@ -4,10 +4,14 @@
  * 역할: [P4] 사용자 모니터링 및 설정 프로세스
  *
  * 기술 요소:
- *   - Shared Memory: 임계값 설정 읽기/쓰기, 제어 상태 읽기
+ *   - Shared Memory: 임계값 설정 읽기/쓰기, 구역별 제어 상태 읽기
  *   - Semaphore: Race Condition 방지를 위한 동기화
  *   - select(): 논블로킹 입력으로 종료 신호 감지
+ *     (서버가 종료 시 보내는 SIGUSR1이 select를 EINTR로 깨움 → 즉시 종료)
  *   - CLI 메뉴 인터페이스
+ *   - 이력 조회: 구역별 분/시간 인덱스에서 최근 구간 통계 + 스파크라인
+ *   - 자원 현황(top): 등록 테이블의 PID로 /proc 샘플링 (procstat.c)
+ *   - 생존 현황: 등록 테이블의 하트비트/루프 카운터를 잠금 없이 읽어 출력
  *
  * 작성자: Virtual SmartFarm Team
  * 작성일: 2025-12-02
@@ -15,12 +19,21 @@
  */
 
 #include "../include/common.h"
+#include "../include/control_state.h"
+#include "../include/history.h"
+#include "../include/shm_store.h"
+#include "../include/procstat.h"
+#include "../include/zone_hist.h"
+#include "../include/zone_rank.h"
+#include "../include/zone_ring.h"
 #include <sys/select.h>
 #include <sys/utsname.h>
+#include <sys/time.h>
 
-static int shm_id = -1;
+static ShmHandle shm;
 static int sem_id = -1;
 static SharedData *shared_data = NULL;
+static int proc_slot = -1;          // 프로세스 등록 테이블 슬롯
 
 /* ============================================================================
  * 함수: display_system_info
@@ -59,11 +72,21 @@ void cleanup_and_exit(int signo) {
     (void)signo;  // unused parameter 경고 방지
     printf("\n[MONITOR] 종료 중...\n");
     if (shared_data != NULL) {
-        shmdt(shared_data);
+        proc_unregister(shared_data, sem_id, proc_slot);
+        shm_store_close(&shm);
     }
     exit(0);
 }
 
+/* ============================================================================
+ * 함수: wake_handler
+ * 설명: SIGUSR1 핸들러 - 아무 일도 하지 않음
+ *       SA_RESTART 없이 등록하여 select()/read()가 EINTR로 반환되게 하는 용도
+ * ============================================================================ */
+static void wake_handler(int signo) {
+    (void)signo;
+}
+
 /* ============================================================================
  * 함수: check_system_running
  * 설명: 서버 종료 신호 확인
@@ -90,6 +113,10 @@ void display_menu() {
     printf("║  3. 현재 설정 및 상태 확인                     ║\n");
     printf("║  4. 시스템 정보 확인                           ║\n");
     printf("║  5. 종료                                       ║\n");
+    printf("║  6. 과거 이력 조회 (최근 N분/시간)             ║\n");
+    printf("║  7. 프로세스 자원 현황 (top)                   ║\n");
+    printf("║  8. 프로세스 생존 현황 (하트비트)              ║\n");
+    printf("║  9. 극값 구역 순위 (고온/저온/고습/건조)       ║\n");
     printf("╚════════════════════════════════════════════════╝\n");
     printf("선택: ");
     fflush(stdout);
@@ -97,30 +124,186 @@ void display_menu() {
 
 /* ============================================================================
  * 함수: display_status
- * 설명: 현재 설정값과 제어 상태 출력
+ * 설명: 현재 설정값과 구역별 환경/제어 상태 출력
+ *       온도/습도 옆 화살표는 최근 표본 링의 분당 추세 (↑ 상승, ↓ 하강, → 보합)
+ *       (데이터를 받은 적 있는 구역만, 최대 STATUS_MAX_ROWS개)
  * ============================================================================ */
+#define STATUS_MAX_ROWS 20
+#define TREND_FLAT_PER_MIN 0.1f     // 분당 변화가 이보다 작으면 보합(→)
+
+/* 최근 표본 링의 추세 화살표 (온도, 습도) - 표본이 부족하면 공백 */
+static void zone_trend_arrows(int zone, const char **temp_arrow, const char **hum_arrow) {
+    RingSample s[ZONE_RING_SAMPLES];
+    int n = zone_ring_read(&shared_data->recent[zone], s, ZONE_RING_SAMPLES);
+    float dt, dh;
+    *temp_arrow = *hum_arrow = " ";
+    if (n >= 2 && zone_ring_trend(s, n, &dt, &dh) == 0) {
+        *temp_arrow = dt > TREND_FLAT_PER_MIN ? "↑" : dt < -TREND_FLAT_PER_MIN ? "↓" : "→";
+        *hum_arrow = dh > TREND_FLAT_PER_MIN ? "↑" : dh < -TREND_FLAT_PER_MIN ? "↓" : "→";
+    }
+}
+
 void display_status() {
     sem_lock(sem_id);
     printf("\n");
     printf("┌─────────────────────────────────────────┐\n");
     printf("│          📊 현재 시스템 상태            │\n");
     printf("├─────────────────────────────────────────┤\n");
-    printf("│  [현재 환경]                            │\n");
-    printf("│    🌡️  온도: %6.1f°C                   │\n", shared_data->current_temp);
-    printf("│    💧 습도: %6.1f%%                    │\n", shared_data->current_humidity);
-    printf("├─────────────────────────────────────────┤\n");
     printf("│  [임계값 설정]                          │\n");
     printf("│    온도 임계값: %3d°C                   │\n", shared_data->temp_threshold);
     printf("│    습도 임계값: %3d%%                    │\n", shared_data->humidity_threshold);
+    const ZoneTable *zt = &shared_data->zones;
+    int active = 0;
+    for (int z = 0; z < shared_data->active_zones; z++) {
+        if (zt->last_update[z] != 0) active++;
+    }
+    printf("│    활성 구역:   %4d개                   │\n", active);
     printf("├─────────────────────────────────────────┤\n");
-    printf("│  [현재 제어 상태]                       │\n");
-    printf("│    🔥 히터: %s                         │\n", shared_data->heater_on ? "ON " : "OFF");
-    printf("│    💨 팬:   %s                         │\n", shared_data->fan_on ? "ON " : "OFF");
-    printf("│    💡 LED:  %s                         │\n", shared_data->led_on ? "ON " : "OFF");
+    printf("│  구역   온도(°C)  습도(%%)  히터 팬  LED │\n");
+
+    int shown = 0, hidden = 0;
+    for (int z = 0; z < shared_data->active_zones; z++) {
+        if (zt->last_update[z] == 0) {
+            continue;
+        }
+        if (shown >= STATUS_MAX_ROWS) {
+            hidden++;
+            continue;
+        }
+        const char *temp_arrow, *hum_arrow;
+        zone_trend_arrows(z, &temp_arrow, &hum_arrow);
+        printf("│  %4d  %7.1f%s %7.1f%s  %-4s %-4s %-3s│\n", z,
+               zt->current_temp[z], temp_arrow, zt->current_humidity[z], hum_arrow,
+               control_get(zt, CTRL_HEATER, z) ? "ON" : "OFF",
+               control_get(zt, CTRL_FAN, z) ? "ON" : "OFF",
+               control_get(zt, CTRL_LED, z) ? "ON" : "OFF");
+        shown++;
+    }
+    if (shown == 0) {
+        printf("│  (아직 수신된 센서 데이터 없음)         │\n");
+    }
+    if (hidden > 0) {
+        printf("│  ... 외 %d개 구역                        │\n", hidden);
+    }
     printf("└─────────────────────────────────────────┘\n");
     sem_unlock(sem_id);
 }
 
+/* ============================================================================
+ * 함수: display_history
+ * 설명: 구역과 기간을 입력받아 최소/최대/평균과 스파크라인 출력
+ *       기간 전체가 공유 메모리 압축 이력에 남아 있으면 그 표본으로 (디스크 미사용),
+ *       아니면 로그 프로세스가 기록한 history/ 인덱스 사용
+ * ============================================================================ */
+void display_history() {
+    int zone;
+    char period[32];
+
+    printf("구역 번호 (기본 %d): ", DEFAULT_ZONE_ID);
+    if (scanf("%d", &zone) != 1 || zone < 0) {
+        printf("❌ 유효하지 않은 구역입니다.\n");
+        while (getchar() != '\n');
+        return;
+    }
+    printf("조회 기간 (예: 30m, 6h, 7d): ");
+    if (scanf("%31s", period) != 1) {
+        return;
+    }
+    long seconds = history_parse_duration(period);
+    if (seconds <= 0) {
+        printf("❌ 유효하지 않은 기간입니다. (예: 30m, 6h, 7d)\n");
+        return;
+    }
+
+    struct timeval t0, t1;
+    HistoryQueryResult r;
+    time_t now = time(NULL);
+
+    gettimeofday(&t0, NULL);
+    int in_memory = 0, rc = -1;
+    if (zone < MAX_ZONES) {
+        uint32_t oldest = zone_hist_oldest(&shared_data->hist[zone]);
+        if (oldest != 0 && (time_t)oldest <= now - seconds) {
+            rc = zone_hist_query(&shared_data->hist[zone], zone, now - seconds, now, &r);
+            in_memory = rc == 0;
+        }
+    }
+    if (!in_memory) {
+        rc = history_query(HISTORY_DIR, zone, now - seconds, now, &r);
+    }
+    gettimeofday(&t1, NULL);
+    double elapsed_ms = (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_usec - t0.tv_usec) / 1000.0;
+
+    if (rc != 0) {
+        printf("❌ 구역 %d의 최근 %s 이력이 없습니다.\n", zone, period);
+        return;
+    }
+
+    char temp_spark[HISTORY_SPARK_WIDTH * 4 + 1];
+    char hum_spark[HISTORY_SPARK_WIDTH * 4 + 1];
+    history_sparkline(r.temp_series, HISTORY_SPARK_WIDTH, temp_spark, sizeof(temp_spark));
+    history_sparkline(r.hum_series, HISTORY_SPARK_WIDTH, hum_spark, sizeof(hum_spark));
+
+    printf("\n");
+    printf("┌──────────────────────────────────────────────────────────────┐\n");
+    printf("│  📈 구역 %d - 최근 %s 이력\n", zone, period);
+    printf("├──────────────────────────────────────────────────────────────┤\n");
+    printf("│  🌡️  온도  최소 %6.1f  최대 %6.1f  평균 %6.1f °C\n",
+           r.temp_min, r.temp_max, r.temp_avg);
+    printf("│      %s\n", temp_spark);
+    printf("│  💧 습도  최소 %6.1f  최대 %6.1f  평균 %6.1f %%\n",
+           r.hum_min, r.hum_max, r.hum_avg);
+    printf("│      %s\n", hum_spark);
+    printf("├──────────────────────────────────────────────────────────────┤\n");
+    if (in_memory) {
+        printf("│  샘플 %u개 / 메모리 압축 블록 %u개 / 조회 %.2fms\n",
+               r.samples, r.buckets, elapsed_ms);
+    } else {
+        printf("│  샘플 %u개 / %s 버킷 %u개 / 조회 %.2fms\n",
+               r.samples, r.level == HIST_LEVEL_MINUTE ? "분" : "시간",
+               r.buckets, elapsed_ms);
+    }
+    printf("└──────────────────────────────────────────────────────────────┘\n");
+}
+
+/* ============================================================================
+ * 함수: display_ranking
+ * 설명: 서버가 게시한 극값 순위(샤드별 목록 병합)를 순위 종류별 열로 출력
+ *       구역 테이블을 훑지 않고 공유 메모리의 순위 목록만 잠금 없이 읽음
+ * ============================================================================ */
+#define RANK_ROWS 10
+
+void display_ranking() {
+    static const char *units[RANK_KINDS] = { "°C", "°C", "%", "%" };
+    RankEntry top[RANK_KINDS][ZONE_RANK_K];
+    int n[RANK_KINDS], rows = 0;
+    for (int k = 0; k < RANK_KINDS; k++) {
+        n[k] = zone_rank_read(shared_data, k, top[k], RANK_ROWS < ZONE_RANK_K ? RANK_ROWS : ZONE_RANK_K);
+        if (n[k] > rows) rows = n[k];
+    }
+
+    printf("\n");
+    printf("┌──────────────────────────────────────────────────────────────┐\n");
+    printf("│  📊 극값 구역 순위 (상위 %d개, 구역 번호 / 값)\n", RANK_ROWS);
+    printf("├──────────────────────────────────────────────────────────────┤\n");
+    printf("│  순위   🔥 고온          ❄️  저온         💧 고습          🌵 건조\n");
+    for (int i = 0; i < rows; i++) {
+        printf("│  %4d", i + 1);
+        for (int k = 0; k < RANK_KINDS; k++) {
+            if (i < n[k]) {
+                printf("   %5d %5.1f%-2s", top[k][i].zone, top[k][i].value, units[k]);
+            } else {
+                printf("   %13s", "");
+            }
+        }
+        printf("\n");
+    }
+    if (rows == 0) {
+        printf("│  (아직 게시된 순위 없음)\n");
+    }
+    printf("└──────────────────────────────────────────────────────────────┘\n");
+}
+
 /* ============================================================================
  * 함수: input_available
  * 설명: select()를 사용하여 입력이 있는지 확인 (타임아웃: 1초)
@@ -139,6 +322,134 @@ int input_available() {
     return select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) > 0;
 }
 
+/* ============================================================================
+ * 함수: display_top
+ * 설명: 등록 테이블의 모든 프로세스에 대해 1초 간격으로 /proc을 샘플링하여
+ *       CPU%, RSS, 컨텍스트 스위치/초, 시스템 콜/초 출력 (Enter 입력 시 종료)
+ *       - 시스템 콜은 /proc/<pid>/io 의 읽기/쓰기 계열(syscr+syscw)만 집계됨
+ * ============================================================================ */
+void display_top() {
+    ProcSlot slots[MAX_PROCS];
+    ProcSample prev[MAX_PROCS], cur[MAX_PROCS];
+    int have_prev[MAX_PROCS] = {0};
+    struct timeval t_prev, t_cur;
+
+    gettimeofday(&t_prev, NULL);
+    while (getchar() != '\n');   // 메뉴 선택 줄의 나머지 비우기
+
+    while (check_system_running()) {
+        proc_heartbeat(shared_data, proc_slot, 0);
+        sem_lock(sem_id);
+        memcpy(slots, shared_data->procs, sizeof(slots));
+        sem_unlock(sem_id);
+
+        gettimeofday(&t_cur, NULL);
+        double elapsed = (t_cur.tv_sec - t_prev.tv_sec) +
+                         (t_cur.tv_usec - t_prev.tv_usec) / 1e6;
+        t_prev = t_cur;
+
+        printf("\033[2J\033[H");
+        printf("📊 SmartFarm 프로세스 자원 현황 (1초 갱신, Enter: 메뉴로)\n\n");
+        printf("%-4s %-9s %7s %-12s %2s %7s %9s %9s %10s %8s\n",
+               "SLOT", "ROLE", "PID", "COMM", "S", "CPU%", "RSS(kB)",
+               "CTXSW/s", "SYSCALL/s", "THREADS");
+        printf("--------------------------------------------------------------------------------------\n");
+
+        for (int i = 0; i < MAX_PROCS; i++) {
+            if (slots[i].pid == 0 || procstat_sample(slots[i].pid, &cur[i]) == -1) {
+                have_prev[i] = 0;
+                continue;
+            }
+            if (have_prev[i] && prev[i].pid == cur[i].pid) {
+                ProcRate rate;
+                procstat_rate(&prev[i], &cur[i], elapsed, &rate);
+                char syscalls[16];
+                if (cur[i].io_ok) snprintf(syscalls, sizeof(syscalls), "%.0f", rate.syscall_per_sec);
+                else snprintf(syscalls, sizeof(syscalls), "n/a");
+                printf("%-4d %-9s %7d %-12s %2c %7.1f %9ld %9.0f %10s %8ld\n",
+                       i, proc_role_name(slots[i].role), (int)cur[i].pid, cur[i].comm,
+                       cur[i].state, rate.cpu_percent, cur[i].rss_kb,
+                       rate.ctxt_per_sec, syscalls, cur[i].threads);
+            } else {
+                printf("%-4d %-9s %7d %-12s %2c %7s %9ld %9s %10s %8ld\n",
+                       i, proc_role_name(slots[i].role), (int)cur[i].pid, cur[i].comm,
+                       cur[i].state, "...", cur[i].rss_kb, "...", "...", cur[i].threads);
+            }
+            prev[i] = cur[i];
+            have_prev[i] = 1;
+        }
+
+        // 1초 대기 중 Enter 입력 시 종료
+        if (input_available()) {
+            while (getchar() != '\n');
+            break;
+        }
+    }
+}
+
+/* ============================================================================
+ * 함수: display_liveness
+ * 설명: 생존 테이블을 1초 간격으로 출력 (Enter 입력 시 종료)
+ *       - 각 슬롯은 소유 프로세스만 기록하므로 잠금 없이 읽음
+ *       - 상태: OK / STALE(서버가 응답 없음으로 표시) / -(주기 없음, 감시 제외)
+ * ============================================================================ */
+void display_liveness() {
+    uint64_t prev_loops[MAX_PROCS] = {0};
+    pid_t prev_pid[MAX_PROCS] = {0};
+    uint64_t t_prev = monotonic_ns();
+
+    while (getchar() != '\n');   // 메뉴 선택 줄의 나머지 비우기
+
+    while (check_system_running()) {
+        proc_heartbeat(shared_data, proc_slot, 0);
+        uint64_t now = monotonic_ns();
+        double elapsed = (now - t_prev) / 1e9;
+        t_prev = now;
+
+        printf("\033[2J\033[H");
+        printf("💓 SmartFarm 프로세스 생존 현황 (1초 갱신, Enter: 메뉴로)\n\n");
+        printf("%-4s %-9s %7s %5s %7s %9s %12s %8s %10s %-6s\n",
+               "SLOT", "ROLE", "PID", "ZONE", "PERIOD", "AGE(ms)",
+               "LOOPS", "LOOPS/s", "WORK", "STATE");
+        printf("------------------------------------------------------------------------------------\n");
+
+        for (int i = 0; i < MAX_PROCS; i++) {
+            const ProcSlot *s = &shared_data->procs[i];
+            pid_t pid = __atomic_load_n(&s->pid, __ATOMIC_ACQUIRE);
+            if (pid == 0) {
+                prev_pid[i] = 0;
+                continue;
+            }
+            uint64_t loops = __atomic_load_n(&s->loops, __ATOMIC_RELAXED);
+            char zone[12], period[16], rate[16];
+            if (s->zone >= 0) snprintf(zone, sizeof(zone), "%d", s->zone);
+            else snprintf(zone, sizeof(zone), "-");
+            if (s->period_ms != 0) snprintf(period, sizeof(period), "%ums", s->period_ms);
+            else snprintf(period, sizeof(period), "-");
+            if (prev_pid[i] == pid && elapsed > 0) {
+                snprintf(rate, sizeof(rate), "%.1f", (loops - prev_loops[i]) / elapsed);
+            } else {
+                snprintf(rate, sizeof(rate), "...");
+            }
+            const char *state = s->period_ms == 0 ? "-" :
+                                __atomic_load_n(&s->stale, __ATOMIC_RELAXED) ? "STALE" : "OK";
+            printf("%-4d %-9s %7d %5s %7s %9llu %12llu %8s %10llu %-6s\n",
+                   i, proc_role_name(s->role), (int)pid, zone, period,
+                   (unsigned long long)proc_heartbeat_age_ms(s, now),
+                   (unsigned long long)loops, rate,
+                   (unsigned long long)__atomic_load_n(&s->work, __ATOMIC_RELAXED), state);
+            prev_pid[i] = pid;
+            prev_loops[i] = loops;
+        }
+
+        // 1초 대기 중 Enter 입력 시 종료
+        if (input_available()) {
+            while (getchar() != '\n');
+            break;
+        }
+    }
+}
+
 /* ============================================================================
  * 메인 함수
  * ============================================================================ */
@@ -151,32 +462,40 @@ int main() {
     // 시그널 핸들러 등록
     signal(SIGINT, cleanup_and_exit);
     signal(SIGTERM, cleanup_and_exit);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = wake_handler;   // sa_flags=0: SA_RESTART 없음
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
 
     // ========================================================================
     // IPC 자원 연결
     // ========================================================================
 
     // 공유 메모리 연결
-    shm_id = shmget(SHM_KEY, sizeof(SharedData), 0666);
-    if (shm_id == -1) {
+    if (shm_store_open(&shm, 0) == -1) {
         perror("[MONITOR] 공유 메모리 연결 실패 (서버를 먼저 실행하세요)");
         exit(1);
     }
-    shared_data = (SharedData *)shmat(shm_id, NULL, 0);
-    if (shared_data == (void *)-1) {
-        perror("[MONITOR] 공유 메모리 attach 실패");
+    shared_data = shm.data;
+    if (!shared_header_valid(shared_data)) {
+        fprintf(stderr, "[MONITOR] 공유 메모리 형식이 다릅니다 (서버 초기화 전이거나 다른 빌드)\n");
         exit(1);
     }
-    printf("[MONITOR] 공유 메모리 연결 성공 (ID: %d)\n", shm_id);
+    printf("[MONITOR] 공유 메모리 연결 성공 (%s)\n",
+           shm.backend == SHM_BACKEND_POSIX ? shm.name : "System V");
 
     // 세마포어 연결
-    sem_id = semget(SEM_KEY, 1, 0666);
+    sem_id = semget(ipc_key(SEM_KEY), 1, 0666);
     if (sem_id == -1) {
         perror("[MONITOR] 세마포어 연결 실패 (서버를 먼저 실행하세요)");
         exit(1);
     }
     printf("[MONITOR] 세마포어 연결 성공 (ID: %d)\n", sem_id);
 
+    // 프로세스 등록 (자원 현황 조회 대상에 모니터 자신도 포함)
+    proc_slot = proc_register(shared_data, sem_id, PROC_ROLE_MONITOR, -1, 0);
+
     // ========================================================================
     // 메인 루프: CLI 메뉴 (select 기반 논블로킹)
     // ========================================================================
@@ -189,6 +508,7 @@ int main() {
             printf("\n[MONITOR] 서버 종료 신호 수신. 프로세스 종료.\n");
             break;
         }
+        proc_heartbeat(shared_data, proc_slot, 0);
 
         // 메뉴 표시 (한 번만)
         if (!menu_displayed) {
@@ -249,8 +569,20 @@ int main() {
             case 5:
                 cleanup_and_exit(0);
                 break;
+            case 6:
+                display_history();
+                break;
+            case 7:
+                display_top();
+                break;
+            case 8:
+                display_liveness();
+                break;
+            case 9:
+                display_ranking();
+                break;
             default:
-                printf("❌ 잘못된 선택입니다. (1~5)\n");
+                printf("❌ 잘못된 선택입니다. (1~9)\n");
         }
     }
 
@@ -8,7 +8,14 @@
  *   - 온도: 히터 상태에 따라 동적으로 상승/하강
  *   - 습도: 팬 상태에 따라 자연스럽게 변화
  *   - Message Queue: 센서 데이터를 서버로 전송
- *   - Shared Memory: 제어 상태(히터/팬) 읽기
+ *     (transport.c - SMARTFARM_TRANSPORT 로 sysv/mq/shmring/unix 선택)
+ *   - Shared Memory: 담당 구역의 제어 상태(히터/팬) 읽기
+ *   - 긴급 경로: 임계값 크게 이탈/센서 이상 값은 긴급 표시 후 긴급 채널로 전송
+ *   - 등록 색인: 센서 ID로 실행하면 공유 메모리 색인에서 구역 슬롯을 배정받아 사용
+ *
+ * 실행: ./bin/sensor [구역번호]   (기본: 0)
+ *       ./bin/sensor -i <센서ID>  (등록 후 배정된 구역 슬롯으로 실행, 이미 등록된 ID면 같은 슬롯)
+ *       ./bin/sensor -r <센서ID>  (등록 해제 후 종료 - 슬롯은 다음 등록 센서가 재사용)
  *
  * 물리 모델:
  *   - 히터 ON: 온도가 0.2도/초 상승
@@ -25,6 +32,11 @@
  */
 
 #include "../include/common.h"
+#include "../include/control_state.h"
+#include "../include/sensor_index.h"
+#include "../include/shm_store.h"
+#include "../include/trace.h"
+#include "../include/transport.h"
 
 /* ============================================================================
  * 전역 변수 - 가상 물리 상태
@@ -33,12 +45,20 @@ static float current_temp = 25.0;      // 현재 온도 (초기값 25도)
 static float current_humidity = 50.0;  // 현재 습도 (초기값 50%)
 static int heater_state = 0;           // 히터 상태 (0=OFF, 1=ON)
 static int fan_state = 0;              // 팬 상태 (0=OFF, 1=ON)
+static int zone_id = DEFAULT_ZONE_ID;  // 담당 구역 번호
+static uint32_t sensor_id = 0;         // 등록 색인의 센서 ID (0=구역 번호 고정)
 
 /* IPC 자원 */
-static int msg_queue_id = -1;          // 메시지 큐 ID (데이터 전송용)
-static int shm_id = -1;                // 공유 메모리 ID
+static Transport *transport = NULL;    // 데이터 전송 채널
+static int shard = 1;                  // 담당 서버 샤드 (라우팅 테이블에서 조회)
+static Transport *urgent = NULL;       // 긴급 채널
+static int urgent_shard = 0;           // urgent가 연결된 샤드 (0=미연결)
+static int temp_threshold = 28;        // 공유 메모리의 임계값 (긴급 판단용)
+static int humidity_threshold = 70;
+static ShmHandle shm;                  // 공유 메모리 핸들
 static int sem_id = -1;                // 세마포어 ID
 static SharedData *shared_data = NULL; // 공유 메모리 포인터
+static int proc_slot = -1;          // 프로세스 등록 테이블 슬롯
 
 /* ============================================================================
  * 함수: cleanup_and_exit
@@ -48,7 +68,8 @@ void cleanup_and_exit(int signo) {
     (void)signo;  // unused parameter 경고 방지
     printf("\n[SENSOR] 종료 신호 수신. 프로세스 종료 중...\n");
     if (shared_data != NULL) {
-        shmdt(shared_data);
+        proc_unregister(shared_data, sem_id, proc_slot);
+        shm_store_close(&shm);
     }
     exit(0);
 }
@@ -116,8 +137,10 @@ void read_control_state() {
     sem_lock(sem_id);
     int prev_heater = heater_state;
     int prev_fan = fan_state;
-    heater_state = shared_data->heater_on;
-    fan_state = shared_data->fan_on;
+    heater_state = control_get(&shared_data->zones, CTRL_HEATER, zone_id);
+    fan_state = control_get(&shared_data->zones, CTRL_FAN, zone_id);
+    temp_threshold = shared_data->temp_threshold;
+    humidity_threshold = shared_data->humidity_threshold;
     sem_unlock(sem_id);
 
     // 상태 변경 시에만 출력
@@ -128,44 +151,134 @@ void read_control_state() {
     }
 }
 
+/* ============================================================================
+ * 함수: open_route
+ * 설명: 라우팅 테이블에서 이 구역의 샤드를 찾아 그 샤드의 채널에 연결
+ *       (System V는 큐 하나를 공유하므로 메시지 타입만 달라짐)
+ * 반환: 채널 (실패 시 NULL), 성공하면 shard 갱신
+ * ============================================================================ */
+static Transport *open_route() {
+    TransportKind kind = transport_kind_from_env();
+    int s = shard_for_zone(shared_data, zone_id);
+    Transport *t = transport_open(kind, shard_channel_key(s, kind == TRANSPORT_SYSV), 0);
+    if (t != NULL) {
+        shard = s;
+    }
+    return t;
+}
+
+/* ============================================================================
+ * 함수: urgent_route
+ * 설명: 담당 샤드의 긴급 채널 (처음 쓸 때 또는 샤드가 바뀌었을 때 연결)
+ *       긴급 채널이 없는 서버(이전 빌드)면 일반 채널로 대신 보냄
+ * 반환: 긴급 메시지를 보낼 채널
+ * ============================================================================ */
+static Transport *urgent_route() {
+    TransportKind kind = transport_kind_from_env();
+    if (urgent == NULL || urgent_shard != shard) {
+        transport_close(urgent);
+        urgent = transport_open(kind, shard_urgent_key(shard, kind == TRANSPORT_SYSV), 0);
+        urgent_shard = (urgent != NULL) ? shard : 0;
+    }
+    return urgent != NULL ? urgent : transport;
+}
+
 /* ============================================================================
  * 함수: send_sensor_data
  * 설명: 센서 데이터를 메시지 큐를 통해 서버로 전송
  * ============================================================================ */
 void send_sensor_data() {
     SensorDataMsg sensor_msg;
+    uint64_t t_send = trace_begin();
+
+    // 샤드 구성이 바뀌었으면 (서버 샤드 재시작 등) 새 담당 샤드로 전환
+    if (shard_for_zone(shared_data, zone_id) != shard) {
+        Transport *t = open_route();
+        if (t != NULL) {
+            transport_close(transport);
+            transport = t;
+            printf("[SENSOR] 구역 %d 담당 샤드 변경 → %d번\n", zone_id, shard);
+        }
+    }
 
     // 메시지 구조체 초기화
-    sensor_msg.msg_type = MSG_TYPE_SENSOR_DATA;
+    sensor_msg.zone_id = zone_id;
+    sensor_msg.sensor_id = sensor_id;
     sensor_msg.temperature = current_temp;
     sensor_msg.humidity = current_humidity;
+    sensor_msg.flags = sensor_urgent_flags(current_temp, current_humidity,
+                                           temp_threshold, humidity_threshold);
+    sensor_msg.msg_type = sensor_msg.flags ? SHARD_URGENT_MSG_TYPE(shard) : SHARD_MSG_TYPE(shard);
     sensor_msg.timestamp = time(NULL);
+    sensor_msg.sent_ns = monotonic_ns();
 
-    // msgsnd: 메시지 큐에 센서 데이터 전송
-    if (msgsnd(msg_queue_id, &sensor_msg,
-               sizeof(SensorDataMsg) - sizeof(long), 0) == -1) {
+    // 전송 계층을 통해 센서 데이터 전송 (긴급이면 긴급 채널)
+    // 실패 시 채널을 다시 열고 한 번 재시도 (서버 웜 재시작으로 소켓이 새로 bind된 경우)
+    int rc = transport_send(sensor_msg.flags ? urgent_route() : transport,
+                            &sensor_msg, sizeof(SensorDataMsg));
+    if (rc == -1) {
+        Transport *t = open_route();
+        if (t != NULL) {
+            transport_close(transport);
+            transport = t;
+            transport_close(urgent);
+            urgent = NULL;
+            sensor_msg.msg_type = sensor_msg.flags ? SHARD_URGENT_MSG_TYPE(shard)
+                                                   : SHARD_MSG_TYPE(shard);
+            rc = transport_send(sensor_msg.flags ? urgent_route() : transport,
+                                &sensor_msg, sizeof(SensorDataMsg));
+        }
+    }
+    trace_end(TRACE_SENSOR_SEND, zone_id, t_send);
+    if (rc == -1) {
         perror("[SENSOR] 데이터 전송 실패");
     } else {
-        printf("[SENSOR] 데이터 전송 - 온도: %.2f°C, 습도: %.2f%%\n",
-               current_temp, current_humidity);
+        printf("[SENSOR] 구역 %d 데이터 전송%s - 온도: %.2f°C, 습도: %.2f%%\n",
+               zone_id, sensor_msg.flags ? " [긴급]" : "", current_temp, current_humidity);
     }
 }
 
 /* ============================================================================
  * 메인 함수
  * ============================================================================ */
-int main() {
+int main(int argc, char *argv[]) {
+    int opt, leave = 0;
+    while ((opt = getopt(argc, argv, "i:r:")) != -1) {
+        switch (opt) {
+            case 'r': leave = 1;    /* fall through */
+            case 'i': sensor_id = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "사용법: %s [구역번호] | -i <센서ID> | -r <센서ID>\n", argv[0]);
+                exit(1);
+        }
+    }
+    if (optind < argc && sensor_id != 0) {
+        fprintf(stderr, "사용법: %s [구역번호] | -i <센서ID> | -r <센서ID>\n", argv[0]);
+        exit(1);
+    }
+    if (optind < argc) {
+        zone_id = atoi(argv[optind]);
+        if (!zone_valid(zone_id)) {
+            fprintf(stderr, "[SENSOR] 구역 번호는 0~%d 범위여야 합니다\n", MAX_ZONES - 1);
+            exit(1);
+        }
+    } else if (sensor_id == 0 && argc > 1) {
+        fprintf(stderr, "[SENSOR] 센서 ID는 1~%u 범위여야 합니다\n", UINT32_MAX);
+        exit(1);
+    }
+
     printf("==================================================\n");
     printf("  가상 스마트팜 센서 프로세스 [P1] 시작\n");
     printf("  - 가상 물리 엔진 탑재\n");
     printf("  - Message Queue: 데이터 전송\n");
     printf("  - Shared Memory: 제어 상태 읽기\n");
     printf("==================================================\n");
-    printf("  PID: %d\n\n", getpid());
+    printf("  PID: %d, 구역: %d\n\n", getpid(), zone_id);
 
     // 시그널 핸들러 등록 (Ctrl+C 처리)
     signal(SIGINT, cleanup_and_exit);
     signal(SIGTERM, cleanup_and_exit);
+    signal(SIGPIPE, SIG_IGN);       // 서버 재시작 중 도어벨 FIFO/소켓 쓰기 실패는 errno로 처리
 
     // 난수 생성기 초기화 (미세 노이즈용)
     srand(time(NULL));
@@ -174,34 +287,60 @@ int main() {
     // IPC 자원 연결
     // ========================================================================
 
-    // 메시지 큐 연결 (센서 데이터 전송용)
-    msg_queue_id = msgget(MSG_KEY_DATA, 0666);
-    if (msg_queue_id == -1) {
-        perror("[SENSOR] 메시지 큐 연결 실패 (서버를 먼저 실행하세요)");
-        exit(1);
-    }
-    printf("[SENSOR] 메시지 큐 연결 성공 (ID: %d)\n", msg_queue_id);
-
     // 공유 메모리 연결
-    shm_id = shmget(SHM_KEY, sizeof(SharedData), 0666);
-    if (shm_id == -1) {
+    if (shm_store_open(&shm, 0) == -1) {
         perror("[SENSOR] 공유 메모리 연결 실패 (서버를 먼저 실행하세요)");
         exit(1);
     }
-    shared_data = (SharedData *)shmat(shm_id, NULL, 0);
-    if (shared_data == (void *)-1) {
-        perror("[SENSOR] 공유 메모리 attach 실패");
+    shared_data = shm.data;
+    if (!shared_header_valid(shared_data)) {
+        fprintf(stderr, "[SENSOR] 공유 메모리 형식이 다릅니다 (서버 초기화 전이거나 다른 빌드)\n");
         exit(1);
     }
-    printf("[SENSOR] 공유 메모리 연결 성공 (ID: %d)\n", shm_id);
+    printf("[SENSOR] 공유 메모리 연결 성공 (%s)\n",
+           shm.backend == SHM_BACKEND_POSIX ? shm.name : "System V");
 
     // 세마포어 연결
-    sem_id = semget(SEM_KEY, 1, 0666);
+    sem_id = semget(ipc_key(SEM_KEY), 1, 0666);
     if (sem_id == -1) {
         perror("[SENSOR] 세마포어 연결 실패 (서버를 먼저 실행하세요)");
         exit(1);
     }
-    printf("[SENSOR] 세마포어 연결 성공 (ID: %d)\n\n", sem_id);
+    printf("[SENSOR] 세마포어 연결 성공 (ID: %d)\n", sem_id);
+
+    // 센서 ID 등록/해제 (등록 색인이 구역 슬롯 배정)
+    if (leave) {
+        int slot = sensor_deregister(shared_data, sem_id, sensor_id);
+        if (slot == -1) {
+            perror("[SENSOR] 센서 등록 해제 실패");
+            exit(1);
+        }
+        printf("[SENSOR] 센서 %u 등록 해제 (구역 슬롯 %d 반납)\n", sensor_id, slot);
+        shm_store_close(&shm);
+        exit(0);
+    }
+    if (sensor_id != 0) {
+        int slot = sensor_register(shared_data, sem_id, sensor_id);
+        if (slot == -1) {
+            perror("[SENSOR] 센서 등록 실패");
+            exit(1);
+        }
+        zone_id = slot;
+        printf("[SENSOR] 센서 %u 등록 → 구역 슬롯 %d\n", sensor_id, slot);
+    }
+
+    // 메시지 채널 연결 (센서 데이터 전송용, 라우팅 테이블의 담당 샤드)
+    transport = open_route();
+    if (transport == NULL) {
+        perror("[SENSOR] 메시지 큐 연결 실패 (서버를 먼저 실행하세요)");
+        exit(1);
+    }
+    printf("[SENSOR] 메시지 큐 연결 성공 (전송 방식: %s, 샤드 %d)\n\n",
+           transport_kind_name(transport_kind_from_env()), shard);
+
+    // 프로세스 등록 (모니터의 자원 현황 조회 및 서버의 생존 감시용)
+    proc_slot = proc_register(shared_data, sem_id, PROC_ROLE_SENSOR, zone_id, 500);
+    trace_init(proc_slot, PROC_ROLE_SENSOR, zone_id);
 
     // ========================================================================
     // 메인 루프: 0.5초마다 물리 시뮬레이션 및 1초마다 데이터 전송
@@ -224,13 +363,17 @@ int main() {
         update_physics();
 
         // 1초마다 센서 데이터 전송 (0.5초 * 2회)
-        if (loop_count % 2 == 0) {
+        int sent = (loop_count % 2 == 0);
+        if (sent) {
             send_sensor_data();
         }
+        proc_heartbeat(shared_data, proc_slot, sent);
 
         loop_count++;
-        usleep(500000);  // 0.5초 대기 (500,000 마이크로초)
+        shutdown_wait(shared_data, 500);  // 0.5초 대기 (종료 알림 시 즉시 깨어남)
     }
 
+    proc_unregister(shared_data, sem_id, proc_slot);
+    shm_store_close(&shm);
     return 0;
 }
@@ -5,20 +5,36 @@
  *
  * 기술 요소:
  *   - Message Queue: 센서 데이터 수신
- *   - Shared Memory: 설정값(임계값) 읽기, 제어 상태 쓰기
+ *     (transport.c - SMARTFARM_TRANSPORT 로 sysv/mq/shmring/unix 선택)
+ *   - Shared Memory: 설정값(임계값) 읽기, 구역별 제어 상태 쓰기
+ *     (shm_store.c - System V 또는 POSIX shm + mmap, 대형 페이지 선택)
  *   - Semaphore: 공유 메모리 동기화
- *   - Signal Handler: 안전한 종료 및 IPC 자원 정리
+ *   - epoll: 단일 스레드 이벤트 루프 (아래 fd를 한 곳에서 대기)
+ *     · 전송 계층 fd (mq/unix/shmring - 메시지 도착 시에만 깨어남)
+ *     · timerfd: 경고 검사 주기, 하트비트 (감시할 프로세스가 없으면 1초로 늦춤),
+ *       poll 불가능한 sysv 큐의 수신 주기 (SMARTFARM_TRANSPORT=sysv를 고른 경우만)
+ *     · signalfd: SIGINT/SIGTERM을 일반 이벤트로 받아 루프 밖에서 정리
+ *     · 제어 소켓: Unix 스트림 소켓, 한 줄 텍스트 명령 (status/set/shutdown/detach)
+ *   - 웜 재시작: 유효한 기존 공유 메모리(헤더 magic/version/size)를 초기화하지 않고
+ *     임계값·구역 상태를 그대로 이어받음 (센서/액추에이터는 계속 실행)
+ *     · detach 명령 또는 SIGQUIT(Ctrl+\): IPC 자원을 남긴 채 서버만 종료
+ *     · ./bin/server --cold : 기존 상태를 버리고 초기값으로 시작
+ *   - 대기 서버 (--standby): 공유 메모리를 읽기 전용으로 연결해 주 서버의 세대와
+ *     하트비트를 감시하다가, 주 서버가 죽거나(pidfd) 하트비트가 멈추면 리더 잠금
+ *     (flock)을 얻고 웜 재시작 경로로 수신/제어 역할을 인계
+ *   - 체크포인트: 주기적으로 SharedData를 mmap 파일(state/)에 이중 버퍼로 저장,
+ *     공유 메모리가 없는 상태(재부팅 등)에서 시작하면 마지막 스냅샷으로 복원
  *   - fork(): 로그 기록 전용 자식 프로세스 생성
  *   - pipe(): 부모-자식 간 로그 데이터 전송
- *   - pthread: 센서 데이터 처리 스레드
+ *   - 이력 인덱스: 로그 프로세스가 구역별 분/시간 집계 파일 기록 (history.c)
+ *   - 성능 카운터 (SMARTFARM_PERF=1): 수신/제어/로그 구간별 IPC, 캐시 미스 (perfctr.c)
+ *   - 이벤트 추적 (SMARTFARM_TRACE=1): 수신/제어/공개/로그 기록 구간을 추적 링에 기록 (trace.c)
  *   - getpid(), getppid(): 프로세스 정보 조회
  *
  * 프로세스 구조:
- *   [부모 프로세스] - 센서 데이터 수신, 제어 로직
+ *   [부모 프로세스] - epoll 루프: 센서 데이터 수신, 제어 로직, 경고, 제어 명령
  *        │
- *        ├── pipe ──→ [자식 프로세스] - 로그 파일 기록
- *        │
- *        └── pthread ──→ [스레드] - 경고 모니터링
+ *        └── pipe ──→ [자식 프로세스] - 로그 파일 + 이력 인덱스 기록
  *
  * 작성자: Virtual SmartFarm Team
  * 작성일: 2025-12-02
@@ -26,42 +42,195 @@
  */
 
 #include "../include/common.h"
+#include "../include/checkpoint.h"
+#include "../include/control_state.h"
+#include "../include/history.h"
+#include "../include/perfctr.h"
+#include "../include/sensor_index.h"
+#include "../include/shm_store.h"
+#include "../include/trace.h"
+#include "../include/transport.h"
+#include "../include/zone_eval.h"
+#include "../include/zone_hist.h"
+#include "../include/zone_rank.h"
+#include "../include/zone_ring.h"
+
+#include <poll.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+
+#define ALERT_INTERVAL_MS   3000    // 경고 검사 주기
+#define DRAIN_INTERVAL_MS   100     // poll 불가능한 전송 방식(sysv)의 수신 주기
+#define HEARTBEAT_INTERVAL_MS 100   // 하트비트 갱신/감시 주기
+#define HEARTBEAT_IDLE_MS   1000    // 감시할 프로세스가 없을 때의 하트비트 주기 (유휴)
+#define SHUTDOWN_TIMEOUT_MS 2000    // 종료 시 다른 프로세스의 등록 해제를 기다리는 최대 시간
+#define FAILOVER_ENV        "SMARTFARM_FAILOVER_MS"
+#define FAILOVER_MS         500     // 하트비트가 이 시간 이상 멈추면 대기 서버가 인계
+#define LEADER_LOCK_FMT     "/tmp/smartfarm.%s.lock"    // 주 서버가 보유하는 flock
+#define SHARD_LOCK_FMT      "/tmp/smartfarm.%s.shard%d.lock"    // 2번 이후 샤드
+#define MAX_EVENTS          16
+#define MAX_CONTROL_CLIENTS 8
+#define CONTROL_LINE_MAX    256
+#define CONTROL_RANK_TEXT   24      // top 응답의 구역 하나 (" 구역:값")
+#define CONTROL_REPLY_MAX   (512 + ZONE_RANK_K * CONTROL_RANK_TEXT)     // top 목록이 ZONE_RANK_K를 따라 커짐
+
+/* epoll 이벤트 종류 (epoll_event.data.u64 상위 32비트, 하위는 fd) */
+enum {
+    EV_SIGNAL = 1,
+    EV_TRANSPORT,
+    EV_ALERT_TIMER,
+    EV_DRAIN_TIMER,
+    EV_CHECKPOINT_TIMER,
+    EV_HEARTBEAT_TIMER,
+    EV_CONTROL_LISTEN,
+    EV_CONTROL_CLIENT
+};
 
 /* ============================================================================
  * 전역 변수
  * ============================================================================ */
-static int msg_queue_id = -1;
-static int shm_id = -1;
+static Transport *transport = NULL;    // 센서 데이터 수신 채널
+static ShmHandle shm;                  // 공유 메모리 핸들
 static int sem_id = -1;
 static SharedData *shared_data = NULL;
+static int proc_slot = -1;          // 프로세스 등록 테이블 슬롯
 
 /* fork & pipe 관련 */
 static pid_t logger_pid = -1;       // 로그 기록 자식 프로세스 PID
 static int pipe_fd[2] = {-1, -1};   // 파이프: [0]=읽기, [1]=쓰기
 
-/* pthread 관련 */
-static pthread_t alert_thread;
-static int thread_running = 1;
+/* 이벤트 루프 관련 */
+static int epoll_fd = -1;
+static int signal_fd = -1;
+static int alert_timer_fd = -1;
+static int heartbeat_timer_fd = -1;
+static int heartbeat_ms = HEARTBEAT_INTERVAL_MS;    // 현재 하트비트 타이머 주기
+static int leader_fd = -1;          // 리더 잠금 파일 (보유 = 주 서버)
+static int drain_timer_fd = -1;     // sysv 전송 방식에서만 사용
+static int control_fd = -1;         // 제어 소켓 (listen)
+static char control_path[108];
+static int control_clients = 0;
+static int loop_running = 1;
+static int keep_state = 0;          // 1=종료 시 공유 상태/IPC 자원 유지 (detach)
+
+/* 샤드 (--shard 번호/개수, 기본 1/1 = 단일 서버)
+ * 1번 샤드만 IPC 자원/체크포인트/생존 감시/종료 알림을 담당 */
+static int shard_id = 1;
+static int shard_count = 1;
+static int zone_lo = 0, zone_hi = MAX_ZONES;    // 담당 구역 [lo, hi)
+
+/* 체크포인트 */
+static Checkpoint ckpt;
+static int ckpt_enabled = 0;
+static int ckpt_timer_fd = -1;
+static double ckpt_last_ms = 0;     // 마지막 저장 소요 시간
+
+/* 시작 방식 */
+enum { START_COLD = 0, START_WARM, START_RESTORED };
+
+/* 통계 (제어 소켓 status 응답) */
+static time_t start_time;
+static unsigned long msgs_received = 0;
+
+/* 수신 지연 분포 (센서 송신 → 서버 처리, 제어 소켓 stats 응답) - 일반/긴급 따로
+ * 로그-선형 버킷: 2의 거듭제곱 구간마다 8개 (상대 오차 ≤ 12.5%) */
+#define LAT_SUB_BUCKETS     8
+#define LAT_BUCKETS         (64 * LAT_SUB_BUCKETS)
+enum { LAT_ROUTINE = 0, LAT_URGENT, LAT_CLASSES };
+typedef struct {
+    uint64_t hist[LAT_BUCKETS];
+    uint64_t count;
+    uint64_t max_ns;
+} LatHist;
+static LatHist lat[LAT_CLASSES];
+static unsigned long urgent_received = 0;
+static unsigned long unregistered = 0;      // 등록되지 않은 센서 ID로 와서 버린 메시지
+
+/* 제어 상태 게시 - 이벤트 묶음마다 한 번 (control_state.h) */
+static int ctrl_pending = 0;                // 게시 후 제어 비트를 기록했음
+static unsigned long ctrl_published = 0;    // 이 서버가 게시한 변경 구역 수 (누적)
+
+/* 극값 순위 - 표본마다 갱신, 이벤트 묶음마다 SharedData.rank[샤드]에 게시 (zone_rank.h) */
+static ZoneRanker *ranker = NULL;
+static int rank_pending = 0;                // 게시 후 순위 힙을 갱신했음
+
+/* 긴급 채널 (System V는 모든 샤드가 공유, 타입으로 구분) */
+static Transport *urgent = NULL;
+
+/* 과부하 차단 (overload shedding) - 제어 소켓 stats 응답
+ * 데이터 채널 점유율 또는 처리 지연(센서 송신 → 수신)이 진입 기준을 넘으면 집계 모드로 전환:
+ * 일반 메시지는 구역별 최신 값만 제어에 반영하고, 그 사이 값은 로그에 건수/최소/최대 요약 한 줄로 남김
+ * 점유율과 지연이 복귀 기준 아래로 SHED_EXIT_HOLD_MS 동안 유지되면 자동 복귀 (긴급 메시지는 항상 개별 처리)
+ * sysv는 집계 모드 동안 수신 주기를 줄여 큐가 가득 찬 채로 송신자를 막지 않게 함 */
+#define SHED_ENTER_FILL     75      // 채널 점유율(%) 이상이면 진입
+#define SHED_EXIT_FILL      25      // 복귀 조건: 점유율(%) 이하
+#define SHED_ENTER_LAG_MS   500     // 처리 지연 이상이면 진입
+#define SHED_EXIT_LAG_MS    200     // 복귀 조건: 처리 지연 이하 (sysv 수신 주기 100ms보다 크게)
+#define SHED_EXIT_HOLD_MS   1000
+#define SHED_FLUSH_EVERY    1024    // 수신이 끊이지 않아도 이 건수마다 집계 반영
+#define SHED_DRAIN_INTERVAL_MS 10   // 집계 모드의 sysv 수신 주기 (큐가 가득 차 송신자가 막히지 않게)
+
+typedef struct {
+    SensorDataMsg latest;       // 마지막 표본 (제어에 반영)
+    int samples;                // 모인 표본 수
+    float temp_min, temp_max;
+    float hum_min, hum_max;
+} ZoneAgg;
+
+static struct {
+    int active;                 // 1=집계 모드
+    unsigned long transitions;  // 모드 전환 횟수
+    unsigned long long shed;    // 집계로 생략된 표본 수 (최신 값에 합쳐짐)
+    uint64_t entered_ns;        // 현재 집계 모드 진입 시각
+    uint64_t degraded_ns;       // 지금까지 집계 모드에 머문 시간 (현재 구간 제외)
+    uint64_t calm_since;        // 복귀 조건을 처음 만족한 시각 (0=아직)
+    uint64_t lag_ns;            // 최근 처리 지연
+    int fill;                   // 최근 채널 점유율 (%, -1=알 수 없음)
+} shed;
+static ZoneAgg zone_agg[MAX_ZONES];
+static int agg_zones[MAX_ZONES];    // 표본이 모인 구역 목록
+static int agg_count = 0;
+
+/* 구간별 하드웨어 카운터 (제어 소켓 perf 응답, 비활성 시 호출 비용은 분기 하나) */
+static PerfCounters perf;
+static uint64_t t_recv = 0;         // 현재 메시지의 수신 시작 시각 (추적)
 
 /* ============================================================================
  * 로그 메시지 구조체 (파이프 전송용)
  * ============================================================================ */
 typedef struct {
+    int zone_id;
     float temperature;
     float humidity;
     int heater_on;
     int fan_on;
     time_t timestamp;
+    int samples;                // 이 기록이 대표하는 표본 수 (1=일반, >1=집계 모드 요약)
+    float temp_min, temp_max;   // samples > 1일 때 구간의 최소/최대
+    float hum_min, hum_max;
 } LogMessage;
 
 /* ============================================================================
  * 함수: logger_process
  * 설명: 자식 프로세스 - 파이프에서 데이터를 읽어 로그 파일에 기록
  *       fork()로 생성된 별도 프로세스에서 실행
+ *       같은 데이터를 구역별 이력 인덱스(history/)에도 누적하여
+ *       모니터가 로그 파일을 스캔하지 않고 과거 구간을 조회할 수 있게 함
  * ============================================================================ */
 void logger_process() {
     printf("[LOGGER:%d] 로그 기록 프로세스 시작 (부모 PID: %d)\n", 
            getpid(), getppid());
+    proc_slot = proc_register(shared_data, sem_id, PROC_ROLE_LOGGER, -1, 0);
+    trace_init(proc_slot, PROC_ROLE_LOGGER, -1);
+
+    // 리더 잠금은 서버 본체만 보유 (상속된 fd가 잠금을 붙잡지 않도록)
+    close(leader_fd);
     
     // 쓰기 끝 닫기 (자식은 읽기만)
     close(pipe_fd[1]);
@@ -80,10 +249,21 @@ void logger_process() {
             "시간", "온도(°C)", "습도(%)", "히터", "팬");
     fprintf(log_file, "----------------------------------------------------\n");
     fflush(log_file);
+
+    // 이력 인덱스 준비
+    HistoryWriter history;
+    int history_ok = (history_writer_init(&history, HISTORY_DIR) == 0);
     
     // 파이프에서 데이터 읽기 루프
     LogMessage log_msg;
     while (read(pipe_fd[0], &log_msg, sizeof(LogMessage)) > 0) {
+        proc_heartbeat(shared_data, proc_slot, 1);
+        uint64_t t_write = trace_begin();
+        if (history_ok) {
+            history_writer_append(&history, log_msg.zone_id, log_msg.timestamp,
+                                  log_msg.temperature, log_msg.humidity);
+        }
+
         struct tm *t = localtime(&log_msg.timestamp);
         fprintf(log_file, "%04d-%02d-%02d %02d:%02d:%02d  %8.2f  %8.2f  %6s  %4s\n",
                 t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
@@ -91,72 +271,1089 @@ void logger_process() {
                 log_msg.temperature, log_msg.humidity,
                 log_msg.heater_on ? "ON" : "OFF",
                 log_msg.fan_on ? "ON" : "OFF");
+        if (log_msg.samples > 1) {
+            fprintf(log_file, "  └ 구역 %d 집계: 표본 %d건 (생략 %d), 온도 %.2f~%.2f, 습도 %.2f~%.2f\n",
+                    log_msg.zone_id, log_msg.samples, log_msg.samples - 1,
+                    log_msg.temp_min, log_msg.temp_max, log_msg.hum_min, log_msg.hum_max);
+        }
         fflush(log_file);
+        trace_end(TRACE_LOG_WRITE, log_msg.zone_id, t_write);
     }
     
     // 종료 처리
+    if (history_ok) {
+        history_writer_close(&history);
+    }
     fprintf(log_file, "========== 로그 종료: %s", ctime(&(time_t){time(NULL)}));
     fclose(log_file);
     close(pipe_fd[0]);
+    proc_unregister(shared_data, sem_id, proc_slot);
     
     printf("[LOGGER:%d] 로그 기록 프로세스 종료\n", getpid());
     exit(0);
 }
 
 /* ============================================================================
- * 함수: alert_thread_func
- * 설명: 경고 모니터링 스레드 - 임계값 초과 시 경고 출력
- *       pthread로 생성된 별도 스레드에서 실행
+ * 함수: apply_thresholds
+ * 설명: 임계값이 바뀌면 담당 구역 전체의 히터/팬을 새 임계값으로 일괄 재판정
+ *       (구역마다 다음 표본을 기다리지 않음 - zone_eval 비트마스크로 한 번에 비교)
+ * 반환: 제어 상태가 바뀐 구역 수
  * ============================================================================ */
-void *alert_thread_func(void *arg) {
-    (void)arg;
-    printf("[THREAD:0x%lx] 경고 모니터링 스레드 시작\n", pthread_self());
-    
-    while (thread_running) {
+static int applied_temp_thresh = -1, applied_hum_thresh = -1;   // 마지막으로 일괄 적용한 임계값
+
+static int apply_thresholds() {
+    static uint64_t heater[ZONE_MASK_WORDS(MAX_ZONES)], fan[ZONE_MASK_WORDS(MAX_ZONES)];
+    int changed = 0;
+
+    // 담당 구역만 판정: 비트 인덱스는 zone_lo를 내림한 워드 경계(base) 기준
+    int base = zone_lo & ~63;
+    sem_lock(sem_id);
+    ZoneTable *zt = &shared_data->zones;
+    int n = shared_data->active_zones < zone_hi ? shared_data->active_zones : zone_hi;
+    int temp_thresh = shared_data->temp_threshold;
+    int hum_thresh = shared_data->humidity_threshold;
+    if (n > base) {
+        zone_eval_controls(zt->current_temp + base, zt->current_humidity + base, n - base,
+                           (float)temp_thresh, (float)hum_thresh, heater, fan);
+    }
+    for (int z = zone_lo; z < n; z++) {
+        if (zt->last_update[z] == 0) {
+            continue;
+        }
+        int h = control_bit(heater, z - base), f = control_bit(fan, z - base);
+        if (control_get(zt, CTRL_HEATER, z) != h || control_get(zt, CTRL_FAN, z) != f) {
+            control_put(shared_data, CTRL_HEATER, z, h);
+            control_put(shared_data, CTRL_FAN, z, f);
+            changed++;
+        }
+    }
+    sem_unlock(sem_id);
+    ctrl_pending |= changed > 0;
+
+    if (applied_temp_thresh != -1 && changed > 0) {
+        printf("[SERVER] 임계값 %d°C / %d%% 적용 - 구역 %d개 제어 재판정 (%s)\n",
+               temp_thresh, hum_thresh, changed, zone_eval_impl());
+    }
+    applied_temp_thresh = temp_thresh;
+    applied_hum_thresh = hum_thresh;
+    return changed;
+}
+
+/* ============================================================================
+ * 함수: check_alerts
+ * 설명: 경고 검사 - 임계값 초과 구역 경고 출력 (경고 타이머 만료 시 호출)
+ *       고온/저온/고습 조건을 구역 전체에 대해 비트마스크로 한 번에 계산한 뒤 켜진 비트만 출력
+ *       모니터가 공유 메모리의 임계값을 바꿨으면 여기서 일괄 재판정
+ *       극값 순위도 여기서 주기적으로 다시 게시
+ * ============================================================================ */
+void check_alerts() {
+    // 잠금 구간을 짧게 하기 위해 담당 구역 데이터만 복사한 뒤 검사
+    // (배열과 비트 인덱스는 zone_lo를 내림한 워드 경계 base 기준 - 앞 샤드 구역은 다시 계산하지 않음)
+    static time_t updated[MAX_ZONES];
+    static float temps[MAX_ZONES], hums[MAX_ZONES];
+    static uint64_t hot[ZONE_MASK_WORDS(MAX_ZONES)], cold[ZONE_MASK_WORDS(MAX_ZONES)],
+                    humid[ZONE_MASK_WORDS(MAX_ZONES)];
+    int base = zone_lo & ~63;
+
+    sem_lock(sem_id);
+    int hi = shared_data->active_zones < zone_hi ? shared_data->active_zones : zone_hi;
+    int m = hi > base ? hi - base : 0;
+    int temp_thresh = shared_data->temp_threshold;
+    int hum_thresh = shared_data->humidity_threshold;
+    memcpy(updated, shared_data->zones.last_update + base, m * sizeof(time_t));
+    memcpy(temps, shared_data->zones.current_temp + base, m * sizeof(float));
+    memcpy(hums, shared_data->zones.current_humidity + base, m * sizeof(float));
+    sem_unlock(sem_id);
+
+    if (temp_thresh != applied_temp_thresh || hum_thresh != applied_hum_thresh) {
+        apply_thresholds();
+    }
+
+    // 순위 목록을 구역 테이블과 대조 (다른 프로세스가 해제한 구역 제외)
+    sem_lock(sem_id);
+    zone_ranker_publish(ranker, &shared_data->zones, &shared_data->rank[shard_id - 1], 1);
+    sem_unlock(sem_id);
+
+    if (m == 0) {
+        return;
+    }
+    zone_eval_above(temps, m, (float)(temp_thresh + 5), hot);
+    zone_eval_below(temps, m, 20.0f, cold);
+    zone_eval_above(hums, m, (float)(hum_thresh + 10), humid);
+
+    // 경고 조건 체크 (담당 구역 중 데이터를 받은 구역만, i = 구역 - base)
+    for (int w = 0; w * 64 < m; w++) {
+        uint64_t any = hot[w] | cold[w] | humid[w];
+        while (any != 0) {
+            int i = w * 64 + __builtin_ctzll(any);
+            int z = base + i;
+            uint64_t bit = any & -any;
+            any ^= bit;
+            if (z < zone_lo || updated[i] == 0) {
+                continue;
+            }
+            if (hot[w] & bit) {
+                printf("\a[ALERT] ⚠️  구역 %d 고온 경고! 현재 온도: %.1f°C (임계값+5 초과)\n", z, temps[i]);
+            }
+            if (cold[w] & bit) {
+                printf("\a[ALERT] ⚠️  구역 %d 저온 경고! 현재 온도: %.1f°C (20°C 미만)\n", z, temps[i]);
+            }
+            if (humid[w] & bit) {
+                printf("\a[ALERT] ⚠️  구역 %d 고습 경고! 현재 습도: %.1f%% (임계값+10 초과)\n", z, hums[i]);
+            }
+        }
+    }
+}
+
+/* ============================================================================
+ * 함수: check_liveness
+ * 설명: 생존 테이블 검사 (하트비트 타이머마다 호출, 잠금 없이 읽기)
+ *       - 하트비트가 멈춘 프로세스를 응답 없음으로 표시하고 경고 (상태가 바뀔 때만)
+ *       - 센서가 멈추면 해당 구역의 데이터도 더 이상 갱신되지 않음을 알림
+ *       - 등록 해제 없이 죽은 프로세스의 슬롯은 회수
+ * 반환: 하트비트 주기가 있는 다른 등록 프로세스 수 (감시 대상)
+ * ============================================================================ */
+static int check_liveness() {
+    uint64_t now = monotonic_ns();
+    int monitored = 0;
+    for (int i = 0; i < MAX_PROCS; i++) {
+        ProcSlot *s = &shared_data->procs[i];
+        pid_t pid = __atomic_load_n(&s->pid, __ATOMIC_ACQUIRE);
+        if (pid == 0 || i == proc_slot) {
+            continue;
+        }
+        monitored += s->period_ms != 0;
+        int stale = proc_is_stale(s, now);
+        if (stale == (int)s->stale) {
+            continue;
+        }
+        if (stale && !pid_alive(pid)) {
+            printf("[SERVER] ⚠️  %s PID %d 종료됨 (등록 해제 없음) - 슬롯 %d 회수\n",
+                   proc_role_name(s->role), pid, i);
+            sem_lock(sem_id);
+            if (s->pid == pid) {
+                __atomic_store_n(&s->pid, 0, __ATOMIC_RELEASE);
+                s->role = PROC_ROLE_NONE;
+            }
+            sem_unlock(sem_id);
+            continue;
+        }
+        __atomic_store_n(&s->stale, (uint32_t)stale, __ATOMIC_RELAXED);
+        if (stale) {
+            printf("[SERVER] ⚠️  %s PID %d 응답 없음: 마지막 하트비트 %llums 전 (루프 %llu회)\n",
+                   proc_role_name(s->role), pid,
+                   (unsigned long long)proc_heartbeat_age_ms(s, now),
+                   (unsigned long long)s->loops);
+            if (s->role == PROC_ROLE_SENSOR && zone_valid(s->zone)) {
+                printf("[SERVER] ⚠️  구역 %d 센서 데이터가 갱신되지 않음 (마지막 값 유지 중)\n", s->zone);
+            }
+        } else {
+            printf("[SERVER] %s PID %d 응답 재개 (루프 %llu회)\n",
+                   proc_role_name(s->role), pid, (unsigned long long)s->loops);
+        }
+    }
+    return monitored;
+}
+
+/* ============================================================================
+ * 함수: lat_record / lat_percentile_us
+ * 설명: 지연 분포 기록 (버킷 = 최상위 비트 위치 × 8 + 다음 3비트)
+ * ============================================================================ */
+static void lat_record(LatHist *h, uint64_t ns) {
+    int idx;
+    if (ns < LAT_SUB_BUCKETS) {
+        idx = (int)ns;
+    } else {
+        int msb = 63 - __builtin_clzll(ns);
+        idx = (msb - 2) * LAT_SUB_BUCKETS + (int)((ns >> (msb - 3)) & (LAT_SUB_BUCKETS - 1));
+    }
+    h->hist[idx]++;
+    h->count++;
+    if (ns > h->max_ns) h->max_ns = ns;
+}
+
+static double lat_percentile_us(const LatHist *h, double pct) {
+    if (h->count == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(h->count * pct / 100.0), seen = 0;
+    for (int idx = 0; idx < LAT_BUCKETS; idx++) {
+        seen += h->hist[idx];
+        if (seen > target) {
+            if (idx < LAT_SUB_BUCKETS) {
+                return idx / 1000.0;
+            }
+            int msb = idx / LAT_SUB_BUCKETS + 2;
+            uint64_t lo = (uint64_t)(LAT_SUB_BUCKETS + idx % LAT_SUB_BUCKETS) << (msb - 3);
+            uint64_t width = 1ull << (msb - 3);
+            return (lo + width / 2) / 1000.0;      // 버킷 중앙값
+        }
+    }
+    return h->max_ns / 1000.0;
+}
+
+/* ============================================================================
+ * 함수: accept_sample
+ * 설명: 수신한 표본 검증 후 수신 건수와 지연 분포에 반영 (집계 모드에서 생략되는 표본 포함)
+ *       센서 ID가 있으면 등록 색인(잠금 없음)에서 구역 슬롯을 찾아 zone_id를 덮어씀
+ * 반환: 1=처리 대상, 0=무시 (미등록 센서, 잘못된 구역 또는 담당 범위 밖)
+ * ============================================================================ */
+static int accept_sample(SensorDataMsg *sensor_msg) {
+    if (sensor_msg->sensor_id != 0) {
+        int slot = sensor_lookup(shared_data, sem_id, sensor_msg->sensor_id);
+        if (slot < 0) {
+            if (unregistered++ == 0) {
+                fprintf(stderr, "[SERVER] 등록되지 않은 센서 %u - 무시 (이후 stats의 unregistered로 집계)\n",
+                        sensor_msg->sensor_id);
+            }
+            return 0;
+        }
+        sensor_msg->zone_id = slot;
+    }
+    int zone = sensor_msg->zone_id;
+    if (!zone_valid(zone)) {
+        fprintf(stderr, "[SERVER] 잘못된 구역 번호 %d - 무시\n", zone);
+        return 0;
+    }
+    if (zone < zone_lo || zone >= zone_hi) {
+        fprintf(stderr, "[SERVER] 구역 %d는 샤드 %d 담당 범위(%d~%d) 밖 - 무시\n",
+                zone, shard_id, zone_lo, zone_hi - 1);
+        return 0;
+    }
+    int is_urgent = (sensor_msg->flags & SENSOR_FLAGS_URGENT) != 0;
+    msgs_received++;
+    urgent_received += is_urgent;
+    if (sensor_msg->sent_ns != 0) {
+        uint64_t now = monotonic_ns();
+        uint64_t ns = now > sensor_msg->sent_ns ? now - sensor_msg->sent_ns : 0;
+        lat_record(&lat[is_urgent ? LAT_URGENT : LAT_ROUTINE], ns);
+        if (!is_urgent) {
+            shed.lag_ns = ns;
+        }
+    }
+    return 1;
+}
+
+/* ============================================================================
+ * 함수: handle_sensor_data
+ * 설명: 센서 데이터 1건 처리 - 제어 판단, 공유 메모리 기록, 로그 전송
+ *       agg: 집계 모드에서 이 표본이 대표하는 구간 요약 (NULL=개별 표본)
+ * ============================================================================ */
+void handle_sensor_data(const SensorDataMsg *sensor_msg, const ZoneAgg *agg) {
+    int zone = sensor_msg->zone_id;
+    int is_urgent = (sensor_msg->flags & SENSOR_FLAGS_URGENT) != 0;
+    perfctr_stage(&perf, PERF_STAGE_INGEST);
+    trace_end(TRACE_SERVER_RECV, zone, t_recv);
+    uint64_t t_control = trace_begin();
+
+    // 임계값 읽기
+    sem_lock(sem_id);
+    int temp_thresh = shared_data->temp_threshold;
+    int hum_thresh = shared_data->humidity_threshold;
+    sem_unlock(sem_id);
+
+    // 제어 로직
+    int new_heater = (sensor_msg->temperature < temp_thresh) ? 1 : 0;
+    int new_fan = (sensor_msg->humidity > hum_thresh) ? 1 : 0;
+    trace_end(TRACE_CONTROL, zone, t_control);
+
+    // 공유 메모리에 상태 기록 + 최근 표본 링과 압축 이력에 추가 (기록자는 이 구역 담당 샤드뿐)
+    RingSample sample = {
+        .ts = (uint32_t)sensor_msg->timestamp,
+        .temperature = sensor_msg->temperature,
+        .humidity = sensor_msg->humidity,
+        .samples = (uint16_t)(agg == NULL ? 1 : agg->samples > UINT16_MAX ? UINT16_MAX : agg->samples),
+        .flags = (uint16_t)sensor_msg->flags,
+    };
+    uint64_t t_publish = trace_begin();
+    sem_lock(sem_id);
+    zone_ring_push(&shared_data->recent[zone], &sample);
+    zone_hist_append(&shared_data->hist[zone], sample.ts, sensor_msg->temperature, sensor_msg->humidity);
+    control_set(shared_data, zone, new_heater, new_fan, 1);
+    shared_data->zones.current_temp[zone] = sensor_msg->temperature;
+    shared_data->zones.current_humidity[zone] = sensor_msg->humidity;
+    shared_data->zones.last_update[zone] = sensor_msg->timestamp;
+    if (zone >= shared_data->active_zones) {
+        shared_data->active_zones = zone + 1;
+    }
+    sem_unlock(sem_id);
+    ctrl_pending = 1;
+    zone_ranker_update(ranker, zone, sensor_msg->temperature, sensor_msg->humidity);
+    rank_pending = 1;
+    trace_end(TRACE_PUBLISH, zone, t_publish);
+    perfctr_stage(&perf, PERF_STAGE_CONTROL);
+
+    printf("[SERVER] 구역 %d 센서 데이터%s - 온도: %.2f°C, 습도: %.2f%%\n", zone,
+           !is_urgent ? "" : (sensor_msg->flags & SENSOR_FLAG_FAULT) ? " [긴급: 센서 이상]" : " [긴급]",
+           sensor_msg->temperature, sensor_msg->humidity);
+    printf("[SERVER] 구역 %d 제어 명령 - 히터:%s, 팬:%s\n", zone,
+           new_heater ? "ON" : "OFF",
+           new_fan ? "ON" : "OFF");
+
+    // 파이프로 로그 데이터 전송 (자식 프로세스에게)
+    LogMessage log_msg;
+    log_msg.zone_id = zone;
+    log_msg.temperature = sensor_msg->temperature;
+    log_msg.humidity = sensor_msg->humidity;
+    log_msg.heater_on = new_heater;
+    log_msg.fan_on = new_fan;
+    log_msg.timestamp = time(NULL);
+    log_msg.samples = agg != NULL ? agg->samples : 1;
+    log_msg.temp_min = agg != NULL ? agg->temp_min : sensor_msg->temperature;
+    log_msg.temp_max = agg != NULL ? agg->temp_max : sensor_msg->temperature;
+    log_msg.hum_min = agg != NULL ? agg->hum_min : sensor_msg->humidity;
+    log_msg.hum_max = agg != NULL ? agg->hum_max : sensor_msg->humidity;
+    if (write(pipe_fd[1], &log_msg, sizeof(LogMessage)) == -1) {
+        perror("[SERVER] 로그 전송 실패");
+    }
+    perfctr_stage(&perf, PERF_STAGE_LOG);
+}
+
+/* ============================================================================
+ * 함수: drain_urgent
+ * 설명: 긴급 채널(System V는 긴급 타입)에 쌓인 메시지를 모두 처리
+ * ============================================================================ */
+static void drain_urgent() {
+    SensorDataMsg sensor_msg;
+    for (;;) {
+        t_recv = trace_begin();
+        if (transport_recv(urgent, &sensor_msg, sizeof(SensorDataMsg),
+                           SHARD_URGENT_MSG_TYPE(shard_id), TRANSPORT_NONBLOCK) == -1) {
+            break;
+        }
+        if (accept_sample(&sensor_msg)) {
+            handle_sensor_data(&sensor_msg, NULL);
+        }
+    }
+}
+
+/* ============================================================================
+ * 함수: aggregate_sample / flush_aggregates
+ * 설명: 집계 모드 - 구역별로 최신 표본과 최소/최대만 모아 두었다가
+ *       한 번에 구역당 1건씩 제어/로그에 반영
+ * ============================================================================ */
+static void aggregate_sample(const SensorDataMsg *sensor_msg) {
+    ZoneAgg *a = &zone_agg[sensor_msg->zone_id];
+    float temp = sensor_msg->temperature, hum = sensor_msg->humidity;
+    if (a->samples == 0) {
+        agg_zones[agg_count++] = sensor_msg->zone_id;
+        a->temp_min = a->temp_max = temp;
+        a->hum_min = a->hum_max = hum;
+    } else {
+        shed.shed++;    // 이전 최신 값은 제어에 반영되지 않고 요약으로만 남음
+        if (temp < a->temp_min) a->temp_min = temp;
+        if (temp > a->temp_max) a->temp_max = temp;
+        if (hum < a->hum_min) a->hum_min = hum;
+        if (hum > a->hum_max) a->hum_max = hum;
+    }
+    a->samples++;
+    a->latest = *sensor_msg;
+}
+
+static void flush_aggregates() {
+    for (int i = 0; i < agg_count; i++) {
+        ZoneAgg *a = &zone_agg[agg_zones[i]];
+        t_recv = trace_begin();
+        handle_sensor_data(&a->latest, a);
+        a->samples = 0;
+    }
+    agg_count = 0;
+}
+
+/* ============================================================================
+ * 함수: timer_set_ms
+ * 설명: 주기 timerfd의 주기 변경 (첫 만료도 한 주기 뒤)
+ * ============================================================================ */
+static int timer_set_ms(int fd, int interval_ms) {
+    struct itimerspec its;
+    its.it_interval.tv_sec = interval_ms / 1000;
+    its.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    its.it_value = its.it_interval;
+    return timerfd_settime(fd, 0, &its, NULL);
+}
+
+/* ============================================================================
+ * 함수: heartbeat_retune
+ * 설명: 감시할 프로세스가 있거나 과부하 모드이면 HEARTBEAT_INTERVAL_MS, 아니면 HEARTBEAT_IDLE_MS
+ *       바뀐 주기는 자기 등록 슬롯(1번 샤드의 생존 판정)과 헤더(대기 서버의 장애 판정)에 게시
+ *       (호출 직전에 하트비트를 갱신했으므로 주기를 줄여도 곧바로 응답 없음으로 보이지 않음)
+ * ============================================================================ */
+static void heartbeat_retune(int monitored) {
+    int want = (monitored > 0 || shed.active) ? HEARTBEAT_INTERVAL_MS : HEARTBEAT_IDLE_MS;
+    if (want == heartbeat_ms || heartbeat_timer_fd == -1) {
+        return;
+    }
+    heartbeat_ms = want;
+    timer_set_ms(heartbeat_timer_fd, want);
+    if (proc_slot >= 0) {
+        __atomic_store_n(&shared_data->procs[proc_slot].period_ms, (uint32_t)want, __ATOMIC_RELEASE);
+    }
+    if (shard_id == 1) {
+        __atomic_store_n(&shared_data->hdr.heartbeat_period_ms, (uint32_t)want, __ATOMIC_RELEASE);
+    }
+}
+
+/* ============================================================================
+ * 함수: shed_update
+ * 설명: 채널 점유율과 처리 지연으로 모드 결정 (진입은 즉시, 복귀는 SHED_EXIT_HOLD_MS 유지 후)
+ * ============================================================================ */
+static void shed_update() {
+    long pending, capacity;
+    shed.fill = (transport_backlog(transport, &pending, &capacity) == 0 && capacity > 0)
+                ? (int)(pending * 100 / capacity) : -1;
+    double lag_ms = shed.lag_ns / 1e6;
+    uint64_t now = monotonic_ns();
+
+    if (!shed.active) {
+        if (shed.fill >= SHED_ENTER_FILL || lag_ms >= SHED_ENTER_LAG_MS) {
+            shed.active = 1;
+            shed.transitions++;
+            shed.entered_ns = now;
+            shed.calm_since = 0;
+            if (drain_timer_fd != -1) {
+                timer_set_ms(drain_timer_fd, SHED_DRAIN_INTERVAL_MS);
+            }
+            heartbeat_retune(1);    // 수신이 끊겨도 복귀 조건을 평가하도록 하트비트 주기 복원
+            printf("[SERVER] ⚠️  과부하 감지 (채널 점유율 %d%%, 처리 지연 %.0fms) → 집계 모드\n",
+                   shed.fill, lag_ms);
+        }
+        return;
+    }
+    if (shed.fill > SHED_EXIT_FILL || lag_ms > SHED_EXIT_LAG_MS) {
+        shed.calm_since = 0;
+        return;
+    }
+    if (shed.calm_since == 0) {
+        shed.calm_since = now;
+    } else if (now - shed.calm_since >= (uint64_t)SHED_EXIT_HOLD_MS * 1000000ull) {
+        flush_aggregates();
+        shed.active = 0;
+        shed.transitions++;
+        shed.degraded_ns += now - shed.entered_ns;
+        if (drain_timer_fd != -1) {
+            timer_set_ms(drain_timer_fd, DRAIN_INTERVAL_MS);
+        }
+        printf("[SERVER] 부하 회복 → 일반 모드 (집계 %.1f초, 누적 생략 %llu건)\n",
+               (now - shed.entered_ns) / 1e9, shed.shed);
+    }
+}
+
+/* ============================================================================
+ * 함수: drain_transport
+ * 설명: 쌓인 센서 메시지를 모두 처리 (여러 구역의 센서가 동시에 보냄)
+ *       긴급 메시지를 먼저 비우고, 일반 메시지 URGENT_POLL_BATCH건마다 다시 확인
+ *       poll 가능한 전송 방식은 EAGAIN까지 비워야 다음 통지를 받음
+ * ============================================================================ */
+void drain_transport() {
+    SensorDataMsg sensor_msg;
+    perfctr_mark(&perf);     // 대기 시간은 제외하고 수신 구간부터 측정
+    drain_urgent();
+    unsigned batch = 0;
+    for (;;) {
+        t_recv = trace_begin();
+        if (transport_recv(transport, &sensor_msg, sizeof(SensorDataMsg),
+                           SHARD_MSG_TYPE(shard_id), TRANSPORT_NONBLOCK) == -1) {
+            break;
+        }
+        batch++;
+        if (accept_sample(&sensor_msg)) {
+            if (shed.active) {
+                aggregate_sample(&sensor_msg);
+            } else {
+                handle_sensor_data(&sensor_msg, NULL);
+            }
+        }
+        if (batch % URGENT_POLL_BATCH == 0) {
+            drain_urgent();
+            shed_update();
+        }
+        if (batch % SHED_FLUSH_EVERY == 0) {
+            flush_aggregates();
+        }
+    }
+    flush_aggregates();
+    if (batch == 0) {
+        shed.lag_ns = 0;     // 밀린 메시지 없음
+    }
+    shed_update();
+}
+
+/* ============================================================================
+ * 함수: control_reply
+ * ============================================================================ */
+static void control_reply(int fd, const char *fmt, ...) {
+    char buf[CONTROL_REPLY_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n > (int)sizeof(buf) - 1) {
+        // 잘려도 줄 끝은 유지 (클라이언트는 개행까지 읽음)
+        n = sizeof(buf) - 1;
+        buf[n - 1] = '\n';
+    }
+    send(fd, buf, n, MSG_NOSIGNAL);     // 클라이언트가 먼저 끊어도 SIGPIPE 없음
+}
+
+/* ============================================================================
+ * 함수: control_command
+ * 설명: 제어 명령 한 줄 처리
+ *   status              - 실행 상태 요약
+ *   stats [reset]       - 수신 건수, 일반/긴급별 지연 분포 (p50/p99/최대), 과부하 모드/생략 건수
+ *                         reset은 지연 분포 초기화
+ *   perf [reset]        - 구간별 샘플당 사이클, IPC, 캐시 미스, 컨텍스트 스위치
+ *   set temp <20~40>    - 온도 임계값 변경
+ *   set humidity <30~90> - 습도 임계값 변경
+ *   sensors             - 등록 색인 현황 (등록 수, 빈 슬롯, 탐사 길이)
+ *   sensor add|del <ID> - 센서 ID 등록/해제 (응답: 배정/반납된 구역 슬롯)
+ *   top [hot|cold|humid|dry] [N] - 온도/습도 극값 구역 N개 (기본 hot 10개 - ZONE_RANK_K가 더 작으면 그만큼, 전체 샤드 병합, 구역:값)
+ *   recent <구역> [초]  - 메모리 압축 이력에서 최근 구간 요약 (기본 300초, 디스크 미사용)
+ *   shutdown            - 서버 종료 (Ctrl+C와 동일)
+ *   detach              - 공유 상태를 남기고 서버만 종료 (SIGQUIT와 동일)
+ * ============================================================================ */
+static void control_command(int fd, char *line) {
+    char cmd[32] = "", arg[32] = "";
+    int value = 0;
+    int nf = sscanf(line, "%31s %31s %d", cmd, arg, &value);
+
+    if (nf < 1) {
+        return;
+    }
+    if (strcmp(cmd, "status") == 0) {
         sem_lock(sem_id);
-        float temp = shared_data->current_temp;
-        float hum = shared_data->current_humidity;
         int temp_thresh = shared_data->temp_threshold;
         int hum_thresh = shared_data->humidity_threshold;
+        int active = 0;
+        for (int z = zone_lo; z < shared_data->active_zones && z < zone_hi; z++) {
+            if (shared_data->zones.last_update[z] != 0) active++;
+        }
+        sem_unlock(sem_id);
+        control_reply(fd, "ok pid=%d uptime=%lds transport=%s shard=%d/%d zone_range=%d-%d "
+                      "zones=%d msgs=%lu temp_threshold=%d humidity_threshold=%d "
+                      "checkpoint_seq=%llu checkpoint_ms=%.2f\n",
+                      getpid(), (long)(time(NULL) - start_time),
+                      transport_kind_name(transport_kind_from_env()),
+                      shard_id, shard_count, zone_lo, zone_hi - 1,
+                      active, msgs_received, temp_thresh, hum_thresh,
+                      ckpt_enabled ? (unsigned long long)ckpt.seq : 0ull, ckpt_last_ms);
+    } else if (strcmp(cmd, "stats") == 0) {
+        const LatHist *r = &lat[LAT_ROUTINE], *u = &lat[LAT_URGENT];
+        control_reply(fd, "ok msgs=%lu lat_samples=%llu lat_p50_us=%.1f lat_p99_us=%.1f "
+                      "lat_max_us=%.1f urgent_msgs=%lu urgent_samples=%llu urgent_p50_us=%.1f "
+                      "urgent_p99_us=%.1f urgent_max_us=%.1f mode=%s mode_changes=%lu shed=%llu "
+                      "degraded_s=%.1f backlog_pct=%d lag_ms=%.1f unregistered=%lu ctrl_gen=%u "
+                      "ctrl_published=%lu rank_rebuilds=%u\n",
+                      msgs_received, (unsigned long long)r->count,
+                      lat_percentile_us(r, 50), lat_percentile_us(r, 99), r->max_ns / 1000.0,
+                      urgent_received, (unsigned long long)u->count,
+                      lat_percentile_us(u, 50), lat_percentile_us(u, 99), u->max_ns / 1000.0,
+                      shed.active ? "degraded" : "normal", shed.transitions, shed.shed,
+                      (shed.degraded_ns + (shed.active ? monotonic_ns() - shed.entered_ns : 0)) / 1e9,
+                      shed.fill, shed.lag_ns / 1e6, unregistered,
+                      __atomic_load_n(&shared_data->control.gen, __ATOMIC_RELAXED), ctrl_published,
+                      zone_ranker_rebuilds(ranker));
+        if (nf >= 2 && strcmp(arg, "reset") == 0) {
+            memset(lat, 0, sizeof(lat));
+        }
+    } else if (strcmp(cmd, "perf") == 0) {
+        char summary[400];
+        perfctr_format(&perf, summary, sizeof(summary));
+        control_reply(fd, "ok %s\n", summary);
+        if (nf >= 2 && strcmp(arg, "reset") == 0) {
+            perfctr_reset(&perf);
+        }
+    } else if (strcmp(cmd, "set") == 0 && nf == 3 && strcmp(arg, "temp") == 0) {
+        if (value < 20 || value > 40) {
+            control_reply(fd, "error 온도 임계값은 20~40 범위\n");
+            return;
+        }
+        sem_lock(sem_id);
+        shared_data->temp_threshold = value;
+        sem_unlock(sem_id);
+        printf("[SERVER] 제어 소켓: 온도 임계값 → %d°C\n", value);
+        control_reply(fd, "ok changed=%d\n", apply_thresholds());
+    } else if (strcmp(cmd, "set") == 0 && nf == 3 && strcmp(arg, "humidity") == 0) {
+        if (value < 30 || value > 90) {
+            control_reply(fd, "error 습도 임계값은 30~90 범위\n");
+            return;
+        }
+        sem_lock(sem_id);
+        shared_data->humidity_threshold = value;
+        sem_unlock(sem_id);
+        printf("[SERVER] 제어 소켓: 습도 임계값 → %d%%\n", value);
+        control_reply(fd, "ok changed=%d\n", apply_thresholds());
+    } else if (strcmp(cmd, "sensors") == 0) {
+        double probe_avg;
+        uint32_t probe_max;
+        SensorIndex *ix = &shared_data->sensors;
+        sem_lock(sem_id);
+        sensor_index_probe_stats(ix, &probe_avg, &probe_max);
+        uint32_t count = ix->count, free_top = ix->free_top, next_fresh = ix->next_fresh;
+        unsigned long long added = ix->added, removed = ix->removed;
         sem_unlock(sem_id);
-        
-        // 경고 조건 체크
-        if (temp > temp_thresh + 5) {
-            printf("\a[ALERT] ⚠️  고온 경고! 현재 온도: %.1f°C (임계값+5 초과)\n", temp);
+        control_reply(fd, "ok registered=%u capacity=%d free_slots=%u next_fresh=%u added=%llu "
+                      "removed=%llu probe_avg=%.2f probe_max=%u\n",
+                      count, MAX_ZONES, free_top, next_fresh, added, removed, probe_avg, probe_max);
+    } else if (strcmp(cmd, "sensor") == 0 && nf >= 2 &&
+               (strcmp(arg, "add") == 0 || strcmp(arg, "del") == 0)) {
+        unsigned int id = 0;
+        if (sscanf(line, "%*s %*s %u", &id) != 1 || id == 0) {
+            control_reply(fd, "error 센서 ID는 1~%u 범위\n", UINT32_MAX);
+            return;
         }
-        if (temp < 20.0) {
-            printf("\a[ALERT] ⚠️  저온 경고! 현재 온도: %.1f°C (20°C 미만)\n", temp);
+        int add = strcmp(arg, "add") == 0;
+        int slot = add ? sensor_register(shared_data, sem_id, id)
+                       : sensor_deregister(shared_data, sem_id, id);
+        if (slot == -1) {
+            control_reply(fd, "error %s\n", errno == ENOENT ? "등록되지 않은 센서" :
+                          errno == ENOSPC ? "빈 구역 슬롯 없음" : strerror(errno));
+            return;
         }
-        if (hum > hum_thresh + 10) {
-            printf("\a[ALERT] ⚠️  고습 경고! 현재 습도: %.1f%% (임계값+10 초과)\n", hum);
+        if (!add) {
+            zone_ranker_remove(ranker, slot);
+            rank_pending = 1;
         }
-        
-        sleep(3);  // 3초마다 체크
+        printf("[SERVER] 제어 소켓: 센서 %u %s (구역 슬롯 %d)\n", id, add ? "등록" : "해제", slot);
+        control_reply(fd, "ok slot=%d\n", slot);
+    } else if (strcmp(cmd, "top") == 0) {
+        int kind = nf >= 2 ? zone_rank_kind(arg) : RANK_HOT;
+        int want = nf >= 3 ? value : (ZONE_RANK_K < 10 ? ZONE_RANK_K : 10);
+        if (kind < 0 || want < 1 || want > ZONE_RANK_K) {
+            control_reply(fd, "error top [hot|cold|humid|dry] [1~%d]\n", ZONE_RANK_K);
+            return;
+        }
+        RankEntry top[ZONE_RANK_K];
+        int n = zone_rank_read(shared_data, kind, top, want);
+        char list[ZONE_RANK_K * CONTROL_RANK_TEXT] = "";
+        size_t len = 0;
+        for (int i = 0; i < n && len < sizeof(list); i++) {
+            len += snprintf(list + len, sizeof(list) - len, " %d:%.1f", top[i].zone, top[i].value);
+        }
+        control_reply(fd, "ok kind=%s n=%d%s\n", zone_rank_name(kind), n, list);
+    } else if (strcmp(cmd, "recent") == 0 && nf >= 2) {
+        char *end;
+        long zone = strtol(arg, &end, 10);
+        int seconds = nf >= 3 ? value : 300;
+        if (*end != '\0' || zone < 0 || zone >= MAX_ZONES || seconds < 1) {
+            control_reply(fd, "error recent <구역 0~%d> [초]\n", MAX_ZONES - 1);
+            return;
+        }
+        HistoryQueryResult r;
+        time_t now = time(NULL);
+        uint64_t retained = 0, bytes = 0;
+        int rc = zone_hist_query(&shared_data->hist[zone], (int)zone, now - seconds, now, &r);
+        sem_lock(sem_id);
+        zone_hist_usage(&shared_data->hist[zone], &retained, &bytes);
+        sem_unlock(sem_id);
+        uint32_t oldest = zone_hist_oldest(&shared_data->hist[zone]);
+        if (rc != 0) {
+            control_reply(fd, "ok zone=%ld seconds=%d samples=0 retained=%llu\n", zone, seconds,
+                          (unsigned long long)retained);
+            return;
+        }
+        control_reply(fd, "ok zone=%ld seconds=%d samples=%u temp_min=%.2f temp_max=%.2f "
+                      "temp_avg=%.2f hum_min=%.2f hum_max=%.2f hum_avg=%.2f blocks=%u retained=%llu "
+                      "span_s=%ld bytes_per_sample=%.2f\n",
+                      zone, seconds, r.samples, r.temp_min, r.temp_max, r.temp_avg, r.hum_min,
+                      r.hum_max, r.hum_avg, r.buckets, (unsigned long long)retained,
+                      oldest ? (long)(now - oldest) : 0L, retained ? (double)bytes / retained : 0.0);
+    } else if (strcmp(cmd, "shutdown") == 0) {
+        printf("[SERVER] 제어 소켓: 종료 요청\n");
+        control_reply(fd, "ok\n");
+        loop_running = 0;
+    } else if (strcmp(cmd, "detach") == 0) {
+        printf("[SERVER] 제어 소켓: 상태 유지 종료 요청 (웜 재시작 대기)\n");
+        control_reply(fd, "ok\n");
+        keep_state = 1;
+        loop_running = 0;
+    } else {
+        control_reply(fd, "error 명령: status | stats [reset] | perf [reset] | set temp <N> | "
+                      "set humidity <N> | sensors | sensor add|del <ID> | top [kind] [N] | "
+                      "recent <zone> [sec] | shutdown | detach\n");
+    }
+}
+
+/* ============================================================================
+ * 함수: control_accept / control_read
+ * 설명: 제어 소켓 연결 수락 및 명령 수신 (한 번의 read에 들어온 줄 단위 처리)
+ * ============================================================================ */
+static void control_accept() {
+    int fd;
+    // 리슨 소켓이 논블로킹이므로 대기 중인 연결을 모두 받으면 EAGAIN으로 종료
+    while ((fd = accept(control_fd, NULL, NULL)) != -1) {
+        if (control_clients >= MAX_CONTROL_CLIENTS) {
+            control_reply(fd, "error 연결 수 초과\n");
+            close(fd);
+            continue;
+        }
+        struct epoll_event ev = { .events = EPOLLIN,
+                                  .data.u64 = ((uint64_t)EV_CONTROL_CLIENT << 32) | (uint32_t)fd };
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            close(fd);
+            continue;
+        }
+        control_clients++;
+    }
+}
+
+static void control_read(int fd) {
+    char buf[CONTROL_LINE_MAX];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    if (n <= 0) {
+        if (n == -1 && errno == EAGAIN) {
+            return;
+        }
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+        close(fd);
+        control_clients--;
+        return;
+    }
+    buf[n] = '\0';
+    char *save = NULL;
+    for (char *line = strtok_r(buf, "\r\n", &save); line != NULL;
+         line = strtok_r(NULL, "\r\n", &save)) {
+        control_command(fd, line);
+    }
+}
+
+/* ============================================================================
+ * 함수: save_checkpoint
+ * 설명: 현재 공유 상태를 체크포인트 파일에 저장
+ *       잠금 구간은 스냅샷 memcpy 한 번, 체크섬/msync는 잠금 밖에서 수행
+ * ============================================================================ */
+static void save_checkpoint() {
+    if (!ckpt_enabled || shared_data == NULL) {
+        return;
+    }
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    SharedData *snap = checkpoint_begin(&ckpt);
+    sem_lock(sem_id);
+    memcpy(snap, shared_data, CHECKPOINT_DATA_SIZE);     // 압축 이력 제외
+    sem_unlock(sem_id);
+    if (checkpoint_commit(&ckpt) == -1) {
+        perror("[SERVER] 체크포인트 저장 실패");
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ckpt_last_ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+}
+
+/* ============================================================================
+ * 함수: timer_create_ms
+ * 설명: 주기 timerfd 생성 (만료 횟수는 read로 소거)
+ * ============================================================================ */
+static int timer_create_ms(int interval_ms) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    if (timer_set_ms(fd, interval_ms) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int epoll_add(int fd, uint32_t kind) {
+    struct epoll_event ev = { .events = EPOLLIN,
+                              .data.u64 = ((uint64_t)kind << 32) | (uint32_t)fd };
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+/* ============================================================================
+ * 함수: setup_control_socket
+ * 설명: 제어 소켓 생성 (/tmp/smartfarm.<인스턴스>.ctl, 2번 이후 샤드는 .shard<N>.ctl)
+ * ============================================================================ */
+static int setup_control_socket() {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    shard_control_socket_path(control_path, sizeof(control_path), shard_id);
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", control_path);
+
+    control_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (control_fd == -1) {
+        return -1;
+    }
+    unlink(control_path);       // 비정상 종료로 남은 소켓 파일
+    if (bind(control_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        listen(control_fd, MAX_CONTROL_CLIENTS) == -1) {
+        close(control_fd);
+        control_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: setup_event_loop
+ * 설명: epoll 인스턴스와 이벤트 소스 등록
+ *       (시그널은 main에서 fork 전에 차단해 두었으므로 signalfd로만 수신)
+ * ============================================================================ */
+static int setup_event_loop(const sigset_t *mask) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        return -1;
+    }
+
+    signal_fd = signalfd(-1, mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd == -1 || epoll_add(signal_fd, EV_SIGNAL) == -1) {
+        return -1;
+    }
+
+    alert_timer_fd = timer_create_ms(ALERT_INTERVAL_MS);
+    if (alert_timer_fd == -1 || epoll_add(alert_timer_fd, EV_ALERT_TIMER) == -1) {
+        return -1;
+    }
+
+    heartbeat_timer_fd = timer_create_ms(HEARTBEAT_INTERVAL_MS);
+    if (heartbeat_timer_fd == -1 || epoll_add(heartbeat_timer_fd, EV_HEARTBEAT_TIMER) == -1) {
+        return -1;
+    }
+
+    int tfd = transport_fd(transport);
+    if (tfd != -1) {
+        // 메시지가 도착할 때만 깨어남 (유휴 시 깨어나지 않음)
+        if (epoll_add(tfd, EV_TRANSPORT) == -1) {
+            return -1;
+        }
+        printf("[SERVER] 이벤트 루프: 전송 계층 fd %d 등록\n", tfd);
+        int ufd = transport_fd(urgent);
+        if (ufd != -1) {
+            if (epoll_add(ufd, EV_TRANSPORT) == -1) {
+                return -1;
+            }
+            printf("[SERVER] 이벤트 루프: 긴급 채널 fd %d 등록\n", ufd);
+        }
+    } else {
+        // System V 메시지 큐는 fd가 없으므로 주기적으로 비움
+        drain_timer_fd = timer_create_ms(DRAIN_INTERVAL_MS);
+        if (drain_timer_fd == -1 || epoll_add(drain_timer_fd, EV_DRAIN_TIMER) == -1) {
+            return -1;
+        }
+        printf("[SERVER] 이벤트 루프: %s 전송은 poll 불가 → %dms 주기 수신\n",
+               transport_kind_name(transport_kind_from_env()), DRAIN_INTERVAL_MS);
+    }
+
+    if (ckpt_enabled) {
+        const char *env = getenv(CHECKPOINT_PERIOD_ENV);
+        int sec = (env != NULL && atoi(env) > 0) ? atoi(env) : CHECKPOINT_PERIOD_SEC;
+        ckpt_timer_fd = timer_create_ms(sec * 1000);
+        if (ckpt_timer_fd == -1 || epoll_add(ckpt_timer_fd, EV_CHECKPOINT_TIMER) == -1) {
+            return -1;
+        }
+        printf("[SERVER] 체크포인트: %s (%d초 주기)\n", ckpt.path, sec);
+    }
+
+    if (setup_control_socket() == -1 || epoll_add(control_fd, EV_CONTROL_LISTEN) == -1) {
+        perror("[SERVER] 제어 소켓 생성 실패 (제어 명령 비활성)");
+    } else {
+        printf("[SERVER] 제어 소켓: %s\n", control_path);
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: publish_state
+ * 설명: 이벤트 묶음이 끝날 때 한 번 - 세마포어 구간 하나에서
+ *       - 바뀐 제어 비트를 한 세대로 게시 (XOR 변경 집합)
+ *       - 갱신된 극값 순위를 정렬해 이 샤드의 순위 목록에 기록
+ *       묶음 안에서 같은 구역이 여러 번 바뀌어도 최종 상태만 한 번 게시됨
+ * ============================================================================ */
+static void publish_state() {
+    if (!ctrl_pending && !rank_pending) {
+        return;
+    }
+    sem_lock(sem_id);
+    if (ctrl_pending) {
+        ctrl_published += control_publish(shared_data);
+    }
+    if (rank_pending) {
+        zone_ranker_publish(ranker, &shared_data->zones, &shared_data->rank[shard_id - 1], 0);
+    }
+    sem_unlock(sem_id);
+    ctrl_pending = rank_pending = 0;
+}
+
+/* ============================================================================
+ * 함수: run_event_loop
+ * 설명: 종료 시그널 또는 shutdown 명령까지 이벤트 처리
+ * ============================================================================ */
+static void run_event_loop() {
+    struct epoll_event events[MAX_EVENTS];
+    uint64_t expirations;
+
+    // 서버 시작 전에 쌓인 메시지 처리 (edge 성격 통지 대비)
+    drain_transport();
+
+    unsigned long handled = msgs_received;
+
+    while (loop_running) {
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("[SERVER] epoll_wait 실패");
+            break;
+        }
+        proc_heartbeat(shared_data, proc_slot, msgs_received - handled);
+        handled = msgs_received;
+        for (int i = 0; i < n; i++) {
+            uint32_t kind = (uint32_t)(events[i].data.u64 >> 32);
+            int fd = (int)(uint32_t)events[i].data.u64;
+
+            switch (kind) {
+                case EV_SIGNAL: {
+                    struct signalfd_siginfo si;
+                    if (read(signal_fd, &si, sizeof(si)) == sizeof(si)) {
+                        printf("\n[SERVER] 시그널 %d 수신\n", si.ssi_signo);
+                        keep_state = (si.ssi_signo == SIGQUIT);
+                        loop_running = 0;
+                    }
+                    break;
+                }
+                case EV_TRANSPORT:
+                    drain_transport();
+                    break;
+                case EV_DRAIN_TIMER:
+                    if (read(fd, &expirations, sizeof(expirations)) > 0) {
+                        drain_transport();
+                    }
+                    break;
+                case EV_HEARTBEAT_TIMER:
+                    if (read(fd, &expirations, sizeof(expirations)) <= 0) {
+                        break;
+                    }
+                    int monitored = 0;
+                    if (shard_id == 1) {
+                        __atomic_store_n(&shared_data->hdr.heartbeat_ns, monotonic_ns(),
+                                         __ATOMIC_RELEASE);
+                        monitored = check_liveness();
+                    } else if (!__atomic_load_n(&shared_data->system_running, __ATOMIC_ACQUIRE)) {
+                        // 1번 샤드의 시스템 종료 알림 → 다른 프로세스와 함께 종료
+                        printf("[SERVER] 1번 샤드 종료 알림 수신\n");
+                        loop_running = 0;
+                    }
+                    if (shed.active) {
+                        drain_transport();  // 수신이 끊겨도 복귀 조건 평가
+                    }
+                    heartbeat_retune(monitored);
+                    break;
+                case EV_CHECKPOINT_TIMER:
+                    if (read(fd, &expirations, sizeof(expirations)) > 0) {
+                        save_checkpoint();
+                    }
+                    break;
+                case EV_ALERT_TIMER:
+                    if (read(fd, &expirations, sizeof(expirations)) > 0) {
+                        check_alerts();
+                    }
+                    break;
+                case EV_CONTROL_LISTEN:
+                    control_accept();
+                    break;
+                case EV_CONTROL_CLIENT:
+                    control_read(fd);
+                    break;
+            }
+        }
+        publish_state();
+    }
+}
+
+/* ============================================================================
+ * 함수: notify_shutdown
+ * 설명: 모든 프로세스에 종료 알림
+ *       - futex 브로드캐스트: shutdown_wait로 쉬고 있는 센서/액추에이터가 즉시 깨어남
+ *       - SIGUSR1: 주기 없이 입력을 기다리는 프로세스(모니터)의 select를 깨움
+ * ============================================================================ */
+static void notify_shutdown() {
+    sem_lock(sem_id);
+    shutdown_broadcast(shared_data);
+    sem_unlock(sem_id);
+
+    for (int i = 0; i < MAX_PROCS; i++) {
+        const ProcSlot *s = &shared_data->procs[i];
+        pid_t pid = __atomic_load_n(&s->pid, __ATOMIC_ACQUIRE);
+        if (pid > 0 && s->role == PROC_ROLE_MONITOR) {
+            kill(pid, SIGUSR1);
+        }
+    }
+}
+
+/* ============================================================================
+ * 함수: count_attached
+ * 설명: 아직 등록 해제하지 않은 다른 프로세스 수 (서버 자신, 로그 자식, 이미 죽은 PID 제외)
+ * ============================================================================ */
+static int count_attached() {
+    int n = 0;
+    for (int i = 0; i < MAX_PROCS; i++) {
+        pid_t pid = __atomic_load_n(&shared_data->procs[i].pid, __ATOMIC_ACQUIRE);
+        if (pid > 0 && pid != getpid() && pid != logger_pid && pid_alive(pid)) {
+            n++;
+        }
+    }
+    return n;
+}
+
+/* ============================================================================
+ * 함수: wait_detach_barrier
+ * 설명: 종료 확인 배리어 - 모든 프로세스가 등록 해제할 때까지 detach_seq futex에서 대기
+ *       (등록 해제마다 깨어나 다시 센다, 최대 SHUTDOWN_TIMEOUT_MS)
+ * 반환: 남은 프로세스 수 (0=모두 종료 확인)
+ * ============================================================================ */
+static int wait_detach_barrier() {
+    uint64_t deadline = monotonic_ns() + (uint64_t)SHUTDOWN_TIMEOUT_MS * 1000000ull;
+    for (;;) {
+        int seq = __atomic_load_n(&shared_data->detach_seq, __ATOMIC_ACQUIRE);
+        int remaining = count_attached();
+        uint64_t now = monotonic_ns();
+        if (remaining == 0 || now >= deadline) {
+            return remaining;
+        }
+        // 좀비/비정상 종료로 ack가 오지 않는 경우도 있으므로 최대 50ms마다 다시 확인
+        int wait_ms = (int)((deadline - now) / 1000000ull);
+        futex_wait(&shared_data->detach_seq, seq, wait_ms < 50 ? wait_ms : 50);
     }
-    
-    printf("[THREAD] 경고 모니터링 스레드 종료\n");
-    return NULL;
 }
 
 /* ============================================================================
  * 함수: cleanup_resources
  * 설명: IPC 자원 정리 (프로그램 종료 시 호출)
+ *       keep_state=1 이면 다른 프로세스에 종료를 알리지 않고 공유 메모리/세마포어/
+ *       메시지 채널을 남겨 둠 → 다음 서버가 웜 재시작으로 이어받음
  * ============================================================================ */
 void cleanup_resources() {
-    printf("\n[SERVER:%d] 시스템 종료 시작...\n", getpid());
+    uint64_t t_begin = monotonic_ns();
+    printf("\n[SERVER:%d] %s 시작...\n", getpid(),
+           keep_state ? "상태 유지 종료" : "시스템 종료");
+    if (perf.enabled) {
+        char summary[400];
+        perfctr_format(&perf, summary, sizeof(summary));
+        printf("[PERF] %s\n", summary);
+        perfctr_close(&perf);
+    }
+    zone_ranker_destroy(ranker);
+    ranker = NULL;
 
-    // 1. 스레드 종료
-    thread_running = 0;
-    pthread_join(alert_thread, NULL);
-    printf("[SERVER] 경고 스레드 종료 완료\n");
+    // 1. 이벤트 소스 닫기 (제어 소켓 파일 삭제)
+    if (control_fd != -1) {
+        close(control_fd);
+        unlink(control_path);
+    }
+    if (alert_timer_fd != -1) close(alert_timer_fd);
+    if (heartbeat_timer_fd != -1) close(heartbeat_timer_fd);
+    if (drain_timer_fd != -1) close(drain_timer_fd);
+    if (ckpt_timer_fd != -1) close(ckpt_timer_fd);
+    if (signal_fd != -1) close(signal_fd);
+    if (epoll_fd != -1) close(epoll_fd);
 
-    // 2. 다른 프로세스들에게 종료 신호 전송
-    if (shared_data != NULL) {
-        sem_lock(sem_id);
-        shared_data->system_running = 0;
-        sem_unlock(sem_id);
+    // 2. 다른 프로세스들에게 종료 알림 (브로드캐스트, 1번 샤드만)
+    if (shared_data != NULL && !keep_state && shard_id == 1) {
+        notify_shutdown();
         printf("[SERVER] 종료 신호 전송 완료\n");
-        sleep(1);
     }
 
     // 3. 파이프 닫기 (자식 프로세스 종료 유도)
@@ -165,25 +1362,84 @@ void cleanup_resources() {
         printf("[SERVER] 파이프 닫기 완료\n");
     }
 
-    // 4. 자식 프로세스 종료 대기
+    // 4. 종료 확인 배리어 및 자식 프로세스 종료 대기
+    if (shared_data != NULL && !keep_state && shard_id == 1) {
+        int remaining = wait_detach_barrier();
+        if (remaining > 0) {
+            printf("[SERVER] ⚠️  %d개 프로세스가 %dms 안에 응답하지 않음 - 자원 정리 진행\n",
+                   remaining, SHUTDOWN_TIMEOUT_MS);
+        } else {
+            printf("[SERVER] 모든 프로세스 종료 확인 (%.1f ms)\n",
+                   (monotonic_ns() - t_begin) / 1e6);
+        }
+    }
     if (logger_pid > 0) {
         int status;
         waitpid(logger_pid, &status, 0);
         printf("[SERVER] 로그 프로세스(PID:%d) 종료 완료\n", logger_pid);
     }
 
-    // 5. 공유 메모리 분리
+    // 5. 등록 해제 및 마지막 체크포인트
     if (shared_data != NULL) {
-        shmdt(shared_data);
+        proc_unregister(shared_data, sem_id, proc_slot);
+    }
+    if (ckpt_enabled) {
+        save_checkpoint();
+        checkpoint_close(&ckpt);
+        printf("[SERVER] 체크포인트 저장 완료 (seq %llu)\n", (unsigned long long)ckpt.seq);
+    }
+
+    // 2번 이후 샤드: 라우팅 항목과 자기 채널만 정리 (공유 자원은 1번 샤드 소유)
+    if (shard_id > 1) {
+        if (shared_data != NULL) {
+            sem_lock(sem_id);
+            if (shared_data->shards[shard_id - 1].pid == getpid()) {
+                shared_data->shards[shard_id - 1].pid = 0;
+            }
+            sem_unlock(sem_id);
+        }
+        if (transport != NULL) {
+            if (transport_kind_from_env() == TRANSPORT_SYSV) {
+                transport_close(transport);     // 큐는 모든 샤드가 공유
+                transport_close(urgent);
+            } else {
+                transport_destroy(transport);
+                transport_destroy(urgent);
+            }
+            transport = urgent = NULL;
+        }
+        shm_store_close(&shm);
+        shared_data = NULL;
+        printf("[SERVER] 샤드 %d 분리 완료 (%.1f ms)\n", shard_id, (monotonic_ns() - t_begin) / 1e6);
+        return;
+    }
+
+    if (keep_state) {
+        if (shared_data != NULL) {
+            sem_lock(sem_id);
+            shared_data->hdr.server_pid = 0;
+            shared_data->shards[0].pid = 0;
+            sem_unlock(sem_id);
+        }
+        transport_close(urgent);
+        transport_close(transport);
+        transport = urgent = NULL;
+        shm_store_close(&shm);
+        shared_data = NULL;
+        printf("[SERVER] IPC 자원 유지 - ./bin/server 로 웜 재시작 가능\n");
+        return;
     }
 
     // 6. IPC 자원 삭제
-    if (msg_queue_id != -1) {
-        msgctl(msg_queue_id, IPC_RMID, NULL);
+    if (transport != NULL) {
+        transport_destroy(urgent);
+        transport_destroy(transport);
+        transport = urgent = NULL;
         printf("[SERVER] 메시지 큐 삭제 완료\n");
     }
-    if (shm_id != -1) {
-        shmctl(shm_id, IPC_RMID, NULL);
+    if (shm.data != NULL) {
+        shm_store_destroy(&shm);
+        shared_data = NULL;
         printf("[SERVER] 공유 메모리 삭제 완료\n");
     }
     if (sem_id != -1) {
@@ -191,17 +1447,7 @@ void cleanup_resources() {
         printf("[SERVER] 세마포어 삭제 완료\n");
     }
 
-    printf("[SERVER] 모든 자원 정리 완료\n");
-}
-
-/* ============================================================================
- * 함수: signal_handler
- * 설명: SIGINT/SIGTERM 처리 - 안전한 종료
- * ============================================================================ */
-void signal_handler(int signo) {
-    (void)signo;
-    cleanup_resources();
-    exit(0);
+    printf("[SERVER] 모든 자원 정리 완료 (%.1f ms)\n", (monotonic_ns() - t_begin) / 1e6);
 }
 
 /* ============================================================================
@@ -217,13 +1463,293 @@ void print_system_info() {
         printf("  아키텍처: %s\n", sys_info.machine);
     }
     printf("  서버 PID: %d\n", getpid());
+    if (shard_count > 1) {
+        printf("  샤드: %d/%d (구역 %d~%d)\n", shard_id, shard_count, zone_lo, zone_hi - 1);
+    }
+    printf("  빌드: %s\n", SMARTFARM_BUILD);
     printf("\n");
 }
 
+/* ============================================================================
+ * 함수: init_shared_state
+ * 설명: 공유 메모리 초기화 또는 채택
+ *       - 웜 재시작: 헤더가 유효하면 임계값/구역 상태를 그대로 사용
+ *       - 복원: 공유 메모리가 새로 만들어졌으면 마지막 체크포인트를 복사
+ *               (프로세스 등록 테이블은 이전 부팅의 PID이므로 비움)
+ *       - 콜드 시작: 전체를 초기값으로 채운 뒤 마지막에 magic 기록
+ * 반환: START_WARM / START_RESTORED / START_COLD
+ * ============================================================================ */
+static int init_shared_state(int force_cold, time_t *restored_at) {
+    int mode = START_COLD;
+    sem_lock(sem_id);
+    if (!force_cold && shared_header_valid(shared_data)) {
+        mode = START_WARM;
+    } else if (!force_cold && ckpt_enabled &&
+               checkpoint_load(&ckpt, shared_data, restored_at) == 0) {
+        mode = START_RESTORED;
+        memset(shared_data->procs, 0, sizeof(shared_data->procs));
+    } else {
+        memset(shared_data, 0, sizeof(SharedData));
+        shared_data->temp_threshold = 28;
+        shared_data->humidity_threshold = 70;
+        for (int z = 0; z < MAX_ZONES; z++) {
+            shared_data->zones.current_temp[z] = 25.0;
+            shared_data->zones.current_humidity[z] = 50.0;
+            control_put(shared_data, CTRL_LED, z, 1);
+        }
+        shared_data->hdr.version = SHARED_VERSION;
+        shared_data->hdr.size = sizeof(SharedData);
+        __atomic_store_n(&shared_data->hdr.magic, SHARED_MAGIC, __ATOMIC_RELEASE);
+    }
+    if (mode != START_COLD) {
+        // 이전 서버가 링/이력 기록 도중 죽었으면 seq가 홀수로 남아 있음 (색인은 등록 중 죽은 센서)
+        for (int z = 0; z < MAX_ZONES; z++) {
+            zone_ring_repair(&shared_data->recent[z]);
+            zone_hist_repair(&shared_data->hist[z]);
+        }
+        sensor_index_repair(&shared_data->sensors);
+        for (int i = 0; i < MAX_SHARDS; i++) {
+            zone_rank_repair(&shared_data->rank[i]);
+        }
+    }
+    // 게시 상태를 현재 제어 상태에 맞추고 전체 다시 읽기 세대 게시 (콜드: 초기 LED 상태)
+    control_repair(shared_data);
+    shared_data->system_running = 1;
+    shared_data->server_ready = 0;
+    shared_data->hdr.generation++;
+    shared_data->hdr.server_pid = getpid();
+    shared_data->hdr.heartbeat_ns = monotonic_ns();
+    shared_data->hdr.heartbeat_period_ms = HEARTBEAT_INTERVAL_MS;
+    sem_unlock(sem_id);
+    return mode;
+}
+
+/* ============================================================================
+ * 함수: publish_routes
+ * 설명: 라우팅 테이블 기록 (1번 샤드: 전체 범위 + 자기 pid, 그 외: 자기 pid만)
+ *       1번 샤드는 살아 있는 다른 샤드의 pid는 유지하고 죽은 샤드의 pid는 비움
+ *       (웜 재시작/체크포인트 복원으로 이전 pid가 남아 있을 수 있음)
+ * ============================================================================ */
+static void publish_routes() {
+    sem_lock(sem_id);
+    if (shard_id == 1) {
+        for (int i = 0; i < MAX_SHARDS; i++) {
+            ShardRoute *r = &shared_data->shards[i];
+            if (i < shard_count) {
+                shard_range(i + 1, shard_count, &r->lo, &r->hi);
+            } else {
+                r->lo = r->hi = 0;
+            }
+            if (i >= shard_count || (r->pid > 0 && !pid_alive(r->pid))) {
+                r->pid = 0;
+            }
+        }
+        __atomic_store_n(&shared_data->shard_count, shard_count, __ATOMIC_RELEASE);
+    }
+    shared_data->shards[shard_id - 1].pid = getpid();
+    sem_unlock(sem_id);
+}
+
+/* ============================================================================
+ * 함수: attach_shard
+ * 설명: 2번 이후 샤드 - 1번 샤드가 만든 공유 메모리/세마포어에 연결
+ *       샤드 개수가 1번 샤드와 다르거나 같은 번호의 샤드가 실행 중이면 실패
+ * 반환: 0=성공, -1=실패
+ * ============================================================================ */
+static int attach_shard() {
+    if (shm_store_open(&shm, 0) == -1 || !shared_header_valid(shm.data)) {
+        fprintf(stderr, "[SERVER] 1번 샤드의 공유 메모리가 없습니다 (1번 샤드를 먼저 실행하세요)\n");
+        return -1;
+    }
+    shared_data = shm.data;
+    sem_id = semget(ipc_key(SEM_KEY), 1, 0666);
+    if (sem_id == -1) {
+        perror("[SERVER] 세마포어 연결 실패");
+        return -1;
+    }
+    int count = __atomic_load_n(&shared_data->shard_count, __ATOMIC_ACQUIRE);
+    if (count != shard_count) {
+        fprintf(stderr, "[SERVER] 샤드 개수 불일치: 1번 샤드 %d개, 요청 %d개\n", count, shard_count);
+        return -1;
+    }
+    pid_t other = shared_data->shards[shard_id - 1].pid;
+    if (other > 0 && other != getpid() && pid_alive(other)) {
+        fprintf(stderr, "[SERVER] 샤드 %d가 이미 실행 중입니다 (PID: %d)\n", shard_id, other);
+        return -1;
+    }
+    printf("[SERVER] 1번 샤드 자원 연결 완료 (세대 %u, 세마포어 ID: %d)\n",
+           shared_data->hdr.generation, sem_id);
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: acquire_leader_lock
+ * 설명: 리더 잠금 파일에 배타적 flock (논블로킹)
+ *       프로세스가 어떻게 종료되든 커널이 해제하므로 주 서버 판별에 사용
+ * 반환: 잠금 fd, 다른 서버가 보유 중이면 -1
+ * ============================================================================ */
+static int acquire_leader_lock() {
+    char path[108];
+    if (shard_id == 1) {
+        snprintf(path, sizeof(path), LEADER_LOCK_FMT, instance_name());
+    } else {
+        snprintf(path, sizeof(path), SHARD_LOCK_FMT, instance_name(), shard_id);
+    }
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd == -1) {
+        return -1;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int pidfd_open_compat(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/* ============================================================================
+ * 함수: run_standby
+ * 설명: 대기 서버 모드 - 공유 메모리를 읽기 전용으로 연결하고 주 서버 감시
+ *       - 주 서버 PID의 pidfd: 종료 즉시 읽기 가능 (크래시 감지 지연 ≈ 0)
+ *       - 하트비트: FAILOVER_MS 이상 갱신이 없으면 멈춘 것으로 판단하고
+ *         SIGKILL로 격리(fencing)한 뒤 인계 (두 서버가 동시에 제어하지 않도록)
+ *       - 주 서버가 정상 종료(system_running=0)하면 대기 서버도 종료
+ * 반환: 0=인계 시작 (리더 잠금 획득), -1=종료
+ * ============================================================================ */
+static int run_standby(uint64_t *detected_ns) {
+    const char *env = getenv(FAILOVER_ENV);
+    int failover_ms = (env != NULL && atoi(env) > 0) ? atoi(env) : FAILOVER_MS;
+    ShmHandle ro;
+
+    printf("[STANDBY] 대기 서버 시작 (PID: %d, 장애 조치 기준: 하트비트 %dms 정지)\n",
+           getpid(), failover_ms);
+
+    // 주 서버가 공유 메모리를 초기화할 때까지 대기
+    while (shm_store_open(&ro, SHM_STORE_RDONLY) == -1 || !shared_header_valid(ro.data)) {
+        shm_store_close(&ro);
+        usleep(HEARTBEAT_INTERVAL_MS * 1000);
+    }
+    const SharedData *sd = ro.data;
+    printf("[STANDBY] 공유 메모리 읽기 전용 연결 완료\n");
+
+    uint32_t gen = 0;
+    pid_t pid = -1;
+    int pidfd = -1;
+    for (;;) {
+        // 주 서버 교체(웜 재시작, 다른 대기 서버의 인계) 추적
+        uint32_t g = __atomic_load_n(&sd->hdr.generation, __ATOMIC_ACQUIRE);
+        pid_t p = __atomic_load_n(&sd->hdr.server_pid, __ATOMIC_ACQUIRE);
+        if (g != gen || p != pid) {
+            gen = g;
+            pid = p;
+            if (pidfd != -1) close(pidfd);
+            pidfd = (pid > 0) ? pidfd_open_compat(pid) : -1;
+            if (pid > 0) {
+                printf("[STANDBY] 주 서버 PID %d 감시 (세대 %u)\n", pid, gen);
+            }
+        }
+
+        struct pollfd pfd = { .fd = pidfd, .events = POLLIN };
+        int exited = poll(&pfd, 1, HEARTBEAT_INTERVAL_MS) > 0;
+        uint64_t now = monotonic_ns();
+        uint64_t hb = __atomic_load_n(&sd->hdr.heartbeat_ns, __ATOMIC_ACQUIRE);
+        uint64_t age_ms = (now > hb) ? (now - hb) / 1000000ull : 0;
+
+        // 유휴 주 서버는 하트비트를 HEARTBEAT_IDLE_MS로 늦추므로 게시된 주기의 2배까지 기다림
+        uint64_t limit_ms = (uint64_t)failover_ms;
+        uint64_t period_ms = __atomic_load_n(&sd->hdr.heartbeat_period_ms, __ATOMIC_ACQUIRE);
+        if (period_ms * 2 > limit_ms) {
+            limit_ms = period_ms * 2;
+        }
+
+        int dead = exited || pid <= 0 || !pid_alive(pid);
+        int stale = age_ms >= limit_ms;
+        if (!dead && !stale) {
+            continue;
+        }
+        if (!__atomic_load_n(&sd->system_running, __ATOMIC_ACQUIRE)) {
+            printf("[STANDBY] 주 서버 정상 종료 - 대기 서버 종료\n");
+            break;
+        }
+        if (!dead) {
+            printf("[STANDBY] 주 서버 PID %d 하트비트 %llums 정지 → SIGKILL로 격리\n",
+                   pid, (unsigned long long)age_ms);
+            kill(pid, SIGKILL);
+            for (int i = 0; i < 100 && pid_alive(pid); i++) {
+                usleep(10000);
+            }
+        }
+
+        leader_fd = acquire_leader_lock();
+        if (leader_fd == -1) {
+            // 주 서버가 아직 종료 중이거나 다른 대기 서버가 먼저 인계함
+            continue;
+        }
+        *detected_ns = now;
+        printf("[STANDBY] 주 서버 %s 감지 (마지막 하트비트 %llums 전) → 인계 시작\n",
+               dead ? "종료" : "정지", (unsigned long long)age_ms);
+        if (pidfd != -1) close(pidfd);
+        shm_store_close(&ro);
+        return 0;
+    }
+
+    if (pidfd != -1) close(pidfd);
+    shm_store_close(&ro);
+    return -1;
+}
+
 /* ============================================================================
  * 메인 함수
+ * 사용법: ./bin/server [--cold | --standby] [--shard <번호>/<개수>]
  * ============================================================================ */
-int main() {
+int main(int argc, char *argv[]) {
+    struct timespec t_start, t_ready;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+
+    int force_cold = 0, standby = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cold") == 0) {
+            force_cold = 1;
+        } else if (strcmp(argv[i], "--standby") == 0) {
+            standby = 1;
+        } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc &&
+                   sscanf(argv[++i], "%d/%d", &shard_id, &shard_count) == 2 &&
+                   shard_count >= 1 && shard_count <= MAX_SHARDS &&
+                   shard_id >= 1 && shard_id <= shard_count) {
+            shard_range(shard_id, shard_count, &zone_lo, &zone_hi);
+        } else {
+            fprintf(stderr, "사용법: %s [--cold | --standby] [--shard <번호>/<개수> (최대 %d개)]\n",
+                    argv[0], MAX_SHARDS);
+            exit(1);
+        }
+    }
+    if (shard_id > 1 && (standby || force_cold)) {
+        fprintf(stderr, "[SERVER] --standby/--cold 는 1번 샤드에서만 사용할 수 있습니다\n");
+        exit(1);
+    }
+
+    // 대기 서버: 주 서버가 사라질 때까지 감시만 하고, 인계 시점부터 일반 시작 경로
+    if (standby) {
+        uint64_t detected_ns;
+        if (run_standby(&detected_ns) == -1) {
+            return 0;
+        }
+        t_start.tv_sec = (time_t)(detected_ns / 1000000000ull);
+        t_start.tv_nsec = (long)(detected_ns % 1000000000ull);
+    } else if ((leader_fd = acquire_leader_lock()) == -1) {
+        fprintf(stderr, "[SERVER] 이미 실행 중인 서버가 있습니다 (대기 서버는 --standby)\n");
+        exit(1);
+    }
+
     printf("==================================================\n");
     printf("  가상 스마트팜 중앙 서버 [P3] 시작\n");
     printf("==================================================\n");
@@ -231,61 +1757,121 @@ int main() {
     // 시스템 정보 출력
     print_system_info();
 
-    // 시그널 핸들러 등록
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    // 종료 시그널 차단 → 이벤트 루프에서 signalfd로 수신
+    // (fork 전에 차단하므로 로그 프로세스도 상속: 시그널 대신 파이프 EOF로 종료)
+    // SIGQUIT(Ctrl+\)은 상태 유지 종료
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGQUIT);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    start_time = time(NULL);
 
     // ========================================================================
-    // IPC 자원 생성
+    // IPC 자원 생성 (기존 자원이 있으면 연결)
     // ========================================================================
-    printf("[SERVER] IPC 자원 생성 중...\n");
+    printf("[SERVER] IPC 자원 %s 중...\n", shard_id == 1 ? "생성" : "연결");
 
-    msg_queue_id = msgget(MSG_KEY_DATA, 0666 | IPC_CREAT);
-    if (msg_queue_id == -1) {
-        perror("[SERVER] 메시지 큐 생성 실패");
-        exit(1);
-    }
-    printf("[SERVER] 메시지 큐 생성 완료 (ID: %d)\n", msg_queue_id);
+    if (shard_id > 1) {
+        if (attach_shard() == -1) {
+            exit(1);
+        }
+    } else {
+        if (shm_store_open(&shm, SHM_STORE_CREATE) == -1) {
+            perror("[SERVER] 공유 메모리 생성 실패");
+            exit(1);
+        }
+        shared_data = shm.data;
+        char shm_desc[256];
+        shm_store_describe(&shm, shm_desc, sizeof(shm_desc));
+        printf("[SERVER] 공유 메모리 생성 완료 (%s)\n", shm_desc);
 
-    shm_id = shmget(SHM_KEY, sizeof(SharedData), 0666 | IPC_CREAT);
-    if (shm_id == -1) {
-        perror("[SERVER] 공유 메모리 생성 실패");
-        exit(1);
+        // 같은 인스턴스의 서버가 이미 실행 중이면 자원을 건드리지 않고 종료
+        pid_t other = shared_header_valid(shared_data) ? shared_data->hdr.server_pid : 0;
+        if (other > 0 && other != getpid() && pid_alive(other)) {
+            fprintf(stderr, "[SERVER] 이미 실행 중인 서버가 있습니다 (PID: %d)\n", other);
+            shm_store_close(&shm);
+            exit(1);
+        }
+
+        // 세마포어: 새로 만든 경우에만 초기화 (웜 재시작 시 기존 값 유지)
+        int sem_new = 1;
+        sem_id = semget(ipc_key(SEM_KEY), 1, 0666 | IPC_CREAT | IPC_EXCL);
+        if (sem_id == -1 && errno == EEXIST) {
+            sem_new = 0;
+            sem_id = semget(ipc_key(SEM_KEY), 1, 0666);
+        }
+        if (sem_id == -1) {
+            perror("[SERVER] 세마포어 생성 실패");
+            exit(1);
+        }
+        printf("[SERVER] 세마포어 %s (ID: %d)\n", sem_new ? "생성 완료" : "연결 완료", sem_id);
+
+        if (sem_new || force_cold) {
+            union semun sem_union;
+            sem_union.val = 1;
+            semctl(sem_id, 0, SETVAL, sem_union);
+        }
     }
-    printf("[SERVER] 공유 메모리 생성 완료 (ID: %d)\n", shm_id);
 
-    sem_id = semget(SEM_KEY, 1, 0666 | IPC_CREAT);
-    if (sem_id == -1) {
-        perror("[SERVER] 세마포어 생성 실패");
+    // 샤드 채널: System V는 1번 샤드가 만든 큐를 공유(msgrcv 타입 = 샤드 번호),
+    //           그 외 전송 방식은 샤드마다 자기 채널 생성
+    TransportKind kind = transport_kind_from_env();
+    int shared_queue = (kind == TRANSPORT_SYSV);
+    transport = transport_open(kind, shard_channel_key(shard_id, shared_queue),
+                               (shard_id == 1 || !shared_queue) ? TRANSPORT_CREATE : 0);
+    if (transport == NULL) {
+        perror("[SERVER] 메시지 큐 생성 실패");
         exit(1);
     }
-    printf("[SERVER] 세마포어 생성 완료 (ID: %d)\n", sem_id);
+    printf("[SERVER] 메시지 큐 %s 완료 (전송 방식: %s)\n",
+           (shard_id == 1 || !shared_queue) ? "생성" : "연결", transport_kind_name(kind));
 
-    shared_data = (SharedData *)shmat(shm_id, NULL, 0);
-    if (shared_data == (void *)-1) {
-        perror("[SERVER] 공유 메모리 연결 실패");
+    // 긴급 채널: 데이터 채널과 같은 방식 (System V는 긴급 큐 하나를 긴급 타입으로 나눠 씀)
+    urgent = transport_open(kind, shard_urgent_key(shard_id, shared_queue),
+                            (shard_id == 1 || !shared_queue) ? TRANSPORT_CREATE : 0);
+    if (urgent == NULL) {
+        perror("[SERVER] 긴급 채널 생성 실패");
         exit(1);
     }
 
-    // 세마포어 초기화
-    union semun sem_union;
-    sem_union.val = 1;
-    semctl(sem_id, 0, SETVAL, sem_union);
+    // 체크포인트 파일 (공유 메모리가 없을 때 복원 + 주기 저장) - 1번 샤드만
+    char ckpt_path[256];
+    if (shard_id == 1 && checkpoint_default_path(ckpt_path, sizeof(ckpt_path)) == 0) {
+        ckpt_enabled = (checkpoint_open(&ckpt, ckpt_path) == 0);
+        if (!ckpt_enabled) {
+            perror("[SERVER] 체크포인트 파일 열기 실패 (체크포인트 비활성)");
+        }
+    }
 
-    // 공유 메모리 초기값 설정
-    sem_lock(sem_id);
-    shared_data->temp_threshold = 28;
-    shared_data->humidity_threshold = 70;
-    shared_data->heater_on = 0;
-    shared_data->fan_on = 0;
-    shared_data->led_on = 1;
-    shared_data->current_temp = 25.0;
-    shared_data->current_humidity = 50.0;
-    shared_data->system_running = 1;
-    sem_unlock(sem_id);
+    // 공유 메모리 초기값 설정 또는 이전 상태 채택
+    time_t restored_at = 0;
+    int mode = (shard_id == 1) ? init_shared_state(force_cold, &restored_at) : START_WARM;
+    publish_routes();
+    proc_slot = proc_register(shared_data, sem_id, PROC_ROLE_SERVER, -1, HEARTBEAT_INTERVAL_MS);
 
-    printf("[SERVER] 초기 설정 - 온도 임계값: %d°C, 습도 임계값: %d%%\n",
-           shared_data->temp_threshold, shared_data->humidity_threshold);
+    if (shard_id > 1) {
+        printf("[SERVER] 샤드 %d/%d - 구역 %d~%d 담당\n", shard_id, shard_count, zone_lo, zone_hi - 1);
+    } else if (mode == START_RESTORED) {
+        char when[32];
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&restored_at));
+        printf("[SERVER] 체크포인트 복원 (%s 저장분) - 온도 임계값 %d°C, 습도 임계값 %d%%\n",
+               when, shared_data->temp_threshold, shared_data->humidity_threshold);
+    } else if (mode == START_WARM) {
+        int zones = 0;
+        for (int z = 0; z < shared_data->active_zones; z++) {
+            if (shared_data->zones.last_update[z] != 0) zones++;
+        }
+        printf("[SERVER] 웜 재시작 (세대 %u) - 기존 상태 채택: 온도 임계값 %d°C, "
+               "습도 임계값 %d%%, 활성 구역 %d개\n",
+               shared_data->hdr.generation, shared_data->temp_threshold,
+               shared_data->humidity_threshold, zones);
+    } else {
+        printf("[SERVER] 초기 설정 - 온도 임계값: %d°C, 습도 임계값: %d%%\n",
+               shared_data->temp_threshold, shared_data->humidity_threshold);
+    }
 
     // ========================================================================
     // 파이프 생성 및 fork() - 로그 기록 자식 프로세스
@@ -313,68 +1899,43 @@ int main() {
     printf("[SERVER] 로그 프로세스 생성 완료 (PID: %d)\n", logger_pid);
 
     // ========================================================================
-    // pthread 생성 - 경고 모니터링 스레드
+    // 이벤트 루프: 센서 데이터 수신 → 제어 판단 → 파이프로 로그 전송
+    //             + 경고 타이머, 종료 시그널, 제어 명령
     // ========================================================================
-    printf("\n[SERVER] 경고 모니터링 스레드 생성 중...\n");
-
-    if (pthread_create(&alert_thread, NULL, alert_thread_func, NULL) != 0) {
-        perror("[SERVER] 스레드 생성 실패");
+    printf("\n[SERVER] 이벤트 루프 준비 중...\n");
+    if (setup_event_loop(&mask) == -1) {
+        perror("[SERVER] 이벤트 루프 생성 실패");
+        cleanup_resources();
         exit(1);
     }
-    printf("[SERVER] 경고 스레드 생성 완료\n");
-
-    // ========================================================================
-    // 메인 루프: 센서 데이터 수신 → 제어 판단 → 파이프로 로그 전송
-    // ========================================================================
-    printf("\n[SERVER] 메인 루프 시작 (Ctrl+C로 종료)\n");
-    printf("==================================================\n\n");
-
-    while (1) {
-        SensorDataMsg sensor_msg;
-
-        ssize_t result = msgrcv(msg_queue_id, &sensor_msg,
-                               sizeof(SensorDataMsg) - sizeof(long),
-                               MSG_TYPE_SENSOR_DATA, IPC_NOWAIT);
 
-        if (result != -1) {
-            // 임계값 읽기
-            sem_lock(sem_id);
-            int temp_thresh = shared_data->temp_threshold;
-            int hum_thresh = shared_data->humidity_threshold;
-            sem_unlock(sem_id);
-
-            printf("[SERVER] 센서 데이터 - 온도: %.2f°C, 습도: %.2f%%\n",
-                   sensor_msg.temperature, sensor_msg.humidity);
-
-            // 제어 로직
-            int new_heater = (sensor_msg.temperature < temp_thresh) ? 1 : 0;
-            int new_fan = (sensor_msg.humidity > hum_thresh) ? 1 : 0;
+    // 극값 순위 (담당 구역 범위, 첫 게시 때 공유 메모리의 기존 구역 상태로 채움)
+    ranker = zone_ranker_create(zone_lo, zone_hi);
+    if (ranker == NULL) {
+        perror("[SERVER] 극값 순위 생성 실패");
+        cleanup_resources();
+        exit(1);
+    }
 
-            // 공유 메모리에 상태 기록
-            sem_lock(sem_id);
-            shared_data->heater_on = new_heater;
-            shared_data->fan_on = new_fan;
-            shared_data->led_on = 1;
-            shared_data->current_temp = sensor_msg.temperature;
-            shared_data->current_humidity = sensor_msg.humidity;
-            sem_unlock(sem_id);
+    // 성능 카운터는 서버 프로세스 자신만 측정 (로그 자식 생성 이후에 열어 상속 없음)
+    perfctr_open(&perf);
+    trace_init(proc_slot, PROC_ROLE_SERVER, -1);
 
-            printf("[SERVER] 제어 명령 - 히터:%s, 팬:%s\n",
-                   new_heater ? "ON" : "OFF",
-                   new_fan ? "ON" : "OFF");
+    // 준비 완료 공개 (smartfarmd의 준비 배리어 - 1번 샤드 기준)
+    if (shard_id == 1) {
+        __atomic_store_n(&shared_data->server_ready, 1, __ATOMIC_RELEASE);
+    }
+    ready_announce(shared_data);
 
-            // 파이프로 로그 데이터 전송 (자식 프로세스에게)
-            LogMessage log_msg;
-            log_msg.temperature = sensor_msg.temperature;
-            log_msg.humidity = sensor_msg.humidity;
-            log_msg.heater_on = new_heater;
-            log_msg.fan_on = new_fan;
-            log_msg.timestamp = time(NULL);
-            write(pipe_fd[1], &log_msg, sizeof(LogMessage));
-        }
+    clock_gettime(CLOCK_MONOTONIC, &t_ready);
+    printf("\n[SERVER] 준비 완료: %.2f ms (%s)\n",
+           (t_ready.tv_sec - t_start.tv_sec) * 1e3 + (t_ready.tv_nsec - t_start.tv_nsec) / 1e6,
+           mode == START_WARM ? "웜 재시작" :
+           mode == START_RESTORED ? "체크포인트 복원" : "콜드 시작");
+    printf("[SERVER] 메인 루프 시작 (Ctrl+C 종료, Ctrl+\\ 상태 유지 종료)\n");
+    printf("==================================================\n\n");
 
-        sleep(1);
-    }
+    run_event_loop();
 
     cleanup_resources();
     return 0;
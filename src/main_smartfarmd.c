@@ -0,0 +1,445 @@
+/*
+ * ==============================================================================
+ * 파일명: main_smartfarmd.c
+ * 역할: 감독(supervisor) 프로세스 - 서버/센서/액추에이터를 한 번에 기동하고 감시
+ *
+ * 기술 요소:
+ *   - fork() + exec(): 같은 디렉토리의 bin/server, bin/sensor, bin/actuator 실행
+ *     (각 자식은 별도 프로세스 그룹, 출력은 logs/<이름>.log)
+ *   - 준비 배리어: 공유 메모리의 ready_seq futex에서 대기
+ *     → 서버는 이벤트 루프 준비 후, 클라이언트는 등록 직후 ready_seq를 올리고 깨움
+ *     → 고정 sleep 없이 "서버 준비 → 클라이언트 기동 → 전원 등록" 순서 보장
+ *   - signalfd(SIGCHLD/SIGINT/SIGTERM) + poll(): 자식 종료와 종료 요청을 한 루프에서 처리
+ *   - 재시작: 비정상 종료한 자식을 지수 백오프(100ms → 최대 5초)로 재기동
+ *     (10초 이상 정상 동작하면 백오프 초기화, 서버는 웜 재시작으로 상태를 이어받음)
+ *
+ * 실행: ./bin/smartfarmd [-s 센서수] [-a 액추에이터수] [-l 로그디렉토리]
+ *       - 구역 0..N-1 에 센서/액추에이터를 하나씩 배치 (기본: 센서 1, 액추에이터 1)
+ *       - Ctrl+C: 서버에 SIGINT 전달 → 서버의 종료 브로드캐스트로 전체 종료
+ *       - 모니터는 대화형이므로 별도 터미널에서 ./bin/monitor 실행
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/shm_store.h"
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <poll.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+
+#define MAX_CHILDREN        (2 * MAX_PROCS)
+#define LOG_DIR             "logs"
+#define READY_TIMEOUT_MS    5000    // 준비 배리어 최대 대기 시간
+#define BACKOFF_MIN_MS      100     // 첫 재시작 지연
+#define BACKOFF_MAX_MS      5000    // 최대 재시작 지연
+#define STABLE_RUN_MS       10000   // 이 시간 이상 동작 후 종료되면 백오프 초기화
+
+/* 감독 대상 자식 프로세스 */
+typedef struct {
+    const char *prog;           // 실행 파일 이름 (server/sensor/actuator)
+    char arg[16];               // 인자 (구역 번호, 서버는 빈 문자열)
+    char name[32];              // 표시/로그 파일 이름 (예: sensor.3)
+    pid_t pid;                  // 실행 중 PID (0=실행 중 아님)
+    int done;                   // 1=재시작하지 않음 (정상 종료)
+    int restarts;               // 재시작 횟수
+    int backoff_ms;             // 다음 재시작 지연
+    uint64_t started_ns;        // 마지막 기동 시각
+    uint64_t restart_at_ns;     // 재시작 예정 시각 (0=예정 없음)
+} Child;
+
+static Child children[MAX_CHILDREN];
+static int num_children = 0;
+static char bin_dir[PATH_MAX];
+static const char *log_dir = LOG_DIR;
+static sigset_t blocked;
+
+static ShmHandle shm;               // 준비 배리어 관찰용 (읽기 전용)
+static const SharedData *shared_data = NULL;
+
+static double elapsed_ms(uint64_t since) {
+    return (monotonic_ns() - since) / 1e6;
+}
+
+/* ============================================================================
+ * 함수: add_child
+ * ============================================================================ */
+static Child *add_child(const char *prog, int zone) {
+    Child *c = &children[num_children++];
+    memset(c, 0, sizeof(*c));
+    c->prog = prog;
+    c->backoff_ms = BACKOFF_MIN_MS;
+    if (zone >= 0) {
+        snprintf(c->arg, sizeof(c->arg), "%d", zone);
+        snprintf(c->name, sizeof(c->name), "%s.%d", prog, zone);
+    } else {
+        snprintf(c->name, sizeof(c->name), "%s", prog);
+    }
+    return c;
+}
+
+/* ============================================================================
+ * 함수: spawn_child
+ * 설명: fork() + exec() - 자식은 감독 프로세스의 시그널 마스크를 풀고,
+ *       별도 프로세스 그룹에서 출력만 로그 파일로 돌려 실행
+ * ============================================================================ */
+static int spawn_child(Child *c) {
+    char path[PATH_MAX + 16], log_path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", bin_dir, c->prog);
+    snprintf(log_path, sizeof(log_path), "%s/%s.log", log_dir, c->name);
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("[SMARTFARMD] fork 실패");
+        return -1;
+    }
+    if (pid == 0) {
+        sigprocmask(SIG_UNBLOCK, &blocked, NULL);
+        setpgid(0, 0);          // 터미널 Ctrl+C는 감독 프로세스만 받음
+        int in = open("/dev/null", O_RDONLY);
+        int out = open(log_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (in != -1) dup2(in, STDIN_FILENO);
+        if (out != -1) {
+            dup2(out, STDOUT_FILENO);
+            dup2(out, STDERR_FILENO);
+        }
+        if (c->arg[0] != '\0') {
+            execl(path, c->prog, c->arg, (char *)NULL);
+        } else {
+            execl(path, c->prog, (char *)NULL);
+        }
+        perror("[SMARTFARMD] exec 실패");
+        _exit(127);
+    }
+    c->pid = pid;
+    c->started_ns = monotonic_ns();
+    c->restart_at_ns = 0;
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: attach_shared
+ * 설명: 서버가 만든 공유 메모리에 읽기 전용으로 연결
+ *       세그먼트는 서버가 시작 직후 만들므로 1ms 간격으로 확인 (서버가 죽으면 중단)
+ * ============================================================================ */
+static int attach_shared(const Child *server, uint64_t deadline) {
+    shm_store_close(&shm);
+    shared_data = NULL;
+    while (monotonic_ns() < deadline) {
+        if (shm_store_open(&shm, SHM_STORE_RDONLY) == 0) {
+            if (shared_header_valid(shm.data)) {
+                shared_data = shm.data;
+                return 0;
+            }
+            shm_store_close(&shm);
+        }
+        if (!pid_alive(server->pid)) {
+            return -1;
+        }
+        usleep(1000);
+    }
+    return -1;
+}
+
+/* 자식이 준비되었는지: 서버는 이벤트 루프 준비 완료, 클라이언트는 등록 테이블에 존재 */
+static int child_ready(const Child *c) {
+    if (c->pid <= 0) {
+        return 1;
+    }
+    if (strcmp(c->prog, "server") == 0) {
+        return __atomic_load_n(&shared_data->hdr.server_pid, __ATOMIC_ACQUIRE) == c->pid &&
+               __atomic_load_n(&shared_data->server_ready, __ATOMIC_ACQUIRE);
+    }
+    for (int i = 0; i < MAX_PROCS; i++) {
+        if (__atomic_load_n(&shared_data->procs[i].pid, __ATOMIC_ACQUIRE) == c->pid) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: wait_ready
+ * 설명: 준비 배리어 - children[first..last) 가 모두 준비될 때까지 ready_seq futex 대기
+ *       (알림마다 깨어나 다시 확인, 자식이 먼저 죽는 경우에 대비해 최대 50ms마다 재확인)
+ * 반환: 0=전원 준비, -1=시간 초과
+ * ============================================================================ */
+static int wait_ready(int first, int last, uint64_t deadline) {
+    for (;;) {
+        int seq = __atomic_load_n(&shared_data->ready_seq, __ATOMIC_ACQUIRE);
+        int pending = 0;
+        for (int i = first; i < last; i++) {
+            if (!child_ready(&children[i]) && pid_alive(children[i].pid)) {
+                pending++;
+            }
+        }
+        uint64_t now = monotonic_ns();
+        if (pending == 0) {
+            return 0;
+        }
+        if (now >= deadline) {
+            return -1;
+        }
+        int wait_ms = (int)((deadline - now) / 1000000ull);
+        futex_wait((int *)&shared_data->ready_seq, seq, wait_ms < 50 ? wait_ms : 50);
+    }
+}
+
+/* ============================================================================
+ * 함수: start_server
+ * 설명: 서버 기동 → 공유 메모리 연결 → 서버 준비 대기
+ * ============================================================================ */
+static int start_server(Child *server) {
+    uint64_t t0 = monotonic_ns();
+    uint64_t deadline = t0 + (uint64_t)READY_TIMEOUT_MS * 1000000ull;
+    if (spawn_child(server) == -1 || attach_shared(server, deadline) == -1 ||
+        wait_ready(0, 1, deadline) == -1 || !child_ready(server)) {
+        fprintf(stderr, "[SMARTFARMD] 서버 준비 실패 (%s/%s.log 확인)\n", log_dir, server->name);
+        return -1;
+    }
+    printf("[SMARTFARMD] 서버 준비 완료 (PID %d, 세대 %u): %.2f ms\n",
+           server->pid, shared_data->hdr.generation, elapsed_ms(t0));
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: reap_children
+ * 설명: 종료된 자식 회수 → 재시작 예약 또는 완료 처리
+ *       - 서버가 정상 종료(0)하면 시스템 종료로 간주
+ *       - 클라이언트가 정상 종료(0)하면 서버의 종료 알림에 따른 것이므로 재시작하지 않음
+ * ============================================================================ */
+static void reap_children(int *shutting_down) {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (int i = 0; i < num_children; i++) {
+            Child *c = &children[i];
+            if (c->pid != pid) {
+                continue;
+            }
+            c->pid = 0;
+            int clean = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if (WIFSIGNALED(status)) {
+                printf("[SMARTFARMD] %s (PID %d) 시그널 %d로 종료\n", c->name, pid, WTERMSIG(status));
+            } else {
+                printf("[SMARTFARMD] %s (PID %d) 종료 (코드 %d)\n", c->name, pid, WEXITSTATUS(status));
+            }
+            if (clean || *shutting_down) {
+                c->done = 1;
+                if (i == 0 && !*shutting_down) {
+                    printf("[SMARTFARMD] 서버 정상 종료 - 전체 종료 대기\n");
+                    *shutting_down = 1;
+                }
+                break;
+            }
+            if (elapsed_ms(c->started_ns) >= STABLE_RUN_MS) {
+                c->backoff_ms = BACKOFF_MIN_MS;
+            }
+            c->restart_at_ns = monotonic_ns() + (uint64_t)c->backoff_ms * 1000000ull;
+            printf("[SMARTFARMD] %s %dms 후 재시작 예정\n", c->name, c->backoff_ms);
+            c->backoff_ms = (c->backoff_ms * 2 > BACKOFF_MAX_MS) ? BACKOFF_MAX_MS : c->backoff_ms * 2;
+            break;
+        }
+    }
+}
+
+/* ============================================================================
+ * 함수: restart_due
+ * 설명: 재시작 예정 시각이 지난 자식 재기동 (서버는 준비 배리어까지 확인)
+ * ============================================================================ */
+static void restart_due() {
+    uint64_t now = monotonic_ns();
+    for (int i = 0; i < num_children; i++) {
+        Child *c = &children[i];
+        if (c->restart_at_ns == 0 || c->restart_at_ns > now) {
+            continue;
+        }
+        c->restarts++;
+        if (i == 0) {
+            start_server(c);
+            continue;
+        }
+        uint64_t t0 = monotonic_ns();
+        if (spawn_child(c) == 0 && shared_data != NULL &&
+            wait_ready(i, i + 1, t0 + (uint64_t)READY_TIMEOUT_MS * 1000000ull) == 0) {
+            printf("[SMARTFARMD] %s 재시작 (PID %d, %d회째): %.2f ms\n",
+                   c->name, c->pid, c->restarts, elapsed_ms(t0));
+        }
+    }
+}
+
+/* 다음 재시작 예정까지 남은 시간 (ms, 예정 없으면 -1) */
+static int next_timeout_ms() {
+    uint64_t now = monotonic_ns(), next = 0;
+    for (int i = 0; i < num_children; i++) {
+        uint64_t t = children[i].restart_at_ns;
+        if (t != 0 && (next == 0 || t < next)) {
+            next = t;
+        }
+    }
+    if (next == 0) {
+        return -1;
+    }
+    return next <= now ? 0 : (int)((next - now) / 1000000ull) + 1;
+}
+
+/* 실행 중이거나 재시작 예정인 자식이 남아 있는지 */
+static int any_active() {
+    for (int i = 0; i < num_children; i++) {
+        if (children[i].pid > 0 || children[i].restart_at_ns != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: request_shutdown
+ * 설명: 서버에 SIGINT → 서버가 종료 브로드캐스트로 클라이언트를 정리
+ *       서버가 없는 상태(재시작 대기 중)면 클라이언트에 직접 SIGTERM
+ * ============================================================================ */
+static void request_shutdown() {
+    for (int i = 0; i < num_children; i++) {
+        children[i].restart_at_ns = 0;
+    }
+    if (children[0].pid > 0) {
+        kill(children[0].pid, SIGINT);
+        return;
+    }
+    for (int i = 1; i < num_children; i++) {
+        if (children[i].pid > 0) {
+            kill(children[i].pid, SIGTERM);
+        }
+    }
+}
+
+/* ============================================================================
+ * 메인 함수
+ * 사용법: ./bin/smartfarmd [-s 센서수] [-a 액추에이터수] [-l 로그디렉토리]
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    int sensors = 1, actuators = 1, opt;
+    while ((opt = getopt(argc, argv, "s:a:l:")) != -1) {
+        switch (opt) {
+            case 's': sensors = atoi(optarg); break;
+            case 'a': actuators = atoi(optarg); break;
+            case 'l': log_dir = optarg; break;
+            default:
+                fprintf(stderr, "사용법: %s [-s 센서수] [-a 액추에이터수] [-l 로그디렉토리]\n", argv[0]);
+                exit(1);
+        }
+    }
+    if (sensors < 0 || actuators < 0 || sensors > MAX_ZONES || actuators > MAX_ZONES ||
+        1 + sensors + actuators > MAX_CHILDREN || 1 + sensors + actuators > MAX_PROCS - 2) {
+        fprintf(stderr, "[SMARTFARMD] 프로세스 수가 너무 많습니다 (등록 테이블 %d칸)\n", MAX_PROCS);
+        exit(1);
+    }
+
+    // 실행 파일 위치 (/proc/self/exe 기준 같은 디렉토리)
+    char self[PATH_MAX];
+    ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (n <= 0) {
+        perror("[SMARTFARMD] 실행 파일 위치 확인 실패");
+        exit(1);
+    }
+    self[n] = '\0';
+    snprintf(bin_dir, sizeof(bin_dir), "%s", dirname(self));
+    mkdir(log_dir, 0755);
+
+    printf("==================================================\n");
+    printf("  가상 스마트팜 감독 프로세스 (smartfarmd) 시작\n");
+    printf("==================================================\n");
+    printf("  PID: %d, 인스턴스: %s\n", getpid(), instance_name());
+    printf("  센서 %d개, 액추에이터 %d개, 로그: %s/\n\n", sensors, actuators, log_dir);
+
+    // SIGCHLD/SIGINT/SIGTERM은 signalfd로 받음 (자식에서는 exec 전에 해제)
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGCHLD);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    sigprocmask(SIG_BLOCK, &blocked, NULL);
+    int sfd = signalfd(-1, &blocked, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (sfd == -1) {
+        perror("[SMARTFARMD] signalfd 실패");
+        exit(1);
+    }
+
+    add_child("server", -1);
+    for (int z = 0; z < sensors; z++) add_child("sensor", z);
+    for (int z = 0; z < actuators; z++) add_child("actuator", z);
+
+    // ========================================================================
+    // 순서 있는 기동: 서버 준비 → 클라이언트 동시 기동 → 전원 등록 확인
+    // ========================================================================
+    uint64_t t_start = monotonic_ns();
+    if (start_server(&children[0]) == -1) {
+        if (children[0].pid > 0) {
+            kill(children[0].pid, SIGKILL);
+            waitpid(children[0].pid, NULL, 0);
+        }
+        exit(1);
+    }
+    for (int i = 1; i < num_children; i++) {
+        spawn_child(&children[i]);
+    }
+    if (wait_ready(1, num_children, monotonic_ns() + (uint64_t)READY_TIMEOUT_MS * 1000000ull) == -1) {
+        fprintf(stderr, "[SMARTFARMD] ⚠️  일부 클라이언트가 준비되지 않음 (%s/ 로그 확인)\n", log_dir);
+    }
+    printf("[SMARTFARMD] 전체 준비 완료: %.2f ms (프로세스 %d개)\n",
+           elapsed_ms(t_start), num_children);
+    printf("[SMARTFARMD] 감시 시작 (Ctrl+C: 전체 종료, 모니터: ./bin/monitor)\n\n");
+
+    // ========================================================================
+    // 감시 루프: 자식 종료 → 백오프 재시작, 종료 요청 → 서버에 전달
+    // ========================================================================
+    int shutting_down = 0;
+    uint64_t t_shutdown = 0;
+    while (any_active()) {
+        struct pollfd pfd = { .fd = sfd, .events = POLLIN };
+        int rc = poll(&pfd, 1, shutting_down ? -1 : next_timeout_ms());
+        if (rc == -1 && errno != EINTR) {
+            perror("[SMARTFARMD] poll 실패");
+            break;
+        }
+        if (rc > 0) {
+            struct signalfd_siginfo si;
+            while (read(sfd, &si, sizeof(si)) == sizeof(si)) {
+                if (si.ssi_signo == SIGCHLD) {
+                    int was = shutting_down;
+                    reap_children(&shutting_down);
+                    if (!was && shutting_down) {
+                        t_shutdown = monotonic_ns();
+                        request_shutdown();
+                    }
+                } else if (!shutting_down) {
+                    printf("\n[SMARTFARMD] 시그널 %d 수신 - 전체 종료\n", si.ssi_signo);
+                    shutting_down = 1;
+                    t_shutdown = monotonic_ns();
+                    request_shutdown();
+                }
+                if (!any_active()) {
+                    break;
+                }
+            }
+        }
+        if (!shutting_down) {
+            restart_due();
+        }
+    }
+
+    int total_restarts = 0;
+    for (int i = 0; i < num_children; i++) {
+        total_restarts += children[i].restarts;
+    }
+    if (t_shutdown != 0) {
+        printf("[SMARTFARMD] 전체 종료 완료: %.2f ms\n", elapsed_ms(t_shutdown));
+    }
+    printf("[SMARTFARMD] 종료 (재시작 %d회)\n", total_restarts);
+    shm_store_close(&shm);
+    close(sfd);
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * ==============================================================================
+ * 파일명: main_tracedump.c
+ * 역할: 추적 링 병합 → Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+ *
+ * 기술 요소:
+ *   - 추적 공유 메모리를 읽기 전용으로 연결, 기록 중인 프로세스를 멈추지 않음
+ *   - 링 스냅샷: head 읽기 → 이벤트 복사 → head 다시 읽기
+ *     복사 도중 덮어써졌을 수 있는 가장 오래된 구간은 버림 (잠금 없는 일관성)
+ *   - 프로세스마다 process_name 메타데이터 + 구간 이벤트("X", 시작+길이)
+ *
+ * 사용법:
+ *   ./bin/tracedump [-o trace.json] [-c]
+ *     -o : 출력 파일 (기본 표준 출력)
+ *     -c : 덤프 후 추적 공유 메모리 삭제
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/trace.h"
+
+static TraceEvent snapshot[TRACE_RING_EVENTS];
+
+/* ============================================================================
+ * 함수: snapshot_ring
+ * 설명: 링의 유효 구간을 snapshot[]에 복사
+ * 반환: 복사된 이벤트 수 (snapshot[0]이 가장 오래된 것)
+ * ============================================================================ */
+static int snapshot_ring(const TraceRing *r) {
+    uint64_t h1 = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    uint64_t first = h1 > TRACE_RING_EVENTS ? h1 - TRACE_RING_EVENTS : 0;
+    for (uint64_t i = first; i < h1; i++) {
+        snapshot[i - first] = r->ev[i & (TRACE_RING_EVENTS - 1)];
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t h2 = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+
+    // 복사하는 동안 기록자가 [h1, h2] 를 썼다면 그만큼 오래된 슬롯이 덮어써졌을 수 있음
+    uint64_t safe = h2 + 1 > TRACE_RING_EVENTS ? h2 + 1 - TRACE_RING_EVENTS : 0;
+    if (safe <= first) {
+        return (int)(h1 - first);
+    }
+    if (safe >= h1) {
+        return 0;
+    }
+    memmove(snapshot, snapshot + (safe - first), (h1 - safe) * sizeof(TraceEvent));
+    return (int)(h1 - safe);
+}
+
+/* ============================================================================
+ * 메인 함수
+ * ============================================================================ */
+int main(int argc, char *argv[]) {
+    const char *out_path = NULL;
+    int clear = 0, opt;
+    while ((opt = getopt(argc, argv, "o:c")) != -1) {
+        switch (opt) {
+            case 'o': out_path = optarg; break;
+            case 'c': clear = 1; break;
+            default:
+                fprintf(stderr, "사용법: %s [-o trace.json] [-c]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    const TraceShm *ts = trace_attach_reader();
+    if (ts == NULL) {
+        perror("[TRACEDUMP] 추적 공유 메모리 연결 실패 (SMARTFARM_TRACE=1 로 실행했는지 확인)");
+        return 1;
+    }
+    FILE *out = stdout;
+    if (out_path != NULL && (out = fopen(out_path, "w")) == NULL) {
+        perror("[TRACEDUMP] 출력 파일 열기 실패");
+        trace_detach_reader(ts);
+        return 1;
+    }
+
+    // 타임라인 원점: 모든 링에서 가장 이른 이벤트
+    uint64_t origin = UINT64_MAX;
+    for (int i = 0; i < MAX_PROCS; i++) {
+        const TraceRing *r = &ts->ring[i];
+        if (r->pid == 0) continue;
+        int n = snapshot_ring(r);
+        if (n > 0 && snapshot[0].ts_ns < origin) {
+            origin = snapshot[0].ts_ns;
+        }
+    }
+    if (origin == UINT64_MAX) {
+        origin = 0;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    int first = 1, rings = 0;
+    long total = 0;
+    for (int i = 0; i < MAX_PROCS; i++) {
+        const TraceRing *r = &ts->ring[i];
+        pid_t pid = __atomic_load_n(&r->pid, __ATOMIC_ACQUIRE);
+        if (pid == 0) continue;
+        int n = snapshot_ring(r);
+        if (n == 0) continue;
+        rings++;
+
+        char label[64];
+        if (r->zone >= 0) {
+            snprintf(label, sizeof(label), "%s zone %d", proc_role_name(r->role), r->zone);
+        } else {
+            snprintf(label, sizeof(label), "%s", proc_role_name(r->role));
+        }
+        fprintf(out, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", (int)pid, label);
+        first = 0;
+        for (int k = 0; k < n; k++) {
+            const TraceEvent *e = &snapshot[k];
+            if (e->ts_ns < origin) continue;    // 원점 계산 뒤에 덮어써진 경우
+            fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"smartfarm\",\"ph\":\"X\",\"ts\":%.3f,"
+                         "\"dur\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"zone\":%d}}",
+                    trace_id_name(e->id), (e->ts_ns - origin) / 1000.0, e->dur_ns / 1000.0,
+                    (int)pid, (int)pid, e->zone);
+            total++;
+        }
+    }
+    fprintf(out, "\n]}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    trace_detach_reader(ts);
+    fprintf(stderr, "[TRACEDUMP] 프로세스 %d개, 이벤트 %ld개%s%s\n", rings, total,
+            out_path != NULL ? " → " : "", out_path != NULL ? out_path : "");
+
+    if (clear && trace_unlink() == -1) {
+        perror("[TRACEDUMP] 추적 공유 메모리 삭제 실패");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+ * ==============================================================================
+ * 파일명: perfctr.c
+ * 역할: perf_event_open 카운터 그룹 기반 구간별 계측 구현
+ *
+ * 기술 요소:
+ *   - perf_event_open(2): 현재 프로세스(pid=0, 모든 CPU)의 카운터를 그룹으로 생성
+ *   - PERF_FORMAT_GROUP: 그룹 전체를 read() 한 번으로 읽기 (구간 경계당 시스템 콜 1회)
+ *   - 커널 포함 측정이 거부되면(perf_event_paranoid) 사용자 공간만 측정으로 재시도
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/perfctr.h"
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+    const char *name;
+} event_defs[PERF_EVENTS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       "cycles" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     "instructions" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,     "cache-misses" },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context-switches" },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,       "task-clock" },
+};
+
+static const char *stage_names[PERF_STAGES] = { "ingest", "control", "log" };
+
+const char *perfctr_event_name(PerfEvent ev) {
+    return (ev >= 0 && ev < PERF_EVENTS) ? event_defs[ev].name : "?";
+}
+
+const char *perfctr_stage_name(PerfStage stage) {
+    return (stage >= 0 && stage < PERF_STAGES) ? stage_names[stage] : "?";
+}
+
+static int open_event(int ev, int group_fd, int exclude_kernel) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event_defs[ev].type;
+    attr.config = event_defs[ev].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = (group_fd == -1);       // 리더만 꺼 둔 채 생성, 모두 붙인 뒤 한 번에 켬
+    attr.exclude_kernel = exclude_kernel;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+/* 그룹 전체 읽기 - 반환: 0=성공 */
+static int read_group(PerfCounters *pc, uint64_t *values) {
+    uint64_t buf[1 + PERF_EVENTS];
+    ssize_t n = read(pc->group_fd, buf, sizeof(buf));
+    if (n < (ssize_t)sizeof(uint64_t) || buf[0] != (uint64_t)pc->nr) {
+        return -1;
+    }
+    for (int ev = 0; ev < PERF_EVENTS; ev++) {
+        values[ev] = pc->fds[ev] != -1 ? buf[1 + pc->slot[ev]] : 0;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: perfctr_open
+ * 설명: SMARTFARM_PERF=1 일 때 카운터 그룹 생성
+ *       처음 열린 카운터가 그룹 리더, 열리지 않는 카운터는 사용 불가로 표시
+ * ============================================================================ */
+int perfctr_open(PerfCounters *pc) {
+    memset(pc, 0, sizeof(*pc));
+    pc->group_fd = -1;
+    for (int ev = 0; ev < PERF_EVENTS; ev++) {
+        pc->fds[ev] = -1;
+    }
+    const char *env = getenv(PERFCTR_ENV);
+    if (env == NULL || strcmp(env, "1") != 0) {
+        return 0;
+    }
+
+    int exclude_kernel = 0;
+    int first_errno = 0;
+    for (int ev = 0; ev < PERF_EVENTS; ev++) {
+        int fd = open_event(ev, pc->group_fd, exclude_kernel);
+        if (fd == -1 && (errno == EACCES || errno == EPERM) && !exclude_kernel && pc->nr == 0) {
+            exclude_kernel = 1;     // 권한 부족 → 사용자 공간만 측정
+            fd = open_event(ev, pc->group_fd, exclude_kernel);
+        }
+        if (fd == -1) {
+            if (first_errno == 0) first_errno = errno;
+            continue;
+        }
+        if (pc->group_fd == -1) {
+            pc->group_fd = fd;
+        }
+        pc->fds[ev] = fd;
+        pc->slot[ev] = pc->nr++;
+    }
+
+    if (pc->nr == 0) {
+        fprintf(stderr, "[PERF] 성능 카운터 사용 불가 (%s) - 계측 비활성\n", strerror(first_errno));
+        return 0;
+    }
+    if (ioctl(pc->group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1) {
+        perror("[PERF] 카운터 활성화 실패");
+        perfctr_close(pc);
+        return 0;
+    }
+    pc->enabled = 1;
+
+    char avail[160] = "";
+    size_t off = 0;
+    for (int ev = 0; ev < PERF_EVENTS && off < sizeof(avail); ev++) {
+        off += snprintf(avail + off, sizeof(avail) - off, "%s%s%s", off ? ", " : "",
+                        event_defs[ev].name, pc->fds[ev] != -1 ? "" : "(n/a)");
+    }
+    printf("[PERF] 성능 카운터 %d개 활성%s: %s\n", pc->nr,
+           exclude_kernel ? " (사용자 공간만)" : "", avail);
+    perfctr_mark(pc);
+    return pc->nr;
+}
+
+/* ============================================================================
+ * 함수: perfctr_mark / perfctr_stage
+ * ============================================================================ */
+void perfctr_mark(PerfCounters *pc) {
+    if (!pc->enabled) {
+        return;
+    }
+    read_group(pc, pc->last);
+}
+
+void perfctr_stage(PerfCounters *pc, PerfStage stage) {
+    if (!pc->enabled) {
+        return;
+    }
+    uint64_t now[PERF_EVENTS];
+    if (read_group(pc, now) == -1) {
+        return;
+    }
+    for (int ev = 0; ev < PERF_EVENTS; ev++) {
+        pc->total[stage][ev] += now[ev] - pc->last[ev];
+        pc->last[ev] = now[ev];
+    }
+    pc->samples[stage]++;
+}
+
+/* ============================================================================
+ * 함수: perfctr_format
+ * 설명: "ingest n=.. ns=.. cyc=.. ipc=.. miss=.. cs=.." 형식, 구간 사이는 "; "
+ *       ns/cyc/miss/cs는 샘플당 평균
+ * ============================================================================ */
+int perfctr_format(const PerfCounters *pc, char *buf, size_t len) {
+    if (!pc->enabled) {
+        return snprintf(buf, len, "disabled");
+    }
+    size_t off = 0;
+    for (int s = 0; s < PERF_STAGES && off < len; s++) {
+        const uint64_t *t = pc->total[s];
+        double n = pc->samples[s] ? (double)pc->samples[s] : 1.0;
+        char ns[24] = "n/a", cyc[24] = "n/a", ipc[24] = "n/a", miss[24] = "n/a", cs[24] = "n/a";
+        if (pc->fds[PERF_EV_TASK_CLOCK] != -1) {
+            snprintf(ns, sizeof(ns), "%.0f", t[PERF_EV_TASK_CLOCK] / n);
+        }
+        if (pc->fds[PERF_EV_CYCLES] != -1) {
+            snprintf(cyc, sizeof(cyc), "%.0f", t[PERF_EV_CYCLES] / n);
+        }
+        if (pc->fds[PERF_EV_CYCLES] != -1 && pc->fds[PERF_EV_INSTRUCTIONS] != -1) {
+            snprintf(ipc, sizeof(ipc), "%.2f",
+                     t[PERF_EV_CYCLES] ? (double)t[PERF_EV_INSTRUCTIONS] / t[PERF_EV_CYCLES] : 0.0);
+        }
+        if (pc->fds[PERF_EV_CACHE_MISSES] != -1) {
+            snprintf(miss, sizeof(miss), "%.2f", t[PERF_EV_CACHE_MISSES] / n);
+        }
+        if (pc->fds[PERF_EV_CONTEXT_SWITCHES] != -1) {
+            snprintf(cs, sizeof(cs), "%.3f", t[PERF_EV_CONTEXT_SWITCHES] / n);
+        }
+        off += snprintf(buf + off, len - off, "%s%s n=%llu ns=%s cyc=%s ipc=%s miss=%s cs=%s",
+                        s ? "; " : "", stage_names[s], (unsigned long long)pc->samples[s],
+                        ns, cyc, ipc, miss, cs);
+    }
+    return (int)off;
+}
+
+void perfctr_reset(PerfCounters *pc) {
+    memset(pc->total, 0, sizeof(pc->total));
+    memset(pc->samples, 0, sizeof(pc->samples));
+}
+
+/* ============================================================================
+ * 함수: perfctr_close
+ * ============================================================================ */
+void perfctr_close(PerfCounters *pc) {
+    for (int ev = 0; ev < PERF_EVENTS; ev++) {
+        if (pc->fds[ev] != -1) {
+            close(pc->fds[ev]);
+            pc->fds[ev] = -1;
+        }
+    }
+    pc->group_fd = -1;
+    pc->enabled = 0;
+}
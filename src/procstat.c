@@ -0,0 +1,139 @@
+/*
+ * ==============================================================================
+ * 파일명: procstat.c
+ * 역할: /proc/<pid> 기반 프로세스 자원 사용량 샘플링 구현
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/procstat.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * 함수: read_stat
+ * 설명: /proc/<pid>/stat 파싱
+ *       comm 필드에 공백/괄호가 들어갈 수 있으므로 마지막 ')' 이후부터 파싱
+ * ============================================================================ */
+static int read_stat(pid_t pid, ProcSample *out) {
+    char path[64], buf[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[n] = '\0';
+
+    char *open = strchr(buf, '(');
+    char *close = strrchr(buf, ')');
+    if (open == NULL || close == NULL || close < open) {
+        return -1;
+    }
+    size_t len = (size_t)(close - open - 1);
+    if (len >= sizeof(out->comm)) len = sizeof(out->comm) - 1;
+    memcpy(out->comm, open + 1, len);
+    out->comm[len] = '\0';
+
+    // 필드 3(state)부터: state ppid pgrp session tty tpgid flags
+    //                    minflt cminflt majflt cmajflt utime stime
+    //                    cutime cstime priority nice num_threads
+    long threads;
+    int matched = sscanf(close + 2,
+                         "%c %*d %*d %*d %*d %*d %*u %llu %*u %llu %*u %llu %llu "
+                         "%*d %*d %*d %*d %ld",
+                         &out->state, &out->minflt, &out->majflt,
+                         &out->utime, &out->stime, &threads);
+    if (matched != 6) {
+        return -1;
+    }
+    out->threads = threads;
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: read_status
+ * 설명: /proc/<pid>/status 에서 VmRSS와 컨텍스트 스위치 수 추출
+ * ============================================================================ */
+static void read_status(pid_t pid, ProcSample *out) {
+    char path[64], line[256];
+    snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, "VmRSS: %ld", &out->rss_kb) == 1) continue;
+        if (sscanf(line, "voluntary_ctxt_switches: %llu", &out->vol_ctxt) == 1) continue;
+        sscanf(line, "nonvoluntary_ctxt_switches: %llu", &out->nonvol_ctxt);
+    }
+    fclose(fp);
+}
+
+/* ============================================================================
+ * 함수: read_io
+ * 설명: /proc/<pid>/io 의 syscr/syscw (다른 사용자 프로세스는 권한 없음)
+ * ============================================================================ */
+static void read_io(pid_t pid, ProcSample *out) {
+    char path[64], line[256];
+    snprintf(path, sizeof(path), "/proc/%d/io", (int)pid);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return;
+    }
+    int found = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, "syscr: %llu", &out->syscr) == 1) found++;
+        else if (sscanf(line, "syscw: %llu", &out->syscw) == 1) found++;
+    }
+    fclose(fp);
+    out->io_ok = (found == 2);
+}
+
+/* ============================================================================
+ * 함수: procstat_sample
+ * ============================================================================ */
+int procstat_sample(pid_t pid, ProcSample *out) {
+    memset(out, 0, sizeof(*out));
+    out->pid = pid;
+    if (read_stat(pid, out) == -1) {
+        return -1;
+    }
+    read_status(pid, out);
+    read_io(pid, out);
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: procstat_rate
+ * ============================================================================ */
+void procstat_rate(const ProcSample *prev, const ProcSample *cur,
+                   double elapsed_sec, ProcRate *out) {
+    static long ticks = 0;
+    if (ticks == 0) {
+        ticks = sysconf(_SC_CLK_TCK);
+    }
+    memset(out, 0, sizeof(*out));
+    if (elapsed_sec <= 0) {
+        return;
+    }
+
+    unsigned long long cpu_prev = prev->utime + prev->stime;
+    unsigned long long cpu_cur = cur->utime + cur->stime;
+    out->cpu_percent = (double)(cpu_cur - cpu_prev) / ticks / elapsed_sec * 100.0;
+    out->ctxt_per_sec = (double)((cur->vol_ctxt + cur->nonvol_ctxt) -
+                                 (prev->vol_ctxt + prev->nonvol_ctxt)) / elapsed_sec;
+    out->minflt_per_sec = (double)(cur->minflt - prev->minflt) / elapsed_sec;
+    if (prev->io_ok && cur->io_ok) {
+        out->syscall_per_sec = (double)((cur->syscr + cur->syscw) -
+                                        (prev->syscr + prev->syscw)) / elapsed_sec;
+    }
+}
@@ -0,0 +1,204 @@
+/*
+ * ==============================================================================
+ * 파일명: sensor_index.c
+ * 역할: 센서 등록 색인 등록/해제 구현
+ *
+ * 기술 요소:
+ *   - 선형 탐사 + backward shift 해제: 지운 자리 뒤의 항목 중 홈 버킷이 그 자리 이전(순환)인
+ *     것을 당겨 채워 묘비가 남지 않음 → 등록/해제를 반복해도 조회 탐사 길이가 그대로
+ *   - 슬롯 배정: 해제된 슬롯 스택 → 없으면 next_fresh (구역 슬롯이 앞쪽부터 빽빽하게 채워짐)
+ *   - 변경은 seq 홀수 구간 안에서만, 버킷은 64비트 원자적 기록 (읽는 쪽이 반쪽 항목을 보지 않음)
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/control_state.h"
+#include "../include/sensor_index.h"
+#include "../include/zone_hist.h"
+#include "../include/zone_ring.h"
+
+static inline void write_begin(SensorIndex *ix) {
+    __atomic_store_n(&ix->seq, ix->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void write_end(SensorIndex *ix) {
+    __atomic_store_n(&ix->seq, ix->seq + 1, __ATOMIC_RELEASE);
+}
+
+/* ID의 버킷 위치 찾기 - 반환: 버킷 번호, -1=없음 (기록자 전용: seq 확인 불필요) */
+static long find_bucket(const SensorIndex *ix, uint32_t id) {
+    uint32_t i = sensor_index_home(id);
+    for (uint32_t n = 0; n < SENSOR_INDEX_BUCKETS; n++) {
+        uint64_t e = ix->bucket[i];
+        if (e == 0) {
+            return -1;
+        }
+        if ((uint32_t)(e >> 32) == id) {
+            return i;
+        }
+        if (++i == SENSOR_INDEX_BUCKETS) {
+            i = 0;
+        }
+    }
+    return -1;
+}
+
+/* ============================================================================
+ * 함수: sensor_index_add
+ * ============================================================================ */
+int sensor_index_add(SensorIndex *ix, uint32_t id) {
+    if (id == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    long b = find_bucket(ix, id);
+    if (b != -1) {
+        return (int)(uint32_t)ix->bucket[b];
+    }
+    uint32_t slot;
+    if (ix->free_top > 0) {
+        slot = ix->free_slots[ix->free_top - 1];
+    } else if (ix->next_fresh < MAX_ZONES) {
+        slot = ix->next_fresh;
+    } else {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    // 적재율 0.5 이하라 빈 버킷이 반드시 있음
+    uint32_t i = sensor_index_home(id);
+    while (ix->bucket[i] != 0) {
+        if (++i == SENSOR_INDEX_BUCKETS) {
+            i = 0;
+        }
+    }
+    write_begin(ix);
+    __atomic_store_n(&ix->bucket[i], ((uint64_t)id << 32) | slot, __ATOMIC_RELAXED);
+    write_end(ix);
+
+    if (ix->free_top > 0) {
+        ix->free_top--;
+    } else {
+        ix->next_fresh++;
+    }
+    ix->owner[slot] = id;
+    ix->count++;
+    ix->added++;
+    return (int)slot;
+}
+
+/* ============================================================================
+ * 함수: sensor_index_remove
+ * ============================================================================ */
+int sensor_index_remove(SensorIndex *ix, uint32_t id) {
+    long b = id != 0 ? find_bucket(ix, id) : -1;
+    if (b == -1) {
+        errno = ENOENT;
+        return -1;
+    }
+    uint32_t slot = (uint32_t)ix->bucket[b];
+    uint32_t hole = (uint32_t)b, j = hole;
+
+    write_begin(ix);
+    for (;;) {
+        if (++j == SENSOR_INDEX_BUCKETS) {
+            j = 0;
+        }
+        uint64_t e = ix->bucket[j];
+        if (e == 0) {
+            break;
+        }
+        // j의 항목은 홈 버킷 k가 (hole, j] 구간(순환) 밖에 있을 때만 hole로 옮길 수 있음
+        uint32_t k = sensor_index_home((uint32_t)(e >> 32));
+        int movable = hole <= j ? (k <= hole || k > j) : (k <= hole && k > j);
+        if (movable) {
+            __atomic_store_n(&ix->bucket[hole], e, __ATOMIC_RELAXED);
+            hole = j;
+        }
+    }
+    __atomic_store_n(&ix->bucket[hole], 0, __ATOMIC_RELAXED);
+    write_end(ix);
+
+    ix->owner[slot] = 0;
+    ix->free_slots[ix->free_top++] = slot;
+    ix->count--;
+    ix->removed++;
+    return (int)slot;
+}
+
+/* ============================================================================
+ * 함수: sensor_index_repair / sensor_index_probe_stats
+ * ============================================================================ */
+void sensor_index_repair(SensorIndex *ix) {
+    if (ix->seq & 1) {
+        write_end(ix);
+    }
+}
+
+void sensor_index_probe_stats(const SensorIndex *ix, double *avg, uint32_t *max) {
+    uint64_t total = 0, n = 0;
+    *max = 0;
+    for (uint32_t i = 0; i < SENSOR_INDEX_BUCKETS; i++) {
+        uint64_t e = ix->bucket[i];
+        if (e == 0) {
+            continue;
+        }
+        uint32_t k = sensor_index_home((uint32_t)(e >> 32));
+        uint32_t d = i >= k ? i - k : i + SENSOR_INDEX_BUCKETS - k;
+        total += d;
+        n++;
+        if (d > *max) {
+            *max = d;
+        }
+    }
+    *avg = n ? (double)total / n : 0.0;
+}
+
+/* ============================================================================
+ * 함수: sensor_lookup
+ * ============================================================================ */
+int sensor_lookup(SharedData *sd, int sem_id, uint32_t id) {
+    int slot = sensor_index_lookup(&sd->sensors, id);
+    if (slot == SENSOR_INDEX_BUSY) {
+        sem_lock(sem_id);
+        sensor_index_repair(&sd->sensors);
+        slot = sensor_index_lookup(&sd->sensors, id);
+        sem_unlock(sem_id);
+    }
+    return slot;
+}
+
+/* ============================================================================
+ * 함수: sensor_register / sensor_deregister
+ * ============================================================================ */
+int sensor_register(SharedData *sd, int sem_id, uint32_t id) {
+    sem_lock(sem_id);
+    int slot = sensor_index_add(&sd->sensors, id);
+    int saved = errno;
+    sem_unlock(sem_id);
+    errno = saved;
+    return slot;
+}
+
+int sensor_deregister(SharedData *sd, int sem_id, uint32_t id) {
+    sem_lock(sem_id);
+    int slot = sensor_index_remove(&sd->sensors, id);
+    int saved = errno;
+    if (slot != -1) {
+        ZoneTable *zt = &sd->zones;
+        zt->last_update[slot] = 0;
+        zt->current_temp[slot] = 25.0;
+        zt->current_humidity[slot] = 50.0;
+        control_put(sd, CTRL_HEATER, slot, 0);
+        control_put(sd, CTRL_FAN, slot, 0);
+        control_publish(sd);
+        zone_ring_clear(&sd->recent[slot]);
+        zone_hist_clear(&sd->hist[slot]);
+    }
+    sem_unlock(sem_id);
+    errno = saved;
+    return slot;
+}
@@ -0,0 +1,273 @@
+/*
+ * ==============================================================================
+ * 파일명: shm_store.c
+ * 역할: SharedData 공유 메모리 생성/연결 구현
+ *
+ * 기술 요소:
+ *   - System V: shmget(), shmat(), shmctl() (+ SHM_HUGETLB)
+ *   - POSIX: shm_open(), ftruncate(), mmap() (+ MAP_POPULATE)
+ *   - 대형 페이지: hugetlbfs 파일 매핑 또는 madvise(MADV_HUGEPAGE)
+ *   - 구역 테이블이 커져도 TLB 미스와 시작 시 페이지 폴트를 줄이는 것이 목적
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/shm_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char *huge_names[] = { "off", "thp", "hugetlb" };
+
+/* ============================================================================
+ * 함수: env_choice
+ * 설명: 환경 변수 값을 후보 목록의 인덱스로 변환 (미설정/오류 시 기본값)
+ * ============================================================================ */
+static int env_choice(const char *env, const char **names, int n, int def) {
+    const char *v = getenv(env);
+    if (v == NULL || *v == '\0') {
+        return def;
+    }
+    for (int i = 0; i < n; i++) {
+        if (strcmp(v, names[i]) == 0) {
+            return i;
+        }
+    }
+    fprintf(stderr, "[SHM] 알 수 없는 %s=%s, 기본값 사용\n", env, v);
+    return def;
+}
+
+static size_t round_up(size_t v, size_t align) {
+    return (v + align - 1) / align * align;
+}
+
+/* ============================================================================
+ * 함수: prefault
+ * 설명: 매핑된 모든 페이지를 미리 채움 (System V 세그먼트용, POSIX는 MAP_POPULATE)
+ * ============================================================================ */
+static void prefault(void *addr, size_t len, int writable) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(addr, len, writable ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) == 0) {
+        return;
+    }
+#endif
+    // 구 커널: 페이지마다 한 번씩 접근
+    volatile char *p = addr;
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < len; off += page) {
+        (void)p[off];
+    }
+}
+
+/* ============================================================================
+ * 함수: sysv_open
+ * ============================================================================ */
+static int sysv_open(ShmHandle *h, int flags) {
+    key_t key = ipc_key(SHM_KEY);
+    int create = flags & SHM_STORE_CREATE;
+    int shmflg = 0666 | (create ? IPC_CREAT : 0);
+    size_t size = round_up(sizeof(SharedData), sysconf(_SC_PAGESIZE));
+
+    h->shm_id = -1;
+    if (create && h->huge_requested == SHM_HUGE_HUGETLB) {
+        h->shm_id = shmget(key, round_up(size, HUGEPAGE_SIZE), shmflg | SHM_HUGETLB);
+        if (h->shm_id == -1) {
+            perror("[SHM] SHM_HUGETLB 세그먼트 생성 실패, 일반 페이지 사용");
+        } else {
+            h->huge_applied = SHM_HUGE_HUGETLB;
+        }
+    }
+    if (h->shm_id == -1) {
+        // 연결만 할 때는 크기 0 → 기존 세그먼트 크기와 무관하게 조회
+        h->shm_id = shmget(key, create ? size : 0, shmflg);
+    }
+    if (h->shm_id == -1) {
+        if (errno == EINVAL && create) {
+            fprintf(stderr, "[SHM] 기존 세그먼트 크기가 맞지 않습니다 (ipcrm -M 0x%x 후 재실행)\n",
+                    (unsigned)key);
+        }
+        return -1;
+    }
+
+    struct shmid_ds ds;
+    if (shmctl(h->shm_id, IPC_STAT, &ds) == -1) {
+        return -1;
+    }
+    if (ds.shm_segsz < sizeof(SharedData)) {
+        fprintf(stderr, "[SHM] 세그먼트가 SharedData보다 작습니다 (%zu < %zu)\n",
+                (size_t)ds.shm_segsz, sizeof(SharedData));
+        errno = EINVAL;
+        return -1;
+    }
+    h->map_size = ds.shm_segsz;
+
+    void *addr = shmat(h->shm_id, NULL, (flags & SHM_STORE_RDONLY) ? SHM_RDONLY : 0);
+    if (addr == (void *)-1) {
+        return -1;
+    }
+    if (h->huge_requested == SHM_HUGE_THP) {
+        if (madvise(addr, h->map_size, MADV_HUGEPAGE) == 0) {
+            h->huge_applied = SHM_HUGE_THP;
+        }
+    }
+    if (h->prefaulted) {
+        prefault(addr, h->map_size, !(flags & SHM_STORE_RDONLY));
+    }
+    h->data = addr;
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: map_aligned
+ * 설명: THP가 적용되도록 2MB 경계에 정렬된 주소에 fd를 매핑
+ *       (크게 예약 → 정렬 위치에 MAP_FIXED 매핑 → 남는 앞뒤 영역 해제)
+ * ============================================================================ */
+static void *map_aligned(int fd, size_t size, int prot, int mflags) {
+    size_t span = size + HUGEPAGE_SIZE;
+    char *res = mmap(NULL, span, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (res == MAP_FAILED) {
+        return MAP_FAILED;
+    }
+    char *aligned = (char *)round_up((size_t)res, HUGEPAGE_SIZE);
+    void *addr = mmap(aligned, size, prot, mflags | MAP_FIXED, fd, 0);
+    if (addr == MAP_FAILED) {
+        munmap(res, span);
+        return MAP_FAILED;
+    }
+    if (aligned > res) munmap(res, aligned - res);
+    size_t tail = (size_t)((res + span) - (aligned + size));
+    if (tail > 0) munmap(aligned + size, tail);
+    return addr;
+}
+
+/* ============================================================================
+ * 함수: posix_open
+ * ============================================================================ */
+static int posix_open(ShmHandle *h, int flags) {
+    int create = flags & SHM_STORE_CREATE;
+    int rdonly = flags & SHM_STORE_RDONLY;
+    int oflags = (rdonly ? O_RDONLY : O_RDWR) | (create ? O_CREAT : 0);
+    size_t size = round_up(sizeof(SharedData), sysconf(_SC_PAGESIZE));
+    int fd = -1;
+
+    if (h->huge_requested == SHM_HUGE_HUGETLB) {
+        snprintf(h->name, sizeof(h->name), "%s/smartfarm.%s", HUGETLBFS_DIR, instance_name());
+        fd = open(h->name, oflags, 0666);
+        if (fd == -1) {
+            fprintf(stderr, "[SHM] %s 열기 실패 (%s), 일반 페이지 사용\n",
+                    h->name, strerror(errno));
+        } else {
+            h->huge_applied = SHM_HUGE_HUGETLB;
+            size = round_up(size, HUGEPAGE_SIZE);
+        }
+    }
+    if (fd == -1) {
+        snprintf(h->name, sizeof(h->name), "/smartfarm.%s", instance_name());
+        fd = shm_open(h->name, oflags, 0666);
+        if (fd == -1) {
+            return -1;
+        }
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < size) {
+        if (!create || ftruncate(fd, size) == -1) {
+            if (!create) errno = EINVAL;    // 서버가 아직 초기화 전이거나 구 버전 세그먼트
+            close(fd);
+            return -1;
+        }
+    } else {
+        size = st.st_size;
+    }
+    h->map_size = size;
+
+    int prot = PROT_READ | (rdonly ? 0 : PROT_WRITE);
+    int mflags = MAP_SHARED | (h->prefaulted ? MAP_POPULATE : 0);
+    void *addr;
+    if (h->huge_requested == SHM_HUGE_THP) {
+        addr = map_aligned(fd, size, prot, mflags);
+        if (addr != MAP_FAILED && madvise(addr, size, MADV_HUGEPAGE) == 0) {
+            h->huge_applied = SHM_HUGE_THP;
+            if (h->prefaulted) prefault(addr, size, !rdonly);   // 대형 페이지로 다시 채움
+        }
+    } else {
+        addr = mmap(NULL, size, prot, mflags, fd, 0);
+    }
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return -1;
+    }
+    h->data = addr;
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: shm_store_open
+ * ============================================================================ */
+int shm_store_open(ShmHandle *h, int flags) {
+    static const char *backend_names[] = { "sysv", "posix" };
+    static const char *prefault_names[] = { "0", "1" };
+
+    memset(h, 0, sizeof(*h));
+    h->shm_id = -1;
+    h->backend = env_choice(SHM_BACKEND_ENV, backend_names, 2, SHM_BACKEND_SYSV);
+    h->huge_requested = env_choice(HUGEPAGE_ENV, huge_names, 3, SHM_HUGE_OFF);
+    h->prefaulted = env_choice(PREFAULT_ENV, prefault_names, 2, 1);
+
+    int rc = (h->backend == SHM_BACKEND_POSIX) ? posix_open(h, flags) : sysv_open(h, flags);
+    if (rc == -1) {
+        h->data = NULL;
+    }
+    return rc;
+}
+
+/* ============================================================================
+ * 함수: shm_store_close
+ * ============================================================================ */
+void shm_store_close(ShmHandle *h) {
+    if (h->data == NULL) {
+        return;
+    }
+    if (h->backend == SHM_BACKEND_POSIX) {
+        munmap(h->data, h->map_size);
+    } else {
+        shmdt(h->data);
+    }
+    h->data = NULL;
+}
+
+/* ============================================================================
+ * 함수: shm_store_destroy
+ * ============================================================================ */
+void shm_store_destroy(ShmHandle *h) {
+    shm_store_close(h);
+    if (h->backend == SHM_BACKEND_POSIX) {
+        if (h->huge_applied == SHM_HUGE_HUGETLB) unlink(h->name);
+        else shm_unlink(h->name);
+    } else if (h->shm_id != -1) {
+        shmctl(h->shm_id, IPC_RMID, NULL);
+    }
+}
+
+/* ============================================================================
+ * 함수: shm_store_describe
+ * ============================================================================ */
+void shm_store_describe(const ShmHandle *h, char *buf, size_t len) {
+    char where[180];
+    if (h->backend == SHM_BACKEND_POSIX) {
+        snprintf(where, sizeof(where), "posix %s", h->name);
+    } else {
+        snprintf(where, sizeof(where), "sysv key=0x%x id=%d", (unsigned)ipc_key(SHM_KEY), h->shm_id);
+    }
+    snprintf(buf, len, "%s, %zuB, 대형 페이지=%s%s%s",
+             where, h->map_size, huge_names[h->huge_applied],
+             (h->huge_requested != h->huge_applied) ? "(요청 실패)" : "",
+             h->prefaulted ? ", prefault" : "");
+}
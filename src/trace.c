@@ -0,0 +1,136 @@
+/*
+ * ==============================================================================
+ * 파일명: trace.c
+ * 역할: 프로세스별 이벤트 추적 링 연결/해제 구현
+ *
+ * 기술 요소:
+ *   - shm_open(O_CREAT) + ftruncate: 먼저 추적을 켠 프로세스가 생성, 나머지는 연결
+ *     (tmpfs는 희소 파일이므로 실제 기록된 링의 페이지만 메모리 사용)
+ *   - 덤프 도구는 O_RDONLY + PROT_READ 로 연결
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/trace.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+TraceRing *trace_ring = NULL;
+static TraceShm *trace_map = NULL;
+
+static const char *trace_names[TRACE_IDS] = {
+    "none", "sensor_send", "server_recv", "control", "publish", "log_write", "actuator_render"
+};
+
+const char *trace_id_name(int id) {
+    return (id > 0 && id < TRACE_IDS) ? trace_names[id] : "unknown";
+}
+
+static void trace_shm_name(char *buf, size_t len) {
+    snprintf(buf, len, TRACE_SHM_FMT, instance_name());
+}
+
+/* ============================================================================
+ * 함수: trace_init
+ * 설명: 추적 공유 메모리 연결 후 slot번 링을 이 프로세스 것으로 초기화
+ *       형식이 다른 기존 객체(다른 빌드)는 크기를 맞추고 헤더를 다시 씀
+ * ============================================================================ */
+int trace_init(int slot, int role, int zone) {
+    const char *env = getenv(TRACE_ENV);
+    if (env == NULL || strcmp(env, "1") != 0 || slot < 0 || slot >= MAX_PROCS) {
+        return -1;
+    }
+    char name[64];
+    trace_shm_name(name, sizeof(name));
+    int fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+    if (fd == -1) {
+        perror("[TRACE] 추적 공유 메모리 열기 실패");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 ||
+        ((size_t)st.st_size != sizeof(TraceShm) && ftruncate(fd, sizeof(TraceShm)) == -1)) {
+        perror("[TRACE] 추적 공유 메모리 크기 설정 실패");
+        close(fd);
+        return -1;
+    }
+    TraceShm *ts = mmap(NULL, sizeof(TraceShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ts == MAP_FAILED) {
+        perror("[TRACE] 추적 공유 메모리 매핑 실패");
+        return -1;
+    }
+    if (ts->magic != TRACE_MAGIC || ts->version != TRACE_VERSION) {
+        // 여러 프로세스가 동시에 와도 같은 값을 쓰므로 경쟁해도 결과는 같음
+        ts->rings = MAX_PROCS;
+        ts->ring_events = TRACE_RING_EVENTS;
+        ts->version = TRACE_VERSION;
+        __atomic_store_n(&ts->magic, TRACE_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    TraceRing *r = &ts->ring[slot];
+    __atomic_store_n(&r->head, 0, __ATOMIC_RELEASE);
+    r->role = role;
+    r->zone = zone;
+    __atomic_store_n(&r->pid, getpid(), __ATOMIC_RELEASE);
+    trace_map = ts;
+    trace_ring = r;
+    printf("[TRACE] 추적 기록 활성: %s 링 %d\n", name, slot);
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: trace_close
+ * ============================================================================ */
+void trace_close(void) {
+    if (trace_map != NULL) {
+        trace_ring = NULL;
+        munmap(trace_map, sizeof(TraceShm));
+        trace_map = NULL;
+    }
+}
+
+/* ============================================================================
+ * 함수: trace_attach_reader / trace_detach_reader / trace_unlink
+ * ============================================================================ */
+const TraceShm *trace_attach_reader(void) {
+    char name[64];
+    trace_shm_name(name, sizeof(name));
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size != sizeof(TraceShm)) {
+        close(fd);
+        errno = EPROTO;     // 다른 빌드가 만든 객체
+        return NULL;
+    }
+    const TraceShm *ts = mmap(NULL, sizeof(TraceShm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ts == MAP_FAILED) {
+        return NULL;
+    }
+    if (ts->magic != TRACE_MAGIC || ts->version != TRACE_VERSION) {
+        munmap((void *)ts, sizeof(TraceShm));
+        errno = EPROTO;
+        return NULL;
+    }
+    return ts;
+}
+
+void trace_detach_reader(const TraceShm *ts) {
+    if (ts != NULL) {
+        munmap((void *)ts, sizeof(TraceShm));
+    }
+}
+
+int trace_unlink(void) {
+    char name[64];
+    trace_shm_name(name, sizeof(name));
+    return shm_unlink(name);
+}
@@ -0,0 +1,494 @@
+/*
+ * ==============================================================================
+ * 파일명: transport.c
+ * 역할: 센서 → 서버 메시지 전송 계층 구현 (4개 백엔드)
+ *
+ * 기술 요소:
+ *   - System V Message Queue: msgget(), msgsnd(), msgrcv()
+ *   - POSIX Message Queue: mq_open(), mq_send(), mq_receive()
+ *   - POSIX Shared Memory: shm_open(), mmap() + Vyukov MPSC 링 버퍼
+ *     (슬롯별 시퀀스 번호, 빈/가득 찬 경우 futex 대기,
+ *      epoll 소비자는 FIFO 도어벨로 깨움)
+ *   - Unix Domain Socket: socket(AF_UNIX, SOCK_DGRAM), bind(), connect()
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/common.h"
+#include "../include/transport.h"
+
+#include <fcntl.h>
+#include <mqueue.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define SHM_RING_MAGIC          0x52494E47  // 'RING'
+#define RING_WAIT_MS            100         // futex 대기 상한 (깨우기 누락 대비)
+
+/* ============================================================================
+ * 공유 메모리 링 버퍼 구조
+ * - head: 생산자들이 CAS로 예약하는 다음 쓰기 위치
+ * - tail: 단일 소비자(서버)의 다음 읽기 위치
+ * - slot.seq == pos      → 비어 있음 (pos 위치 쓰기 가능)
+ *   slot.seq == pos + 1  → 채워짐 (pos 위치 읽기 가능)
+ * - doorbell: 소비자가 epoll 대기에 들어가기 전에 1로 설정,
+ *   첫 생산자가 0으로 바꾸며 FIFO에 1바이트 기록 → 소비자 fd가 읽기 가능
+ * ============================================================================ */
+typedef struct {
+    unsigned long seq;
+    uint32_t len;
+    char data[TRANSPORT_MAX_MSG];
+} __attribute__((aligned(64))) RingSlot;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t capacity;
+    unsigned long head __attribute__((aligned(64)));
+    unsigned long tail __attribute__((aligned(64)));
+    int items __attribute__((aligned(64)));     // futex: 게시 카운터
+    int consumer_waiting;
+    int doorbell;                               // epoll 대기 중인 소비자 (FIFO로 깨움)
+    int space __attribute__((aligned(64)));     // futex: 소비 카운터
+    int producers_waiting;
+    RingSlot slots[TRANSPORT_DEPTH] __attribute__((aligned(64)));
+} ShmRing;
+
+struct Transport {
+    TransportKind kind;
+    key_t key;
+    int owner;                  // TRANSPORT_CREATE로 연 쪽
+    int fd;                     // sysv: msqid, mq: mqd_t, unix: 소켓, shmring: 도어벨 FIFO
+    int nbfd;                   // mq: 같은 큐를 O_NONBLOCK으로 연 두 번째 mqd_t (논블로킹 수신 전용)
+    ShmRing *ring;
+    char name[108];             // mq/shm 이름 또는 소켓 경로
+    char fifo[108];             // shmring 도어벨 FIFO 경로
+    char *rxbuf;                // mq 수신 버퍼 (msgsize 이상 필요)
+};
+
+static const char *kind_names[TRANSPORT_KINDS] = { "sysv", "mq", "shmring", "unix" };
+
+/* ============================================================================
+ * 함수: transport_kind_name / transport_parse_kind / transport_kind_from_env
+ * ============================================================================ */
+const char *transport_kind_name(TransportKind kind) {
+    return (kind >= 0 && kind < TRANSPORT_KINDS) ? kind_names[kind] : "?";
+}
+
+int transport_parse_kind(const char *name) {
+    for (int i = 0; i < TRANSPORT_KINDS; i++) {
+        if (strcmp(name, kind_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+TransportKind transport_kind_from_env(void) {
+    const char *env = getenv(TRANSPORT_ENV);
+    if (env == NULL || *env == '\0') {
+        return TRANSPORT_POSIX_MQ;
+    }
+    int kind = transport_parse_kind(env);
+    if (kind < 0) {
+        fprintf(stderr, "[TRANSPORT] 알 수 없는 %s=%s, mq 사용\n", TRANSPORT_ENV, env);
+        return TRANSPORT_POSIX_MQ;
+    }
+    return (TransportKind)kind;
+}
+
+/* ============================================================================
+ * 백엔드: System V 메시지 큐
+ * ============================================================================ */
+static int sysv_open(Transport *t, int flags) {
+    t->fd = msgget(t->key, 0666 | ((flags & TRANSPORT_CREATE) ? IPC_CREAT : 0));
+    return t->fd == -1 ? -1 : 0;
+}
+
+static int sysv_send(Transport *t, const void *msg, size_t len) {
+    return msgsnd(t->fd, msg, len - sizeof(long), 0);
+}
+
+static ssize_t sysv_recv(Transport *t, void *buf, size_t len, long type, int flags) {
+    ssize_t n = msgrcv(t->fd, buf, len - sizeof(long), type,
+                       (flags & TRANSPORT_NONBLOCK) ? IPC_NOWAIT : 0);
+    if (n == -1) {
+        if (errno == ENOMSG) errno = EAGAIN;
+        return -1;
+    }
+    return n + (ssize_t)sizeof(long);
+}
+
+/* ============================================================================
+ * 백엔드: POSIX 메시지 큐
+ * - 비특권 사용자는 fs.mqueue.msg_max(기본 10) 이상을 만들 수 없으므로
+ *   EINVAL이면 기본 깊이로 재시도
+ * - 논블로킹 수신은 O_NONBLOCK으로 한 번 더 연 디스크립터 사용
+ *   (수신마다 mq_getattr/mq_setattr 시스템 콜 3회를 더하지 않음)
+ *   생성측(서버)은 열 때, 그 밖의 수신측은 첫 논블로킹 수신 때 열고 송신만 하는 센서는 열지 않음
+ * ============================================================================ */
+static int mq_backend_open(Transport *t, int flags) {
+    snprintf(t->name, sizeof(t->name), "/smartfarm.%x", (unsigned)t->key);
+    mqd_t mq;
+    if (flags & TRANSPORT_CREATE) {
+        struct mq_attr attr = {0};
+        attr.mq_maxmsg = TRANSPORT_DEPTH;
+        attr.mq_msgsize = TRANSPORT_MAX_MSG;
+        mq = mq_open(t->name, O_RDWR | O_CREAT, 0666, &attr);
+        if (mq == (mqd_t)-1 && (errno == EINVAL || errno == EMFILE)) {
+            attr.mq_maxmsg = 10;
+            mq = mq_open(t->name, O_RDWR | O_CREAT, 0666, &attr);
+        }
+    } else {
+        mq = mq_open(t->name, O_RDWR);
+    }
+    if (mq == (mqd_t)-1) {
+        return -1;
+    }
+    t->fd = (int)mq;
+    if (flags & TRANSPORT_CREATE) {
+        mqd_t nb = mq_open(t->name, O_RDONLY | O_NONBLOCK);
+        if (nb == (mqd_t)-1) {
+            mq_close(mq);
+            t->fd = -1;
+            return -1;
+        }
+        t->nbfd = (int)nb;
+    }
+
+    struct mq_attr cur;
+    mq_getattr(mq, &cur);
+    t->rxbuf = malloc(cur.mq_msgsize);
+    return t->rxbuf ? 0 : -1;
+}
+
+static int mq_backend_send(Transport *t, const void *msg, size_t len) {
+    return mq_send((mqd_t)t->fd, msg, len, 0);
+}
+
+static ssize_t mq_backend_recv(Transport *t, void *buf, size_t len, int flags) {
+    if ((flags & TRANSPORT_NONBLOCK) && t->nbfd == -1) {
+        mqd_t nb = mq_open(t->name, O_RDONLY | O_NONBLOCK);
+        if (nb == (mqd_t)-1) {
+            return -1;
+        }
+        t->nbfd = (int)nb;
+    }
+    mqd_t mq = (mqd_t)((flags & TRANSPORT_NONBLOCK) ? t->nbfd : t->fd);
+    ssize_t n = mq_receive(mq, t->rxbuf, TRANSPORT_MAX_MSG, NULL);
+    if (n == -1) {
+        return -1;
+    }
+    memcpy(buf, t->rxbuf, (size_t)n < len ? (size_t)n : len);
+    return n;
+}
+
+/* ============================================================================
+ * 백엔드: 공유 메모리 링 버퍼
+ * ============================================================================ */
+static int ring_open(Transport *t, int flags) {
+    snprintf(t->name, sizeof(t->name), "/smartfarm.ring.%x", (unsigned)t->key);
+    snprintf(t->fifo, sizeof(t->fifo), "/tmp/smartfarm.ring.%x.fifo", (unsigned)t->key);
+    int create = flags & TRANSPORT_CREATE;
+    int fd = shm_open(t->name, O_RDWR | (create ? O_CREAT : 0), 0666);
+    if (fd == -1) {
+        return -1;
+    }
+    if (create && ftruncate(fd, sizeof(ShmRing)) == -1) {
+        close(fd);
+        return -1;
+    }
+    ShmRing *ring = mmap(NULL, sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        return -1;
+    }
+
+    if (create && __atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) == SHM_RING_MAGIC &&
+        ring->capacity == TRANSPORT_DEPTH) {
+        // 이전 서버가 남긴 링 채택 (웜 재시작) - 쌓인 메시지와 생산자 위치 유지
+        __atomic_store_n(&ring->consumer_waiting, 0, __ATOMIC_SEQ_CST);
+    } else if (create) {
+        memset(ring, 0, offsetof(ShmRing, slots));
+        ring->capacity = TRANSPORT_DEPTH;
+        for (unsigned long i = 0; i < TRANSPORT_DEPTH; i++) {
+            ring->slots[i].seq = i;
+        }
+        __atomic_store_n(&ring->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    } else if (__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC) {
+        munmap(ring, sizeof(ShmRing));
+        errno = ENOENT;
+        return -1;
+    }
+    if (create) {
+        // 도어벨: 소비자는 읽기/쓰기로 열어 생산자가 없어도 EOF가 나지 않게 함
+        // 기존 FIFO는 그대로 사용 (연결된 생산자의 fd가 같은 FIFO를 가리키도록)
+        if (mkfifo(t->fifo, 0666) == 0 || errno == EEXIST) {
+            t->fd = open(t->fifo, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        }
+    } else {
+        // 소비자가 도어벨을 쓰지 않는 경우(벤치마크 등)에는 열리지 않아도 무방
+        t->fd = open(t->fifo, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    }
+    t->ring = ring;
+    return 0;
+}
+
+static int ring_send(Transport *t, const void *msg, size_t len) {
+    ShmRing *r = t->ring;
+    unsigned long pos;
+    RingSlot *slot;
+
+    for (;;) {
+        pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+        slot = &r->slots[pos % r->capacity];
+        unsigned long seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        long diff = (long)(seq - pos);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&r->head, &pos, pos + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 가득 참 - 소비자가 슬롯을 비울 때까지 대기
+            int space = __atomic_load_n(&r->space, __ATOMIC_SEQ_CST);
+            __atomic_add_fetch(&r->producers_waiting, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST) == seq) {
+                futex_wait(&r->space, space, RING_WAIT_MS);
+            }
+            __atomic_sub_fetch(&r->producers_waiting, 1, __ATOMIC_SEQ_CST);
+        }
+    }
+
+    memcpy(slot->data, msg, len);
+    slot->len = (uint32_t)len;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&r->items, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&r->consumer_waiting, __ATOMIC_SEQ_CST)) {
+        futex_wake(&r->items, 1);
+    }
+    if (t->fd != -1 && __atomic_exchange_n(&r->doorbell, 0, __ATOMIC_SEQ_CST)) {
+        char bell = 1;
+        ssize_t n = write(t->fd, &bell, 1);     // 가득 차서 실패해도 이미 읽기 가능 상태
+        (void)n;
+    }
+    return 0;
+}
+
+static ssize_t ring_recv(Transport *t, void *buf, size_t len, int flags) {
+    ShmRing *r = t->ring;
+    int armed = 0;
+
+    for (;;) {
+        unsigned long pos = r->tail;
+        RingSlot *slot = &r->slots[pos % r->capacity];
+        unsigned long seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == pos + 1) {
+            size_t n = slot->len;
+            memcpy(buf, slot->data, n < len ? n : len);
+            r->tail = pos + 1;
+            __atomic_store_n(&slot->seq, pos + r->capacity, __ATOMIC_RELEASE);
+
+            __atomic_add_fetch(&r->space, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&r->producers_waiting, __ATOMIC_SEQ_CST)) {
+                futex_wake(&r->space, INT_MAX);
+            }
+            return (ssize_t)n;
+        }
+        if (flags & TRANSPORT_NONBLOCK) {
+            if (t->fd != -1 && !armed) {
+                // epoll 대기 전환: 도어벨을 비우고 무장한 뒤 한 번 더 확인
+                // (그 사이 게시된 메시지는 재확인에서, 이후 메시지는 도어벨로 감지)
+                char drain[64];
+                while (read(t->fd, drain, sizeof(drain)) > 0) ;
+                __atomic_store_n(&r->doorbell, 1, __ATOMIC_SEQ_CST);
+                armed = 1;
+                continue;
+            }
+            errno = EAGAIN;
+            return -1;
+        }
+
+        // 비어 있음 - 생산자가 게시할 때까지 대기
+        int items = __atomic_load_n(&r->items, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&r->consumer_waiting, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST) != pos + 1) {
+            futex_wait(&r->items, items, RING_WAIT_MS);
+        }
+        __atomic_store_n(&r->consumer_waiting, 0, __ATOMIC_SEQ_CST);
+    }
+}
+
+/* ============================================================================
+ * 백엔드: Unix 도메인 데이터그램 소켓
+ * - 서버는 경로에 bind, 센서는 connect 후 send (수신 큐가 차면 송신 대기)
+ * ============================================================================ */
+static int unix_open(Transport *t, int flags) {
+    snprintf(t->name, sizeof(t->name), "/tmp/smartfarm.%x.sock", (unsigned)t->key);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", t->name);
+
+    t->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (t->fd == -1) {
+        return -1;
+    }
+    if (flags & TRANSPORT_CREATE) {
+        unlink(t->name);
+        if (bind(t->fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+            return -1;
+        }
+        chmod(t->name, 0666);
+        int rcvbuf = TRANSPORT_DEPTH * TRANSPORT_MAX_MSG;
+        setsockopt(t->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    } else if (connect(t->fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+static int unix_send(Transport *t, const void *msg, size_t len) {
+    return send(t->fd, msg, len, 0) == (ssize_t)len ? 0 : -1;
+}
+
+static ssize_t unix_recv(Transport *t, void *buf, size_t len, int flags) {
+    return recv(t->fd, buf, len, (flags & TRANSPORT_NONBLOCK) ? MSG_DONTWAIT : 0);
+}
+
+/* ============================================================================
+ * 공통 인터페이스
+ * ============================================================================ */
+Transport *transport_open(TransportKind kind, key_t key, int flags) {
+    Transport *t = calloc(1, sizeof(Transport));
+    if (t == NULL) {
+        return NULL;
+    }
+    t->kind = kind;
+    t->key = key;
+    t->owner = (flags & TRANSPORT_CREATE) != 0;
+    t->fd = -1;
+    t->nbfd = -1;
+
+    int rc;
+    switch (kind) {
+        case TRANSPORT_SYSV:       rc = sysv_open(t, flags); break;
+        case TRANSPORT_POSIX_MQ:   rc = mq_backend_open(t, flags); break;
+        case TRANSPORT_SHM_RING:   rc = ring_open(t, flags); break;
+        case TRANSPORT_UNIX_DGRAM: rc = unix_open(t, flags); break;
+        default: errno = EINVAL; rc = -1; break;
+    }
+    if (rc == -1) {
+        int saved = errno;
+        transport_close(t);
+        errno = saved;
+        return NULL;
+    }
+    return t;
+}
+
+int transport_send(Transport *t, const void *msg, size_t len) {
+    if (len < sizeof(long) || len > TRANSPORT_MAX_MSG) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    switch (t->kind) {
+        case TRANSPORT_SYSV:       return sysv_send(t, msg, len);
+        case TRANSPORT_POSIX_MQ:   return mq_backend_send(t, msg, len);
+        case TRANSPORT_SHM_RING:   return ring_send(t, msg, len);
+        case TRANSPORT_UNIX_DGRAM: return unix_send(t, msg, len);
+        default: errno = EINVAL; return -1;
+    }
+}
+
+ssize_t transport_recv(Transport *t, void *buf, size_t len, long msg_type, int flags) {
+    switch (t->kind) {
+        case TRANSPORT_SYSV:       return sysv_recv(t, buf, len, msg_type, flags);
+        case TRANSPORT_POSIX_MQ:   return mq_backend_recv(t, buf, len, flags);
+        case TRANSPORT_SHM_RING:   return ring_recv(t, buf, len, flags);
+        case TRANSPORT_UNIX_DGRAM: return unix_recv(t, buf, len, flags);
+        default: errno = EINVAL; return -1;
+    }
+}
+
+int transport_fd(const Transport *t) {
+    if (t->kind == TRANSPORT_SHM_RING) {
+        return t->owner ? t->fd : -1;
+    }
+    return (t->kind == TRANSPORT_POSIX_MQ || t->kind == TRANSPORT_UNIX_DGRAM) ? t->fd : -1;
+}
+
+int transport_backlog(const Transport *t, long *pending, long *capacity) {
+    switch (t->kind) {
+        case TRANSPORT_SYSV: {
+            struct msqid_ds ds;
+            if (msgctl(t->fd, IPC_STAT, &ds) == -1) {
+                return -1;
+            }
+            *pending = (long)ds.__msg_cbytes;
+            *capacity = (long)ds.msg_qbytes;
+            return 0;
+        }
+        case TRANSPORT_POSIX_MQ: {
+            struct mq_attr attr;
+            if (mq_getattr((mqd_t)t->fd, &attr) == -1) {
+                return -1;
+            }
+            *pending = attr.mq_curmsgs;
+            *capacity = attr.mq_maxmsg;
+            return 0;
+        }
+        case TRANSPORT_SHM_RING:
+            *pending = (long)(__atomic_load_n(&t->ring->head, __ATOMIC_RELAXED) -
+                              __atomic_load_n(&t->ring->tail, __ATOMIC_RELAXED));
+            *capacity = t->ring->capacity;
+            return 0;
+        default:
+            errno = ENOTSUP;
+            return -1;
+    }
+}
+
+void transport_close(Transport *t) {
+    if (t == NULL) {
+        return;
+    }
+    switch (t->kind) {
+        case TRANSPORT_POSIX_MQ:
+            if (t->fd != -1) mq_close((mqd_t)t->fd);
+            if (t->nbfd != -1) mq_close((mqd_t)t->nbfd);
+            break;
+        case TRANSPORT_UNIX_DGRAM:
+            if (t->fd != -1) close(t->fd);
+            break;
+        case TRANSPORT_SHM_RING:
+            if (t->ring != NULL) munmap(t->ring, sizeof(ShmRing));
+            if (t->fd != -1) close(t->fd);
+            break;
+        default:
+            break;
+    }
+    free(t->rxbuf);
+    free(t);
+}
+
+void transport_destroy(Transport *t) {
+    if (t == NULL) {
+        return;
+    }
+    switch (t->kind) {
+        case TRANSPORT_SYSV:       msgctl(t->fd, IPC_RMID, NULL); break;
+        case TRANSPORT_POSIX_MQ:   mq_unlink(t->name); break;
+        case TRANSPORT_SHM_RING:   shm_unlink(t->name); unlink(t->fifo); break;
+        case TRANSPORT_UNIX_DGRAM: unlink(t->name); break;
+        default: break;
+    }
+    transport_close(t);
+}
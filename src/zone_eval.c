@@ -0,0 +1,190 @@
+/*
+ * ==============================================================================
+ * 파일명: zone_eval.c
+ * 역할: 구역 전체 임계값 일괄 판정 구현 (스칼라 / AVX2)
+ *
+ * 기술 요소:
+ *   - __attribute__((target("avx2"))): 빌드 전체를 -mavx2 로 올리지 않고 이 함수만 AVX2로 컴파일
+ *   - __builtin_cpu_supports("avx2"): 실행 중인 CPU에서 사용 가능할 때만 호출
+ *   - _mm256_cmp_ps(_CMP_LT_OQ / _CMP_GT_OQ) + _mm256_movemask_ps: 8개 구역 → 8비트
+ *     (순서 있는 비교라 NaN은 거짓)
+ *   - 스칼라: 64개 구역 비교 결과를 바이트(0/1)로 모은 뒤(컴파일러 자동 벡터화 대상)
+ *     8바이트씩 곱셈 한 번으로 8비트로 압축 - 비트마다 가변 시프트하는 것보다 빠름
+ *   - 64개 미만 꼬리 구간은 스칼라로 같은 워드에 이어서 채움
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/zone_eval.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ZONE_EVAL_X86 1
+#endif
+
+/* 0/1 바이트 8개 → 8비트 (바이트 i → 비트 i) */
+static inline uint64_t pack_bytes(const unsigned char *b) {
+    uint64_t x;
+    memcpy(&x, b, sizeof(x));
+    return (x * 0x0102040810204080ull) >> 56;
+}
+
+static inline uint64_t pack_word(const unsigned char *b) {
+    uint64_t m = 0;
+    for (int k = 0; k < 64; k += 8) {
+        m |= pack_bytes(b + k) << k;
+    }
+    return m;
+}
+
+/* 스칼라: 구역 start부터 끝까지 (start는 64의 배수) */
+static void controls_tail(const float *temp, const float *hum, int start, int n, float temp_thresh,
+                          float hum_thresh, uint64_t *heater, uint64_t *fan) {
+    unsigned char h[64], f[64];
+    for (int w = start / 64; w * 64 < n; w++) {
+        int base = w * 64, end = n - base < 64 ? n - base : 64;
+        if (end < 64) {
+            memset(h, 0, sizeof(h));
+            memset(f, 0, sizeof(f));
+        }
+        for (int b = 0; b < end; b++) {
+            h[b] = temp[base + b] < temp_thresh;
+            f[b] = hum[base + b] > hum_thresh;
+        }
+        heater[w] = pack_word(h);
+        fan[w] = pack_word(f);
+    }
+}
+
+static void compare_tail(const float *v, int start, int n, float thresh, int below, uint64_t *bits) {
+    unsigned char m[64];
+    for (int w = start / 64; w * 64 < n; w++) {
+        int base = w * 64, end = n - base < 64 ? n - base : 64;
+        if (end < 64) {
+            memset(m, 0, sizeof(m));
+        }
+        for (int b = 0; b < end; b++) {
+            m[b] = below ? v[base + b] < thresh : v[base + b] > thresh;
+        }
+        bits[w] = pack_word(m);
+    }
+}
+
+void zone_eval_controls_scalar(const float *temp, const float *hum, int n, float temp_thresh,
+                               float hum_thresh, uint64_t *heater, uint64_t *fan) {
+    controls_tail(temp, hum, 0, n, temp_thresh, hum_thresh, heater, fan);
+}
+
+#ifdef ZONE_EVAL_X86
+/* ============================================================================
+ * 함수: controls_avx2 / compare_avx2
+ * 설명: 64개 구역 단위로 8회 비교 → 워드 하나 (정렬을 가정하지 않는 loadu)
+ * ============================================================================ */
+__attribute__((target("avx2")))
+static void controls_avx2(const float *temp, const float *hum, int n, float temp_thresh,
+                          float hum_thresh, uint64_t *heater, uint64_t *fan) {
+    const __m256 tt = _mm256_set1_ps(temp_thresh);
+    const __m256 ht = _mm256_set1_ps(hum_thresh);
+    int full = n & ~63;
+    for (int base = 0; base < full; base += 64) {
+        uint64_t h = 0, f = 0;
+        for (int k = 0; k < 64; k += 8) {
+            __m256 t = _mm256_loadu_ps(temp + base + k);
+            __m256 u = _mm256_loadu_ps(hum + base + k);
+            h |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(t, tt, _CMP_LT_OQ)) << k;
+            f |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(u, ht, _CMP_GT_OQ)) << k;
+        }
+        heater[base / 64] = h;
+        fan[base / 64] = f;
+    }
+    controls_tail(temp, hum, full, n, temp_thresh, hum_thresh, heater, fan);
+}
+
+__attribute__((target("avx2")))
+static void compare_avx2(const float *v, int n, float thresh, int below, uint64_t *bits) {
+    const __m256 th = _mm256_set1_ps(thresh);
+    int full = n & ~63;
+    for (int base = 0; base < full; base += 64) {
+        uint64_t m = 0;
+        for (int k = 0; k < 64; k += 8) {
+            __m256 x = _mm256_loadu_ps(v + base + k);
+            __m256 c = below ? _mm256_cmp_ps(x, th, _CMP_LT_OQ) : _mm256_cmp_ps(x, th, _CMP_GT_OQ);
+            m |= (uint64_t)(uint32_t)_mm256_movemask_ps(c) << k;
+        }
+        bits[base / 64] = m;
+    }
+    compare_tail(v, full, n, thresh, below, bits);
+}
+#endif
+
+/* 구현 선택 (첫 호출에서 한 번) - 1=AVX2 */
+static int use_avx2 = -1;
+
+static int avx2_enabled(void) {
+    if (use_avx2 < 0) {
+        const char *env = getenv(ZONE_EVAL_ENV);
+        use_avx2 = 0;
+#ifdef ZONE_EVAL_X86
+        if (env == NULL || strcmp(env, "off") != 0) {
+            use_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+        }
+#else
+        (void)env;
+#endif
+    }
+    return use_avx2;
+}
+
+void zone_eval_controls_avx2(const float *temp, const float *hum, int n, float temp_thresh,
+                             float hum_thresh, uint64_t *heater, uint64_t *fan) {
+#ifdef ZONE_EVAL_X86
+    if (__builtin_cpu_supports("avx2")) {
+        controls_avx2(temp, hum, n, temp_thresh, hum_thresh, heater, fan);
+        return;
+    }
+#endif
+    controls_tail(temp, hum, 0, n, temp_thresh, hum_thresh, heater, fan);
+}
+
+/* ============================================================================
+ * 함수: zone_eval_controls / zone_eval_below / zone_eval_above
+ * ============================================================================ */
+void zone_eval_controls(const float *temp, const float *hum, int n, float temp_thresh,
+                        float hum_thresh, uint64_t *heater, uint64_t *fan) {
+#ifdef ZONE_EVAL_X86
+    if (avx2_enabled()) {
+        controls_avx2(temp, hum, n, temp_thresh, hum_thresh, heater, fan);
+        return;
+    }
+#endif
+    controls_tail(temp, hum, 0, n, temp_thresh, hum_thresh, heater, fan);
+}
+
+void zone_eval_below(const float *v, int n, float thresh, uint64_t *bits) {
+#ifdef ZONE_EVAL_X86
+    if (avx2_enabled()) {
+        compare_avx2(v, n, thresh, 1, bits);
+        return;
+    }
+#endif
+    compare_tail(v, 0, n, thresh, 1, bits);
+}
+
+void zone_eval_above(const float *v, int n, float thresh, uint64_t *bits) {
+#ifdef ZONE_EVAL_X86
+    if (avx2_enabled()) {
+        compare_avx2(v, n, thresh, 0, bits);
+        return;
+    }
+#endif
+    compare_tail(v, 0, n, thresh, 0, bits);
+}
+
+const char *zone_eval_impl(void) {
+    return avx2_enabled() ? "avx2" : "scalar";
+}
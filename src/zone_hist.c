@@ -0,0 +1,278 @@
+/*
+ * ==============================================================================
+ * 파일명: zone_hist.c
+ * 역할: 구역별 압축 이력 부호화(서버)와 구간 조회(모니터, 제어 소켓)
+ *
+ * 기술 요소:
+ *   - 표본 하나의 부호를 (값, 비트 수) 조각 목록으로 먼저 만들고, 현재 블록의 남은 비트에
+ *     들어가면 그대로 이어 쓰고 아니면 링의 다음 블록을 비우고 첫 표본으로 기록
+ *     → 블록 사이에 걸친 부호가 없어 블록마다 독립적으로 복호화 가능, 추가는 항상 O(1)
+ *   - 조회는 seqlock 복사본을 복호화: 구간보다 먼저 끝난 블록은 헤더(t_last)만 보고 건너뜀
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/zone_hist.h"
+
+#include <math.h>
+
+#define HIST_CODE_PIECES    12      // 표본 하나의 최대 조각 수 (시각 2 + 값 4 × 2)
+
+typedef struct {
+    uint64_t v[HIST_CODE_PIECES];
+    uint8_t n[HIST_CODE_PIECES];
+    int k;
+    uint32_t bits;
+} HistCode;
+
+static inline void code_put(HistCode *c, uint64_t v, int n) {
+    c->v[c->k] = v;
+    c->n[c->k++] = (uint8_t)n;
+    c->bits += (uint32_t)n;
+}
+
+/* n비트 (1~64, 블록 데이터는 미리 0으로 비워 둠) 이어 쓰기 */
+static inline void bits_put(uint64_t *w, uint32_t *pos, uint64_t v, int n) {
+    uint32_t p = *pos, i = p >> 6, o = p & 63;
+    v <<= 64 - n;
+    w[i] |= v >> o;
+    if (o + (uint32_t)n > 64) {
+        w[i + 1] |= v << (64 - o);
+    }
+    *pos = p + (uint32_t)n;
+}
+
+/* 시각 delta-of-delta 부호 */
+static void encode_dod(HistCode *c, int32_t dod) {
+    if (dod == 0) {
+        code_put(c, 0, 1);
+    } else if (dod >= -4 && dod <= 3) {
+        code_put(c, 0x2, 2);
+        code_put(c, (uint32_t)dod & 0x7, 3);
+    } else if (dod >= -256 && dod <= 255) {
+        code_put(c, 0x6, 3);
+        code_put(c, (uint32_t)dod & 0x1ff, 9);
+    } else if (dod >= -32768 && dod <= 32767) {
+        code_put(c, 0xe, 4);
+        code_put(c, (uint32_t)dod & 0xffff, 16);
+    } else {
+        code_put(c, 0xf, 4);
+        code_put(c, (uint32_t)dod, 32);
+    }
+}
+
+/* 값 XOR 부호 (lead/trail: 직전 창, 새 창을 기록하면 갱신) */
+static void encode_value(HistCode *c, uint32_t prev, uint32_t cur, uint8_t *lead, uint8_t *trail) {
+    uint32_t x = prev ^ cur;
+    if (x == 0) {
+        code_put(c, 0, 1);
+        return;
+    }
+    int l = __builtin_clz(x), t = __builtin_ctz(x);
+    if (*lead != ZONE_HIST_NO_WINDOW && l >= *lead && t >= *trail) {
+        code_put(c, 0x2, 2);
+        code_put(c, x >> *trail, 32 - *lead - *trail);
+        return;
+    }
+    int len = 32 - l - t;
+    code_put(c, 0x3, 2);
+    code_put(c, (uint32_t)l, 5);
+    code_put(c, (uint32_t)(len - 1), 5);
+    code_put(c, x >> t, len);
+    *lead = (uint8_t)l;
+    *trail = (uint8_t)t;
+}
+
+/* ============================================================================
+ * 함수: zone_hist_append
+ * 설명: 표본 하나를 현재 블록에 이어 쓰거나 (들어가지 않으면) 다음 블록을 열어 기록
+ * ============================================================================ */
+void zone_hist_append(ZoneHist *h, uint32_t ts, float temp, float hum) {
+    float q[2] = { zone_hist_quantize(temp), zone_hist_quantize(hum) };
+    uint32_t v[2];
+    memcpy(v, q, sizeof(v));
+
+    HistBlock *b = h->head > 0 ? &h->blocks[(h->head - 1) % ZONE_HIST_BLOCKS] : NULL;
+    uint8_t lead[2] = { h->lead[0], h->lead[1] }, trail[2] = { h->trail[0], h->trail[1] };
+    int32_t delta = (int32_t)(ts - h->prev_ts);
+    HistCode code = { .k = 0, .bits = 0 };
+    if (b != NULL) {
+        encode_dod(&code, (int32_t)((uint32_t)delta - (uint32_t)h->prev_delta));
+        for (int k = 0; k < 2; k++) {
+            encode_value(&code, h->prev_value[k], v[k], &lead[k], &trail[k]);
+        }
+    }
+
+    uint32_t seq = h->seq;
+    __atomic_store_n(&h->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (b == NULL || b->count == UINT16_MAX || b->bits + code.bits > ZONE_HIST_BLOCK_BITS) {
+        // 새 블록: 시각은 헤더, 값은 32비트 그대로
+        b = &h->blocks[h->head % ZONE_HIST_BLOCKS];
+        memset(b, 0, sizeof(*b));
+        uint32_t pos = 0;
+        bits_put(b->data, &pos, v[0], 32);
+        bits_put(b->data, &pos, v[1], 32);
+        b->t_first = ts;
+        b->bits = (uint16_t)pos;
+        b->count = 1;
+        h->head++;
+        delta = 0;
+        lead[0] = lead[1] = ZONE_HIST_NO_WINDOW;
+        trail[0] = trail[1] = 0;
+    } else {
+        uint32_t pos = b->bits;
+        for (int i = 0; i < code.k; i++) {
+            bits_put(b->data, &pos, code.v[i], code.n[i]);
+        }
+        b->bits = (uint16_t)pos;
+        b->count++;
+    }
+    b->t_last = ts;
+    h->prev_ts = ts;
+    h->prev_delta = delta;
+    h->prev_value[0] = v[0];
+    h->prev_value[1] = v[1];
+    memcpy(h->lead, lead, sizeof(lead));
+    memcpy(h->trail, trail, sizeof(trail));
+    h->samples++;
+
+    __atomic_store_n(&h->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* ============================================================================
+ * 함수: zone_hist_snapshot
+ * 설명: 헤더와 사용 중인 블록만 복사 (기록 중이면 다시 시도)
+ * ============================================================================ */
+int zone_hist_snapshot(const ZoneHist *h, ZoneHist *copy) {
+    for (int attempt = 0; attempt < ZONE_HIST_READ_RETRIES; attempt++) {
+        uint32_t s0 = __atomic_load_n(&h->seq, __ATOMIC_ACQUIRE);
+        if (s0 & 1) {
+            cpu_relax();
+            continue;
+        }
+        uint32_t head = __atomic_load_n(&h->head, __ATOMIC_RELAXED);
+        size_t used = head < ZONE_HIST_BLOCKS ? head : ZONE_HIST_BLOCKS;
+        memcpy(copy, h, offsetof(ZoneHist, blocks) + used * sizeof(HistBlock));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&h->seq, __ATOMIC_RELAXED) == s0) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+uint32_t zone_hist_oldest(const ZoneHist *h) {
+    for (int attempt = 0; attempt < ZONE_HIST_READ_RETRIES; attempt++) {
+        uint32_t s0 = __atomic_load_n(&h->seq, __ATOMIC_ACQUIRE);
+        if (s0 & 1) {
+            cpu_relax();
+            continue;
+        }
+        uint32_t head = __atomic_load_n(&h->head, __ATOMIC_RELAXED);
+        uint32_t first = head > ZONE_HIST_BLOCKS ? head - ZONE_HIST_BLOCKS : 0;
+        uint32_t ts = head > 0 ? ((const volatile HistBlock *)&h->blocks[first % ZONE_HIST_BLOCKS])->t_first : 0;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&h->seq, __ATOMIC_RELAXED) == s0) {
+            return ts;
+        }
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: zone_hist_query
+ * 설명: 복사본을 스트리밍 복호화해 구간 안 표본의 최소/최대/평균과 열별 평균 계산
+ *       (history_query와 같은 결과 형식 - 모니터가 디스크 이력 대신 사용)
+ * ============================================================================ */
+int zone_hist_query(const ZoneHist *h, int zone, time_t from, time_t to, HistoryQueryResult *out) {
+    memset(out, 0, sizeof(*out));
+    out->zone = zone;
+    out->from = from;
+    out->to = to;
+    out->level = HIST_LEVEL_MINUTE;
+    for (int i = 0; i < HISTORY_SPARK_WIDTH; i++) {
+        out->temp_series[i] = NAN;
+        out->hum_series[i] = NAN;
+    }
+    if (to <= from) {
+        return -1;
+    }
+    ZoneHist *copy = malloc(sizeof(ZoneHist));
+    if (copy == NULL) {
+        return -1;
+    }
+    if (zone_hist_snapshot(h, copy) < 0) {
+        free(copy);
+        return -1;
+    }
+
+    HistCursor c;
+    hist_cursor_init(&c, copy);
+    // 구간 시작 전에 끝난 블록은 복호화하지 않음
+    while (c.block < c.end && copy->blocks[c.block % ZONE_HIST_BLOCKS].t_last < (uint32_t)from) {
+        c.block++;
+    }
+    out->buckets = c.end - c.block;
+
+    double span = (double)(to - from);
+    double col_temp[HISTORY_SPARK_WIDTH] = {0}, col_hum[HISTORY_SPARK_WIDTH] = {0};
+    uint32_t col_count[HISTORY_SPARK_WIDTH] = {0};
+    double temp_sum = 0, hum_sum = 0;
+    HistPoint p;
+    while (hist_cursor_next(&c, &p)) {
+        if ((time_t)p.ts < from || (time_t)p.ts > to) {
+            continue;
+        }
+        if (out->samples == 0) {
+            out->temp_min = out->temp_max = p.temperature;
+            out->hum_min = out->hum_max = p.humidity;
+        }
+        if (p.temperature < out->temp_min) out->temp_min = p.temperature;
+        if (p.temperature > out->temp_max) out->temp_max = p.temperature;
+        if (p.humidity < out->hum_min) out->hum_min = p.humidity;
+        if (p.humidity > out->hum_max) out->hum_max = p.humidity;
+        temp_sum += p.temperature;
+        hum_sum += p.humidity;
+        out->samples++;
+
+        int col = (int)(((double)p.ts - (double)from) * HISTORY_SPARK_WIDTH / span);
+        if (col < 0) col = 0;
+        if (col >= HISTORY_SPARK_WIDTH) col = HISTORY_SPARK_WIDTH - 1;
+        col_temp[col] += p.temperature;
+        col_hum[col] += p.humidity;
+        col_count[col]++;
+    }
+    free(copy);
+
+    if (out->samples == 0) {
+        return -1;
+    }
+    out->temp_avg = (float)(temp_sum / out->samples);
+    out->hum_avg = (float)(hum_sum / out->samples);
+    for (int i = 0; i < HISTORY_SPARK_WIDTH; i++) {
+        if (col_count[i] > 0) {
+            out->temp_series[i] = (float)(col_temp[i] / col_count[i]);
+            out->hum_series[i] = (float)(col_hum[i] / col_count[i]);
+        }
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 함수: zone_hist_usage
+ * 설명: 남아 있는 블록의 표본 수와 차지한 바이트
+ *       닫힌 블록은 남는 꼬리까지 블록 전체(ZONE_HIST_BLOCK_BYTES), 기록 중인 블록만 헤더 + 사용 비트
+ *       호출자가 세마포어 구간에서 호출 (기록자와 같은 잠금)
+ * ============================================================================ */
+void zone_hist_usage(const ZoneHist *h, uint64_t *samples, uint64_t *bytes) {
+    uint32_t first = h->head > ZONE_HIST_BLOCKS ? h->head - ZONE_HIST_BLOCKS : 0;
+    for (uint32_t i = first; i < h->head; i++) {
+        const HistBlock *b = &h->blocks[i % ZONE_HIST_BLOCKS];
+        *samples += b->count;
+        *bytes += (i + 1 < h->head) ? ZONE_HIST_BLOCK_BYTES : offsetof(HistBlock, data) + (b->bits + 7u) / 8u;
+    }
+}
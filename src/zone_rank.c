@@ -0,0 +1,322 @@
+/*
+ * ==============================================================================
+ * 파일명: zone_rank.c
+ * 역할: 구역 극값 순위 유지 구현 (서버 전용)
+ *
+ * 기술 요소:
+ *   - 순위 종류마다 최소 힙(크기 2K): 루트가 힙 안에서 가장 덜 극단적인 구역
+ *     하위 순위(cold, dry)는 값의 부호를 바꿔 같은 힙 코드로 처리
+ *   - 구역 → 힙 위치 표(pos): 힙 안 구역의 값이 바뀌면 그 자리에서 위/아래로 이동 (O(log K))
+ *   - watermark: 힙에 못 들어갔거나 밀려난 값 중 최댓값 = 힙 밖 구역 값의 상한
+ *     게시할 때 K번째 값 ≥ watermark 이면 힙 밖에 순위에 들 구역이 없음이 보장됨,
+ *     아니면 담당 구역을 훑어 재계산 (그때 watermark도 정확한 값으로 초기화)
+ *   - 게시는 변경된 순위만 정렬(2K개 삽입 정렬)해 seqlock 구간에서 기록
+ *
+ * 작성자: Virtual SmartFarm Team
+ * 작성일: 2025-12-02
+ * ==============================================================================
+ */
+
+#include "../include/zone_rank.h"
+
+#include <math.h>
+
+#define RANK_CAP    (2 * ZONE_RANK_K)   // 힙 크기 (K + 여유분 K)
+
+typedef struct {
+    int n;
+    int dirty;                  // 마지막 게시 후 바뀜
+    float watermark;            // 힙 밖 구역 key의 상한 (-INFINITY=힙 밖 후보 없음)
+    int32_t zone[RANK_CAP];
+    float key[RANK_CAP];        // 최소 힙 기준 값 (하위 순위는 -값)
+} RankHeap;
+
+struct ZoneRanker {
+    int zone_lo, zone_hi;
+    int stale;                  // 다음 게시 때 전체 재계산
+    uint32_t rebuilds;
+    RankHeap heap[RANK_KINDS];
+    uint16_t *pos[RANK_KINDS];  // (구역 - zone_lo) → 힙 위치 + 1 (0=힙 밖)
+};
+
+_Static_assert(RANK_CAP < UINT16_MAX, "ZONE_RANK_K too large for heap position table");
+
+static inline void heap_place(ZoneRanker *zr, int kind, int i, int32_t zone, float key) {
+    RankHeap *h = &zr->heap[kind];
+    h->zone[i] = zone;
+    h->key[i] = key;
+    zr->pos[kind][zone - zr->zone_lo] = (uint16_t)(i + 1);
+}
+
+static void sift_up(ZoneRanker *zr, int kind, int i) {
+    RankHeap *h = &zr->heap[kind];
+    int32_t zone = h->zone[i];
+    float key = h->key[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (h->key[parent] <= key) {
+            break;
+        }
+        heap_place(zr, kind, i, h->zone[parent], h->key[parent]);
+        i = parent;
+    }
+    heap_place(zr, kind, i, zone, key);
+}
+
+static void sift_down(ZoneRanker *zr, int kind, int i) {
+    RankHeap *h = &zr->heap[kind];
+    int32_t zone = h->zone[i];
+    float key = h->key[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= h->n) {
+            break;
+        }
+        if (child + 1 < h->n && h->key[child + 1] < h->key[child]) {
+            child++;
+        }
+        if (key <= h->key[child]) {
+            break;
+        }
+        heap_place(zr, kind, i, h->zone[child], h->key[child]);
+        i = child;
+    }
+    heap_place(zr, kind, i, zone, key);
+}
+
+static inline void raise_watermark(RankHeap *h, float key) {
+    if (key > h->watermark) {
+        h->watermark = key;
+    }
+}
+
+/* 힙 밖 구역 하나 제안: 자리가 있거나 루트보다 극단적이면 들어감 */
+static void heap_offer(ZoneRanker *zr, int kind, int zone, float key) {
+    RankHeap *h = &zr->heap[kind];
+    if (h->n < RANK_CAP) {
+        heap_place(zr, kind, h->n++, zone, key);
+        sift_up(zr, kind, h->n - 1);
+        h->dirty = 1;
+    } else if (key > h->key[0]) {
+        raise_watermark(h, h->key[0]);
+        zr->pos[kind][h->zone[0] - zr->zone_lo] = 0;
+        heap_place(zr, kind, 0, zone, key);
+        sift_down(zr, kind, 0);
+        h->dirty = 1;
+    } else {
+        raise_watermark(h, key);
+    }
+}
+
+/* 힙에서 구역 제거 (마지막 항목으로 자리를 채우고 위/아래로 이동) */
+static void heap_remove(ZoneRanker *zr, int kind, int zone) {
+    RankHeap *h = &zr->heap[kind];
+    uint16_t *p = &zr->pos[kind][zone - zr->zone_lo];
+    if (*p == 0) {
+        return;
+    }
+    int i = *p - 1;
+    *p = 0;
+    h->n--;
+    h->dirty = 1;
+    if (i == h->n) {
+        return;
+    }
+    int32_t moved = h->zone[h->n];
+    heap_place(zr, kind, i, moved, h->key[h->n]);
+    sift_up(zr, kind, i);
+    sift_down(zr, kind, zr->pos[kind][moved - zr->zone_lo] - 1);
+}
+
+/* 구역 하나의 값 반영 (NaN/무한대면 제외) */
+static void rank_set(ZoneRanker *zr, int kind, int zone, float value) {
+    if (!isfinite(value)) {
+        heap_remove(zr, kind, zone);
+        return;
+    }
+    float key = zone_rank_descending(kind) ? value : -value;
+    uint16_t p = zr->pos[kind][zone - zr->zone_lo];
+    if (p == 0) {
+        heap_offer(zr, kind, zone, key);
+        return;
+    }
+    RankHeap *h = &zr->heap[kind];
+    int i = p - 1;
+    float old = h->key[i];
+    if (key == old) {
+        return;
+    }
+    h->key[i] = key;
+    if (key < old) {
+        sift_up(zr, kind, i);       // 덜 극단적으로 → 루트 쪽으로
+    } else {
+        sift_down(zr, kind, i);
+    }
+    h->dirty = 1;
+}
+
+/* ============================================================================
+ * 함수: zone_ranker_create / zone_ranker_destroy
+ * ============================================================================ */
+ZoneRanker *zone_ranker_create(int zone_lo, int zone_hi) {
+    if (zone_lo < 0 || zone_hi <= zone_lo) {
+        errno = EINVAL;
+        return NULL;
+    }
+    ZoneRanker *zr = calloc(1, sizeof(ZoneRanker));
+    if (zr == NULL) {
+        return NULL;
+    }
+    zr->zone_lo = zone_lo;
+    zr->zone_hi = zone_hi;
+    zr->stale = 1;              // 첫 게시 때 공유 메모리의 기존 구역 상태로 채움 (웜 재시작)
+    for (int k = 0; k < RANK_KINDS; k++) {
+        zr->heap[k].watermark = -INFINITY;
+        zr->pos[k] = calloc(zone_hi - zone_lo, sizeof(uint16_t));
+        if (zr->pos[k] == NULL) {
+            zone_ranker_destroy(zr);
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    return zr;
+}
+
+void zone_ranker_destroy(ZoneRanker *zr) {
+    if (zr == NULL) {
+        return;
+    }
+    for (int k = 0; k < RANK_KINDS; k++) {
+        free(zr->pos[k]);
+    }
+    free(zr);
+}
+
+/* ============================================================================
+ * 함수: zone_ranker_update / zone_ranker_remove
+ * ============================================================================ */
+void zone_ranker_update(ZoneRanker *zr, int zone, float temp, float hum) {
+    if (zone < zr->zone_lo || zone >= zr->zone_hi) {
+        return;
+    }
+    rank_set(zr, RANK_HOT, zone, temp);
+    rank_set(zr, RANK_COLD, zone, temp);
+    rank_set(zr, RANK_HUMID, zone, hum);
+    rank_set(zr, RANK_DRY, zone, hum);
+}
+
+void zone_ranker_remove(ZoneRanker *zr, int zone) {
+    if (zone < zr->zone_lo || zone >= zr->zone_hi) {
+        return;
+    }
+    for (int k = 0; k < RANK_KINDS; k++) {
+        heap_remove(zr, k, zone);
+    }
+}
+
+uint32_t zone_ranker_rebuilds(const ZoneRanker *zr) {
+    return zr->rebuilds;
+}
+
+/* 담당 구역 전체를 훑어 모든 순위 재계산 (watermark는 힙에 못 든 값의 정확한 최댓값이 됨) */
+static void rebuild(ZoneRanker *zr, const ZoneTable *zt) {
+    for (int k = 0; k < RANK_KINDS; k++) {
+        memset(zr->pos[k], 0, (zr->zone_hi - zr->zone_lo) * sizeof(uint16_t));
+        zr->heap[k].n = 0;
+        zr->heap[k].watermark = -INFINITY;
+        zr->heap[k].dirty = 1;
+    }
+    for (int z = zr->zone_lo; z < zr->zone_hi; z++) {
+        if (zt->last_update[z] != 0) {
+            zone_ranker_update(zr, z, zt->current_temp[z], zt->current_humidity[z]);
+        }
+    }
+    zr->rebuilds++;
+    zr->stale = 0;
+}
+
+/* 힙 내용을 key 내림차순(가장 극단적인 구역부터)으로 정렬 - 반환: 항목 수 */
+static int sorted_entries(const RankHeap *h, int32_t *zone, float *key) {
+    for (int i = 0; i < h->n; i++) {
+        int j = i;
+        while (j > 0 && key[j - 1] < h->key[i]) {
+            zone[j] = zone[j - 1];
+            key[j] = key[j - 1];
+            j--;
+        }
+        zone[j] = h->zone[i];
+        key[j] = h->key[i];
+    }
+    return h->n;
+}
+
+/* 정렬된 상위 K개가 정확한지: K개가 모두 힙 밖 상한 이상 (K개 미만이면 힙 밖 후보가 없어야 함) */
+static int exact(const RankHeap *h, int n, const float *key) {
+    return n >= ZONE_RANK_K ? key[ZONE_RANK_K - 1] >= h->watermark : h->watermark == -INFINITY;
+}
+
+/* ============================================================================
+ * 함수: zone_ranker_publish
+ * 설명: 바뀐 순위를 정렬해 공유 메모리 목록에 기록
+ *       - 해제된 구역(last_update=0)은 힙에서 제외 (force 또는 그 순위가 바뀐 경우)
+ *       - 정렬 결과가 watermark 조건을 어기면 재계산 후 다시 정렬
+ * ============================================================================ */
+int zone_ranker_publish(ZoneRanker *zr, const ZoneTable *zt, ZoneRank *out, int force) {
+    int32_t zone[RANK_KINDS][RANK_CAP];
+    float key[RANK_KINDS][RANK_CAP];
+    int n[RANK_KINDS] = {0};
+    int any = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (zr->stale) {
+            rebuild(zr, zt);
+        }
+        for (int k = 0; k < RANK_KINDS; k++) {
+            RankHeap *h = &zr->heap[k];
+            if (force || h->dirty) {
+                for (int i = h->n - 1; i >= 0; i--) {
+                    if (zt->last_update[h->zone[i]] == 0) {
+                        heap_remove(zr, k, h->zone[i]);
+                    }
+                }
+            }
+            if (!h->dirty && !force) {
+                n[k] = -1;      // 그대로
+                continue;
+            }
+            n[k] = sorted_entries(h, zone[k], key[k]);
+            if (!exact(h, n[k], key[k])) {
+                zr->stale = 1;
+            }
+        }
+        if (!zr->stale) {
+            break;
+        }
+    }
+
+    uint32_t seq = out->seq;
+    for (int k = 0; k < RANK_KINDS; k++) {
+        if (n[k] < 0) {
+            continue;
+        }
+        if (!any) {
+            __atomic_store_n(&out->seq, seq + 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            any = 1;
+        }
+        int count = n[k] < ZONE_RANK_K ? n[k] : ZONE_RANK_K;
+        int desc = zone_rank_descending(k);
+        for (int i = 0; i < count; i++) {
+            out->e[k][i].zone = zone[k][i];
+            out->e[k][i].value = desc ? key[k][i] : -key[k][i];
+        }
+        out->count[k] = (uint32_t)count;
+        zr->heap[k].dirty = 0;
+    }
+    if (any) {
+        out->rebuilds = zr->rebuilds;
+        out->published_ns = monotonic_ns();
+        __atomic_store_n(&out->seq, seq + 2, __ATOMIC_RELEASE);
+    }
+    return any;
+}